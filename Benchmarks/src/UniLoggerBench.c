@@ -0,0 +1,357 @@
+/**
+ * @file UniLoggerBench.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Benchmarks for the latency and throughput of UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Usage: unilogger_bench [-n iterations] [-t maxThreads] [-f logFile] [-o output.json]
+ *
+ * Every scenario runs in its own process, as the logger is configured only
+ * once per process. Results are written as JSON: operations per second,
+ * mean cost and p50 / p99 / p999 / max latency of a single log call.
+ * Environment variables of UniLogger (LOG_ASYNC, LOG_ENCODING, ...) are
+ * applied, so every mode can be measured with the same scenarios.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+
+// UniLogger Includes
+#include <UniLogger.h>
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#define LOG_TAG "Bench"
+#else
+#define LOG_TAG "Bench"
+#endif // LOG_TAG
+
+/**
+ * @brief Sink of the logs in a scenario
+ */
+enum BenchSink
+{
+    // Logs written to /dev/null
+    SINK_DEV_NULL,
+    // Logs written to a file
+    SINK_FILE,
+    // Logs written to a pipe, drained by a child process
+    SINK_PIPE
+};
+
+/**
+ * @brief Scenario of the benchmark
+ */
+typedef struct BenchScenario
+{
+    // Name of the scenario
+    const char *name;
+    // Sink of the logs
+    enum BenchSink sink;
+    // Flag to log with a disabled level
+    unsigned char isDisabled;
+    // Number of logging threads
+    unsigned int threads;
+} BenchScenario;
+
+/**
+ * @brief Logging thread of a scenario
+ */
+typedef struct BenchThread
+{
+    // Scenario of the thread
+    const BenchScenario *scenario;
+    // Number of logs of the thread
+    unsigned int iterations;
+    // Latency of every log in nanoseconds
+    uint64_t *samples;
+    // Thread
+    pthread_t thread;
+} BenchThread;
+
+// Number of logs per thread
+static unsigned int s_iterations = 100000;
+// Path of the log file for the file scenarios
+static const char *s_logFile = "unilogger_bench.log";
+
+/**
+ * @brief Reads the monotonic clock in nanoseconds
+ */
+static inline uint64_t NowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Compares the samples for qsort
+ */
+static int CompareSamples(const void *first, const void *second)
+{
+    uint64_t a = *(const uint64_t *)first;
+    uint64_t b = *(const uint64_t *)second;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Returns the percentile of the sorted samples
+ */
+static uint64_t Percentile(const uint64_t *samples, size_t count, double percentile)
+{
+    size_t index = (size_t)(percentile * (double)(count - 1));
+    return samples[index];
+}
+
+/**
+ * @brief Logs of a thread, every call is timed
+ */
+static void *BenchThreadRun(void *arg)
+{
+    BenchThread *benchThread = (BenchThread *)arg;
+    unsigned int i;
+    for (i = 0; i < benchThread->iterations; i++)
+    {
+        uint64_t start = NowNs();
+        if (benchThread->scenario->isDisabled)
+        {
+            LOG_DEBUG("Benchmark message %u with value %f and text %s", i, 3.14, "bench");
+        }
+        else
+        {
+            LOG_INFO("Benchmark message %u with value %f and text %s", i, 3.14, "bench");
+        }
+        benchThread->samples[i] = NowNs() - start;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Redirects the logs to the sink of the scenario
+ *
+ * @return pid_t process draining the pipe (0 if none, -1 on failure)
+ */
+static pid_t SetupSink(const BenchScenario *scenario)
+{
+    // Messages of the logger setup are not part of the output
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull < 0 || dup2(devNull, STDOUT_FILENO) < 0)
+    {
+        return -1;
+    }
+    close(devNull);
+
+    UniLogger_SetLogLevel(LOG_LEVEL_INFO);
+    UniLogger_SetLogStream(STREAM_STDOUT);
+
+    if (SINK_FILE == scenario->sink)
+    {
+        UniLogger_SetLogFile(s_logFile);
+    }
+    else if (SINK_PIPE == scenario->sink)
+    {
+        int fds[2];
+        if (0 != pipe(fds))
+        {
+            return -1;
+        }
+
+        pid_t drainer = fork();
+        if (0 == drainer)
+        {
+            char buffer[65536];
+            close(fds[1]);
+            while (read(fds[0], buffer, sizeof(buffer)) > 0)
+            {
+            }
+            _exit(0);
+        }
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        return drainer;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs the scenario and writes its result
+ *
+ * @param scenario scenario to run
+ * @param output descriptor of the output
+ * @return int 0 on success
+ */
+static int RunScenario(const BenchScenario *scenario, int output)
+{
+    pid_t drainer = SetupSink(scenario);
+    if (drainer < 0)
+    {
+        return 1;
+    }
+    UniLogger_SetAsyncMode(ASYNC_OFF, 0);
+
+    unsigned int threads = scenario->threads;
+    size_t count = (size_t)threads * s_iterations;
+    uint64_t *samples = (uint64_t *)malloc(count * sizeof(uint64_t));
+    BenchThread *benchThreads = (BenchThread *)calloc(threads, sizeof(BenchThread));
+    if (NULL == samples || NULL == benchThreads)
+    {
+        return 1;
+    }
+
+    unsigned int i;
+    uint64_t start = NowNs();
+    for (i = 0; i < threads; i++)
+    {
+        benchThreads[i].scenario = scenario;
+        benchThreads[i].iterations = s_iterations;
+        benchThreads[i].samples = samples + (size_t)i * s_iterations;
+        pthread_create(&benchThreads[i].thread, NULL, BenchThreadRun, &benchThreads[i]);
+    }
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(benchThreads[i].thread, NULL);
+    }
+    // Queued logs are part of the throughput
+    UniLogger_Flush();
+    uint64_t elapsed = NowNs() - start;
+
+    UniLogger_CloseLogger();
+    if (drainer > 0)
+    {
+        close(STDOUT_FILENO);
+        waitpid(drainer, NULL, 0);
+    }
+    if (SINK_FILE == scenario->sink)
+    {
+        unlink(s_logFile);
+    }
+
+    qsort(samples, count, sizeof(uint64_t), CompareSamples);
+    uint64_t sum = 0;
+    size_t j;
+    for (j = 0; j < count; j++)
+    {
+        sum += samples[j];
+    }
+
+    dprintf(output,
+            "    {\"name\": \"%s\", \"threads\": %u, \"ops\": %zu, "
+            "\"ops_per_sec\": %.0f, \"mean_ns\": %.1f, "
+            "\"latency_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}}",
+            scenario->name,
+            threads,
+            count,
+            (double)count * 1e9 / (double)(elapsed ? elapsed : 1),
+            (double)sum / (double)count,
+            (unsigned long long)Percentile(samples, count, 0.50),
+            (unsigned long long)Percentile(samples, count, 0.99),
+            (unsigned long long)Percentile(samples, count, 0.999),
+            (unsigned long long)samples[count - 1]);
+
+    free(benchThreads);
+    free(samples);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int maxThreads = 4;
+    const char *outputPath = NULL;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "n:t:f:o:")))
+    {
+        switch (option)
+        {
+        case 'n':
+            s_iterations = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            maxThreads = (unsigned int)strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            s_logFile = optarg;
+            break;
+        case 'o':
+            outputPath = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n iterations] [-t maxThreads] [-f logFile] [-o output.json]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (0 == s_iterations || 0 == maxThreads)
+    {
+        fprintf(stderr, "Iterations and threads must be greater than 0\n");
+        return 2;
+    }
+
+    // Output is kept away from the redirected stdout of the scenarios
+    int output = outputPath ? open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644) : dup(STDOUT_FILENO);
+    if (output < 0)
+    {
+        perror("output");
+        return 1;
+    }
+
+    BenchScenario scenarios[32] = {
+        {"disabled_level", SINK_DEV_NULL, 1, 1},
+        {"dev_null", SINK_DEV_NULL, 0, 1},
+        {"file", SINK_FILE, 0, 1},
+        {"pipe", SINK_PIPE, 0, 1},
+    };
+    unsigned int scenarioCount = 4;
+    char names[32][32];
+    unsigned int threads;
+    for (threads = 1; threads <= maxThreads && scenarioCount < 32; threads *= 2)
+    {
+        snprintf(names[scenarioCount], sizeof(names[scenarioCount]), "file_threads_%u", threads);
+        scenarios[scenarioCount].name = names[scenarioCount];
+        scenarios[scenarioCount].sink = SINK_FILE;
+        scenarios[scenarioCount].isDisabled = 0;
+        scenarios[scenarioCount].threads = threads;
+        scenarioCount++;
+    }
+
+    dprintf(output, "{\n  \"benchmark\": \"unilogger\",\n  \"iterations\": %u,\n  \"results\": [\n", s_iterations);
+
+    int status = 0;
+    unsigned int i;
+    for (i = 0; i < scenarioCount; i++)
+    {
+        if (i)
+        {
+            dprintf(output, ",\n");
+        }
+
+        // Logger is configured once per process
+        pid_t child = fork();
+        if (0 == child)
+        {
+            _exit(RunScenario(&scenarios[i], output));
+        }
+
+        int childStatus = 1;
+        if (child < 0 || waitpid(child, &childStatus, 0) < 0 ||
+            !WIFEXITED(childStatus) || 0 != WEXITSTATUS(childStatus))
+        {
+            dprintf(output, "    {\"name\": \"%s\", \"error\": \"scenario failed\"}", scenarios[i].name);
+            status = 1;
+        }
+    }
+
+    dprintf(output, "\n  ]\n}\n");
+    close(output);
+    return status;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file testLoggerFormat.cpp
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Test example for using the type safe C++ front-end of UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <string>
+#include <string_view>
+
+// To use file name in the Logs
+#define USE_FILE_NAME
+
+// UniLogger Includes
+#include <UniLogger.hpp>
+
+int main(int argc, char const *argv[])
+{
+    // Set the Log level
+    UniLogger_SetLogLevel(LOG_LEVEL_TRACE);
+    // Set the stream type
+    UniLogger_SetLogStream(STREAM_STDOUT);
+
+    std::string user = "admin";
+    std::string_view command = "restart";
+
+    LOG_FATAL_FMT("Fatal logs {}", 1);
+    LOG_ERROR_FMT("Error logs {} {}", user, command);
+    LOG_WARN_FMT("Warning logs {:.2f}", 0.125);
+    LOG_INFO_FMT("Information logs {:#x} {}", 255u, true);
+    LOG_DEBUG_FMT("Debug logs [{:<8}] [{:>8}]", "left", "right");
+    LOG_TRACE_FMT("Trace logs {{}} {}", argc);
+    LOG_PROFILE_FMT("Profile logs {}", static_cast<const void *>(argv));
+
+    // Close the logger
+    UniLogger_CloseLogger();
+
+    return 0;
+}
@@ -0,0 +1,557 @@
+/**
+ * @file UniLoggerCollector.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Collector of the shared memory ring of UniLogger (unilogger-collector)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Usage: unilogger-collector [-s slots] [-w window] [-o log file] [-r] [ring name]
+ *   -s  number of records in the ring, used if the collector creates it
+ *   -w  reorder window in milliseconds (default 100)
+ *   -o  log file, opened for appending and reopened on SIGHUP (default stdout)
+ *   -r  remove the ring at exit
+ *
+ * Drains the ring written by the processes (UniLogger_SetSharedRing()) to
+ * one file. Records are kept for the reorder window and written in the
+ * order of their time, so the records of the processes are not interleaved
+ * out of order. Records longer than a slot are joined from their parts in
+ * contiguous slots. SIGINT / SIGTERM write the remaining records and exit.
+ * Only one collector can drain a ring.
+ */
+// System Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Default reorder window in milliseconds
+ */
+#define UL_COLLECTOR_WINDOW_MS 100
+
+/**
+ * @brief Longest wait for records in milliseconds (stop request and stalled slots are checked)
+ */
+#define UL_COLLECTOR_WAIT_MS 100
+
+/**
+ * @brief Record taken from the ring
+ */
+typedef struct PendingRecord
+{
+    // Time of the record in ns since epoch
+    uint64_t time;
+    // Length of the formatted record
+    uint32_t length;
+    // Joined record longer than data, NULL if the record is in data
+    char *overflow;
+    // Formatted record
+    char data[UL_MAX_RECORD_SIZE];
+} PendingRecord;
+
+// Records taken from the ring, sorted by time
+static PendingRecord **s_pending = NULL;
+static size_t s_pendingCount = 0;
+// Free records
+static PendingRecord **s_free = NULL;
+static size_t s_freeCount = 0;
+
+// Output of the records
+static int s_outFd = STDOUT_FILENO;
+static const char *s_outPath = NULL;
+// Parts of the record being joined
+static char *s_parts = NULL;
+static size_t s_partsLength = 0;
+// Index of the next part, 0 if no record is being joined
+static uint32_t s_nextPart = 0;
+
+// Records written with a single write
+static char s_batch[UL_ASYNC_BATCH_SIZE];
+static size_t s_batchLength = 0;
+
+// Flags set by the signals
+static volatile sig_atomic_t s_isStopping = 0;
+static volatile sig_atomic_t s_isReopening = 0;
+
+/**
+ * @brief Handler of SIGINT / SIGTERM (stop) and SIGHUP (reopen the log file)
+ */
+static void HandleSignal(int signalNum)
+{
+    if (SIGHUP == signalNum)
+    {
+        s_isReopening = 1;
+    }
+    else
+    {
+        s_isStopping = 1;
+    }
+}
+
+/**
+ * @brief Gets the current time in ns since epoch
+ */
+static uint64_t Now()
+{
+    struct timespec now;
+    Timestamp_Now(&now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Writes the data to the output
+ */
+static void WriteOutput(const char *data, size_t length)
+{
+    while (length)
+    {
+        ssize_t written = write(s_outFd, data, length);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            fprintf(stderr, "Failed to write the logs (errno %d)\n", errno);
+            break;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Writes the batch to the output
+ */
+static void FlushBatch()
+{
+    WriteOutput(s_batch, s_batchLength);
+    s_batchLength = 0;
+}
+
+/**
+ * @brief Appends the record to the batch, records longer than the batch are written directly
+ */
+static void AppendRecord(const char *data, size_t length)
+{
+    if (s_batchLength + length > sizeof(s_batch))
+    {
+        FlushBatch();
+    }
+    if (length > sizeof(s_batch))
+    {
+        WriteOutput(data, length);
+        return;
+    }
+    memcpy(s_batch + s_batchLength, data, length);
+    s_batchLength += length;
+}
+
+/**
+ * @brief Appends a notice of the collector to the batch
+ */
+static void AppendNotice(const char *format, ...)
+{
+    char record[UL_MAX_RECORD_SIZE];
+    UniLoggerCallSite callSite = {LOG_LEVEL_WARN, "UniLogger", __LINE__, NULL, 0, format, NULL, 0, NULL};
+    va_list args;
+    va_start(args, format);
+    size_t length = FormatTextRecord(record, sizeof(record), &callSite, args, format);
+    va_end(args);
+    AppendRecord(record, length);
+}
+
+/**
+ * @brief Opens the log file for appending
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int OpenOutput()
+{
+    if (NULL == s_outPath)
+    {
+        return 0;
+    }
+    int fd = open(s_outPath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Failed to open file %s\n", s_outPath);
+        return -1;
+    }
+    if (STDOUT_FILENO != s_outFd)
+    {
+        close(s_outFd);
+    }
+    s_outFd = fd;
+    return 0;
+}
+
+/**
+ * @brief Writes the oldest records
+ *
+ * @param count number of records written
+ */
+static void WriteOldest(size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        PendingRecord *record = s_pending[i];
+        AppendRecord(record->overflow ? record->overflow : record->data, record->length);
+        free(record->overflow);
+        record->overflow = NULL;
+        s_free[s_freeCount++] = record;
+    }
+    memmove(s_pending, s_pending + count, (s_pendingCount - count) * sizeof(PendingRecord *));
+    s_pendingCount -= count;
+}
+
+/**
+ * @brief Writes the records older than the time
+ */
+static void WriteBefore(uint64_t time)
+{
+    size_t count = 0;
+    while (count < s_pendingCount && s_pending[count]->time <= time)
+    {
+        count++;
+    }
+    WriteOldest(count);
+}
+
+/**
+ * @brief Adds the record to the pending records in the order of time
+ *
+ * @param time time of the record
+ * @param data formatted record, copied if overflow is NULL
+ * @param length length of the record
+ * @param overflow allocated record, owned by the pending record
+ */
+static void AddPending(uint64_t time, const char *data, size_t length, char *overflow)
+{
+    // Oldest records are written to make space
+    if (0 == s_freeCount)
+    {
+        WriteOldest(s_pendingCount / 2);
+    }
+    PendingRecord *record = s_free[--s_freeCount];
+    record->time = time;
+    record->length = (uint32_t)length;
+    record->overflow = overflow;
+    if (NULL == overflow)
+    {
+        memcpy(record->data, data, length);
+    }
+
+    // Insert in the order of time (records of the ring are almost sorted)
+    size_t index = s_pendingCount++;
+    while (index && s_pending[index - 1]->time > record->time)
+    {
+        s_pending[index] = s_pending[index - 1];
+        index--;
+    }
+    s_pending[index] = record;
+}
+
+/**
+ * @brief Drops the record being joined
+ */
+static void DropParts()
+{
+    free(s_parts);
+    s_parts = NULL;
+    s_partsLength = 0;
+    s_nextPart = 0;
+}
+
+/**
+ * @brief Joins the part of a record longer than a slot
+ */
+static void JoinPart(SharedRingHeader *header, const SharedRingSlot *slot, uint32_t length)
+{
+    if (0 == slot->partIndex)
+    {
+        if (s_nextPart)
+        {
+            // Previous record misses its last parts
+            __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+            DropParts();
+        }
+        s_parts = (char *)malloc((size_t)slot->partCount * sizeof(slot->data));
+        if (NULL == s_parts)
+        {
+            __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    else if (slot->partIndex != s_nextPart)
+    {
+        // Record of a skipped part, counted when the slot was skipped
+        return;
+    }
+
+    memcpy(s_parts + s_partsLength, slot->data, length);
+    s_partsLength += length;
+    if (++s_nextPart == slot->partCount)
+    {
+        AddPending(slot->time, NULL, s_partsLength, s_parts);
+        s_parts = NULL;
+        s_partsLength = 0;
+        s_nextPart = 0;
+    }
+}
+
+/**
+ * @brief Takes the ready records from the ring
+ *
+ * @return size_t number of records taken
+ */
+static size_t Drain(SharedRingHeader *header)
+{
+    size_t taken = 0;
+    for (;;)
+    {
+        uint64_t pos = __atomic_load_n(&header->dequeuePos, __ATOMIC_RELAXED);
+        SharedRingSlot *slot = SharedRing_Slot(header, pos);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1)
+        {
+            return taken;
+        }
+
+        // Empty slots are claimed before the parts of a longer record
+        uint32_t length = slot->length <= sizeof(slot->data) ? slot->length : (uint32_t)sizeof(slot->data);
+        if (slot->partCount > 1)
+        {
+            JoinPart(header, slot, length);
+        }
+        else if (length)
+        {
+            AddPending(slot->time, slot->data, length, NULL);
+        }
+
+        __atomic_store_n(&header->dequeuePos, pos + 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&slot->sequence, pos + header->slotCount, __ATOMIC_RELEASE);
+        taken++;
+    }
+}
+
+/**
+ * @brief Skips the slot claimed by a process which did not publish it in UL_SHARED_STALL_MS
+ *
+ * @return unsigned char 1 if a slot is skipped
+ */
+static unsigned char SkipStalledSlot(SharedRingHeader *header, uint64_t now)
+{
+    static uint64_t s_stalledPos = UINT64_MAX;
+    static uint64_t s_stalledSince = 0;
+
+    uint64_t pos = __atomic_load_n(&header->dequeuePos, __ATOMIC_RELAXED);
+    SharedRingSlot *slot = SharedRing_Slot(header, pos);
+    if ((int64_t)(__atomic_load_n(&header->enqueuePos, __ATOMIC_ACQUIRE) - pos) <= 0 ||
+        __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos)
+    {
+        // Not claimed, or published
+        s_stalledPos = UINT64_MAX;
+        return 0;
+    }
+    if (pos != s_stalledPos)
+    {
+        s_stalledPos = pos;
+        s_stalledSince = now;
+        return 0;
+    }
+    if (now - s_stalledSince < UL_SHARED_STALL_MS * 1000000ULL)
+    {
+        return 0;
+    }
+
+    // Process publishing late fails its compare and swap and drops the record
+    uint64_t expected = pos;
+    if (!__atomic_compare_exchange_n(&slot->sequence, &expected, pos + header->slotCount, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    __atomic_store_n(&header->dequeuePos, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+    s_stalledPos = UINT64_MAX;
+    // Later parts of the record being joined are dropped with the skipped slot
+    DropParts();
+    return 1;
+}
+
+/**
+ * @brief Waits till a process publishes a record or the timeout
+ */
+static void WaitRecords(SharedRingHeader *header, uint64_t timeoutNs)
+{
+    uint32_t sequence = __atomic_load_n(&header->wakeSequence, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&header->isCollectorIdle, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint64_t pos = __atomic_load_n(&header->dequeuePos, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&SharedRing_Slot(header, pos)->sequence, __ATOMIC_ACQUIRE) != pos + 1 && !s_isStopping)
+    {
+        struct timespec timeout = {(time_t)(timeoutNs / 1000000000ULL), (long)(timeoutNs % 1000000000ULL)};
+        syscall(SYS_futex, &header->wakeSequence, FUTEX_WAIT, sequence, &timeout, NULL, 0);
+    }
+    __atomic_store_n(&header->isCollectorIdle, 0, __ATOMIC_RELAXED);
+}
+
+int main(int argc, char const *argv[])
+{
+    const char *name = "/unilogger";
+    unsigned long slotCount = UL_SHARED_DEFAULT_SIZE;
+    unsigned long windowMs = UL_COLLECTOR_WINDOW_MS;
+    unsigned char isRemoving = 0;
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            slotCount = strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-w") && i + 1 < argc)
+        {
+            windowMs = strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            s_outPath = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "-r"))
+        {
+            isRemoving = 1;
+        }
+        else if ('-' == argv[i][0])
+        {
+            fprintf(stderr, "Usage: %s [-s slots] [-w window ms] [-o log file] [-r] [ring name]\n", argv[0]);
+            return 1;
+        }
+        else
+        {
+            name = argv[i];
+        }
+    }
+
+    if (0 != OpenOutput())
+    {
+        return 1;
+    }
+
+    size_t mapSize = 0;
+    int shmFd = -1;
+    SharedRingHeader *header = SharedRing_Map(name, (unsigned int)slotCount, &mapSize, &shmFd);
+    if (NULL == header)
+    {
+        fprintf(stderr, "Failed to open the shared ring %s\n", name);
+        return 1;
+    }
+    if (0 != flock(shmFd, LOCK_EX | LOCK_NB))
+    {
+        fprintf(stderr, "Shared ring %s is drained by another collector\n", name);
+        munmap(header, mapSize);
+        close(shmFd);
+        return 1;
+    }
+
+    size_t capacity = 2 * (size_t)header->slotCount;
+    PendingRecord *records = (PendingRecord *)malloc(capacity * sizeof(PendingRecord));
+    s_pending = (PendingRecord **)malloc(capacity * sizeof(PendingRecord *));
+    s_free = (PendingRecord **)malloc(capacity * sizeof(PendingRecord *));
+    if (NULL == records || NULL == s_pending || NULL == s_free)
+    {
+        fprintf(stderr, "Failed to allocate %zu records\n", capacity);
+        return 1;
+    }
+    for (s_freeCount = 0; s_freeCount < capacity; s_freeCount++)
+    {
+        s_free[s_freeCount] = &records[s_freeCount];
+    }
+
+    // Signals interrupt the wait of the collector
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGHUP, &action, NULL);
+
+    uint64_t window = (uint64_t)windowMs * 1000000ULL;
+    while (!s_isStopping)
+    {
+        size_t taken = Drain(header);
+        uint64_t now = Now();
+        if (0 == taken)
+        {
+            SkipStalledSlot(header, now);
+        }
+        WriteBefore(now > window ? now - window : 0);
+
+        // Including the records dropped while no collector was running
+        uint64_t dropped = __atomic_load_n(&header->dropped, __ATOMIC_RELAXED);
+        if (dropped != header->droppedReported)
+        {
+            AppendNotice("Dropped %llu log records, shared ring is full, a record is too long for the ring "
+                         "or a process stopped while logging",
+                         (unsigned long long)(dropped - header->droppedReported));
+            header->droppedReported = dropped;
+        }
+        FlushBatch();
+
+        if (s_isReopening)
+        {
+            s_isReopening = 0;
+            OpenOutput();
+        }
+
+        if (0 == taken)
+        {
+            // Till the oldest record leaves the reorder window
+            uint64_t timeout = (uint64_t)UL_COLLECTOR_WAIT_MS * 1000000ULL;
+            if (s_pendingCount && s_pending[0]->time + window > now &&
+                s_pending[0]->time + window - now < timeout)
+            {
+                timeout = s_pending[0]->time + window - now;
+            }
+            WaitRecords(header, timeout);
+        }
+    }
+
+    // Remaining records of the ring
+    Drain(header);
+    WriteOldest(s_pendingCount);
+    FlushBatch();
+    DropParts();
+
+    if (isRemoving)
+    {
+        char shmName[256];
+        snprintf(shmName, sizeof(shmName), "%s%s", ('/' == name[0]) ? "" : "/", name);
+        shm_unlink(shmName);
+    }
+    munmap(header, mapSize);
+    close(shmFd);
+    if (STDOUT_FILENO != s_outFd)
+    {
+        close(s_outFd);
+    }
+    free(records);
+    free(s_pending);
+    free(s_free);
+    return 0;
+}
@@ -0,0 +1,500 @@
+/**
+ * @file UniLoggerDecode.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Decoder for the binary logs of UniLogger (unilogger-decode)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Usage: unilogger-decode [-u | -e] <binary log file>
+ *   -u  print the time in UTC
+ *   -e  print the time as nanoseconds since epoch
+ *
+ * Renders the binary records to the text layout of the logs
+ * ([time]:[LEVEL] [tag:line] message). Text lines in the file
+ * (printed by the logger itself) are copied as it is, zero bytes left
+ * by a crash of the memory mapped sink are skipped.
+ */
+// System Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief String (format or tag) of the binary logs
+ */
+typedef struct DecodeString
+{
+    // Id (address in the logging process)
+    uint64_t id;
+    // Characters of the string (not null terminated)
+    const char *data;
+    // Length of the string
+    uint16_t length;
+} DecodeString;
+
+/**
+ * @brief Reader for the fields of the records
+ */
+typedef struct DecodeReader
+{
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+} DecodeReader;
+
+// Strings of the binary logs, sorted by id
+static DecodeString *s_strings = NULL;
+static size_t s_stringCount = 0;
+
+/**
+ * @brief Reads the field from the reader
+ *
+ * @return int 0 -> Success, -1 -> not enough data
+ */
+static int Read(DecodeReader *reader, void *value, size_t size)
+{
+    if (reader->pos + size > reader->size)
+    {
+        return -1;
+    }
+    memcpy(value, reader->data + reader->pos, size);
+    reader->pos += size;
+    return 0;
+}
+
+/**
+ * @brief Compares the strings by id
+ */
+static int CompareStrings(const void *a, const void *b)
+{
+    uint64_t idA = ((const DecodeString *)a)->id;
+    uint64_t idB = ((const DecodeString *)b)->id;
+    return (idA > idB) - (idA < idB);
+}
+
+/**
+ * @brief Finds the string with the id
+ *
+ * @return char* null terminated string, NULL if not found
+ */
+static const DecodeString *FindString(uint64_t id)
+{
+    DecodeString key = {id, NULL, 0};
+    return (const DecodeString *)bsearch(&key, s_strings, s_stringCount, sizeof(DecodeString), CompareStrings);
+}
+
+/**
+ * @brief Appends the normalized conversion to spec, width and precision from '*' are filled in
+ *
+ * @param spec parsed conversion
+ * @param stars values of the '*' arguments
+ * @param normalized destination (at least 64 bytes)
+ */
+static void NormalizeSpec(const BinarySpec *spec, const int32_t *stars, char *normalized)
+{
+    const char *curr = spec->start + 1;
+    size_t length = 0;
+    unsigned int starIndex = 0;
+
+    normalized[length++] = '%';
+    // Flags
+    while (*curr && strchr("-+ #0'", *curr) && length < 16)
+    {
+        normalized[length++] = *curr++;
+    }
+    // Width
+    if ('*' == *curr)
+    {
+        length += (size_t)sprintf(normalized + length, "%d", (int)stars[starIndex++]);
+        curr++;
+    }
+    while (*curr >= '0' && *curr <= '9' && length < 32)
+    {
+        normalized[length++] = *curr++;
+    }
+    // Precision
+    if ('.' == *curr)
+    {
+        normalized[length++] = *curr++;
+        if ('*' == *curr)
+        {
+            length += (size_t)sprintf(normalized + length, "%d", (int)stars[starIndex++]);
+            curr++;
+        }
+        while (*curr >= '0' && *curr <= '9' && length < 48)
+        {
+            normalized[length++] = *curr++;
+        }
+    }
+    // Integers are printed as long long
+    if (BINARY_ARG_INT == spec->type && 'c' != spec->conversion)
+    {
+        normalized[length++] = 'l';
+        normalized[length++] = 'l';
+    }
+    normalized[length++] = spec->conversion;
+    normalized[length] = '\0';
+}
+
+/**
+ * @brief Truncates the integer to the type of the length modifier
+ */
+static long long TruncateInteger(const BinarySpec *spec, int64_t value)
+{
+    unsigned char isUnsigned = (NULL != strchr("uoxX", spec->conversion));
+    switch (spec->modifier)
+    {
+    case BINARY_MODIFIER_CHAR:
+        return isUnsigned ? (long long)(unsigned char)value : (long long)(signed char)value;
+    case BINARY_MODIFIER_SHORT:
+        return isUnsigned ? (long long)(unsigned short)value : (long long)(short)value;
+    case BINARY_MODIFIER_NONE:
+        return isUnsigned ? (long long)(unsigned int)value : (long long)(int)value;
+    default:
+        return (long long)value;
+    }
+}
+
+/**
+ * @brief Prints the message of the log with the arguments of the record
+ *
+ * @param format format of the log
+ * @param args reader for the arguments
+ */
+static void PrintMessage(const char *format, DecodeReader *args)
+{
+    static char string[UINT16_MAX + 1];
+    BinarySpec spec;
+    const char *curr = format;
+    const char *next;
+
+    while (NULL != (next = BinaryFormat_NextSpec(curr, &spec)))
+    {
+        // Text before the conversion
+        fwrite(curr, 1, (size_t)(spec.start - curr), stdout);
+        curr = next;
+
+        if (BINARY_ARG_NONE == spec.type)
+        {
+            if ('%' == spec.conversion)
+            {
+                putchar('%');
+            }
+            else
+            {
+                fwrite(spec.start, 1, spec.length, stdout);
+            }
+            continue;
+        }
+
+        int32_t stars[2] = {0, 0};
+        unsigned int i;
+        int isMissing = 0;
+        for (i = 0; i < spec.starCount; i++)
+        {
+            isMissing |= Read(args, &stars[i], sizeof(stars[i]));
+        }
+
+        char normalized[64];
+        NormalizeSpec(&spec, stars, normalized);
+
+        if (BINARY_ARG_INT == spec.type)
+        {
+            int64_t value;
+            if (isMissing || 0 != Read(args, &value, sizeof(value)))
+            {
+                fputs("<?>", stdout);
+            }
+            else if ('c' == spec.conversion)
+            {
+                printf(normalized, (int)value);
+            }
+            else
+            {
+                printf(normalized, TruncateInteger(&spec, value));
+            }
+        }
+        else if (BINARY_ARG_DOUBLE == spec.type)
+        {
+            double value;
+            if (isMissing || 0 != Read(args, &value, sizeof(value)))
+            {
+                fputs("<?>", stdout);
+            }
+            else
+            {
+                printf(normalized, value);
+            }
+        }
+        else if (BINARY_ARG_POINTER == spec.type)
+        {
+            uint64_t value;
+            if (isMissing || 0 != Read(args, &value, sizeof(value)))
+            {
+                fputs("<?>", stdout);
+            }
+            else
+            {
+                printf(normalized, (void *)(uintptr_t)value);
+            }
+        }
+        else if (BINARY_ARG_STRING == spec.type)
+        {
+            uint16_t length;
+            if (isMissing || 0 != Read(args, &length, sizeof(length)) || 0 != Read(args, string, length))
+            {
+                fputs("<?>", stdout);
+            }
+            else
+            {
+                string[length] = '\0';
+                printf(normalized, string);
+            }
+        }
+    }
+
+    // Text after the last conversion
+    fputs(curr, stdout);
+}
+
+/**
+ * @brief Prints the log record as text
+ *
+ * @param reader reader at the start of the record fields
+ * @return int 0 -> Success, -1 -> truncated record
+ */
+static int PrintLog(DecodeReader *reader)
+{
+    uint8_t level;
+    uint16_t argLength;
+    uint32_t line;
+    uint64_t timeNs, formatId, tagId;
+    if (0 != Read(reader, &level, sizeof(level)) ||
+        0 != Read(reader, &argLength, sizeof(argLength)) ||
+        0 != Read(reader, &line, sizeof(line)) ||
+        0 != Read(reader, &timeNs, sizeof(timeNs)) ||
+        0 != Read(reader, &formatId, sizeof(formatId)) ||
+        0 != Read(reader, &tagId, sizeof(tagId)) ||
+        reader->pos + argLength > reader->size)
+    {
+        return -1;
+    }
+
+    DecodeReader args = {reader->data + reader->pos, argLength, 0};
+    reader->pos += argLength;
+
+    char dateTime[UL_TIMESTAMP_SIZE];
+    struct timespec time = {(time_t)(timeNs / 1000000000ULL), (long)(timeNs % 1000000000ULL)};
+    Timestamp_Format(&time, dateTime);
+
+    const DecodeString *tag = FindString(tagId);
+    printf("[%s]:[%s] [%.*s:%u] ",
+           dateTime,
+           level < LOG_MAX_LEVEL ? logLevelNames[level] : "  ???  ",
+           tag ? (int)tag->length : 1,
+           tag ? tag->data : "?",
+           (unsigned int)line);
+
+    const DecodeString *format = FindString(formatId);
+    if (format)
+    {
+        // Strings in file are not null terminated
+        char *formatString = strndup(format->data, format->length);
+        PrintMessage(formatString, &args);
+        free(formatString);
+    }
+    else
+    {
+        printf("<unknown format 0x%llx>", (unsigned long long)formatId);
+    }
+    putchar('\n');
+    return 0;
+}
+
+/**
+ * @brief Walks through the records of the file
+ *
+ * @param data content of the file
+ * @param size size of the file
+ * @param isPrinting 0 -> collect the strings, 1 -> print the logs
+ * @return int 0 -> Success, -1 -> invalid file
+ */
+static int DecodeRecords(const unsigned char *data, size_t size, unsigned char isPrinting)
+{
+    DecodeReader reader = {data, size, 0};
+    while (reader.pos < size)
+    {
+        // Zero bytes preallocated by the memory mapped sink are left after a crash
+        if ('\0' == data[reader.pos])
+        {
+            reader.pos++;
+            continue;
+        }
+
+        // Text lines are printed as it is
+        if (UL_BINARY_MARKER != data[reader.pos])
+        {
+            const unsigned char *end = memchr(data + reader.pos, '\n', size - reader.pos);
+            size_t length = end ? (size_t)(end - (data + reader.pos)) + 1 : size - reader.pos;
+            if (isPrinting)
+            {
+                fwrite(data + reader.pos, 1, length, stdout);
+            }
+            reader.pos += length;
+            continue;
+        }
+
+        uint8_t marker, type;
+        if (0 != Read(&reader, &marker, sizeof(marker)) || 0 != Read(&reader, &type, sizeof(type)))
+        {
+            return -1;
+        }
+
+        if (UL_BINARY_HEADER == type)
+        {
+            char magic[sizeof(UL_BINARY_MAGIC) - 1];
+            uint8_t version;
+            uint32_t byteOrder;
+            if (0 != Read(&reader, magic, sizeof(magic)) ||
+                0 != Read(&reader, &version, sizeof(version)) ||
+                0 != Read(&reader, &byteOrder, sizeof(byteOrder)))
+            {
+                return -1;
+            }
+            if (0 != memcmp(magic, UL_BINARY_MAGIC, sizeof(magic)) || UL_BINARY_VERSION != version)
+            {
+                fprintf(stderr, "Unsupported binary log header (version %u)\n", version);
+                return -1;
+            }
+            if (UL_BINARY_BYTE_ORDER != byteOrder)
+            {
+                fprintf(stderr, "Binary logs are written with different byte order\n");
+                return -1;
+            }
+        }
+        else if (UL_BINARY_STRING == type)
+        {
+            DecodeString string;
+            if (0 != Read(&reader, &string.id, sizeof(string.id)) ||
+                0 != Read(&reader, &string.length, sizeof(string.length)) ||
+                reader.pos + string.length > size)
+            {
+                return -1;
+            }
+            string.data = (const char *)(data + reader.pos);
+            reader.pos += string.length;
+
+            if (!isPrinting)
+            {
+                DecodeString *strings = (DecodeString *)realloc(s_strings, (s_stringCount + 1) * sizeof(DecodeString));
+                if (NULL == strings)
+                {
+                    return -1;
+                }
+                s_strings = strings;
+                s_strings[s_stringCount++] = string;
+            }
+        }
+        else if (UL_BINARY_LOG == type)
+        {
+            if (isPrinting)
+            {
+                if (0 != PrintLog(&reader))
+                {
+                    return -1;
+                }
+            }
+            else
+            {
+                // Skip the log record
+                uint16_t argLength;
+                reader.pos += 1;
+                if (0 != Read(&reader, &argLength, sizeof(argLength)))
+                {
+                    return -1;
+                }
+                reader.pos += sizeof(uint32_t) + 3 * sizeof(uint64_t) + argLength;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown record type %u at offset %zu\n", type, reader.pos - 2);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    const char *filepath = NULL;
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "-u"))
+        {
+            Timestamp_SetFormat(TIME_FORMAT_UTC);
+        }
+        else if (0 == strcmp(argv[i], "-e"))
+        {
+            Timestamp_SetFormat(TIME_FORMAT_EPOCH_NS);
+        }
+        else
+        {
+            filepath = argv[i];
+        }
+    }
+
+    if (NULL == filepath)
+    {
+        fprintf(stderr, "Usage: %s [-u | -e] <binary log file>\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(filepath, O_RDONLY);
+    struct stat fileStat;
+    if (fd < 0 || 0 != fstat(fd, &fileStat))
+    {
+        fprintf(stderr, "Failed to open file %s\n", filepath);
+        return 1;
+    }
+    if (0 == fileStat.st_size)
+    {
+        close(fd);
+        return 0;
+    }
+
+    const unsigned char *data = (const unsigned char *)mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+    {
+        fprintf(stderr, "Failed to map file %s\n", filepath);
+        return 1;
+    }
+
+    // Strings can be written after the first log using them (by other threads)
+    // so they are collected before printing
+    size_t size = (size_t)fileStat.st_size;
+    // Logs till the truncated record (if any) are still printed
+    int status = DecodeRecords(data, size, 0);
+    qsort(s_strings, s_stringCount, sizeof(DecodeString), CompareStrings);
+    status |= DecodeRecords(data, size, 1);
+    if (0 != status)
+    {
+        fprintf(stderr, "Binary log file %s is truncated or corrupted\n", filepath);
+    }
+
+    munmap((void *)data, size);
+    free(s_strings);
+    return (0 == status) ? 0 : 1;
+}
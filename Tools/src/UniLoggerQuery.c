@@ -0,0 +1,567 @@
+/**
+ * @file UniLoggerQuery.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Range queries on the indexed log files of UniLogger (unilogger-query)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Usage: unilogger-query [-u] [-v] [-s blocks] [-f from] [-t to] [-l levels] <log file>
+ *   -u  times of the logs and of the arguments are in UTC
+ *   -v  print the number of bytes scanned
+ *   -s  blocks scanned after a matching block (default 2), records of the
+ *       asynchronous modes can be written after the end of their block
+ *   -f  first time ("YYYY-MM-DD HH:MM:SS[:uuuuuu]" or ns since epoch)
+ *   -t  last time ("YYYY-MM-DD HH:MM:SS[:uuuuuu]" or ns since epoch)
+ *   -l  levels, comma separated names or numbers (ERROR,WARN or 2,3)
+ *
+ * Blocks of the index ("<log file>.idx") overlapping the time range and
+ * the levels are scanned, the logs of the blocks are filtered line by line.
+ * Logs after the last block (the open block) are always scanned, the whole
+ * file is scanned if there is no index. Text, JSON and logfmt logs are
+ * supported, binary logs have to be queried after unilogger-decode.
+ */
+// Required for timegm and strncasecmp
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif // _DEFAULT_SOURCE
+
+// System Include
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Time by which a log can be later than the time of its record in the index
+ * (the index takes the time before the log is formatted)
+ */
+#ifndef UL_QUERY_TIME_SLACK_NS
+#define UL_QUERY_TIME_SLACK_NS 10000000ULL
+#endif // UL_QUERY_TIME_SLACK_NS
+
+/**
+ * @brief Range of the log file to be scanned
+ */
+typedef struct QueryRange
+{
+    uint64_t start;
+    uint64_t end;
+} QueryRange;
+
+// Flag to read the times as UTC
+static unsigned char s_isUtc = 0;
+// Second of the cached "YYYY-MM-DD HH:MM:SS" prefix
+static char s_cachedPrefix[20];
+static int64_t s_cachedSecond = 0;
+
+/**
+ * @brief Parses the number of the digits
+ *
+ * @return const char* end of the number, NULL if there are no digits
+ */
+static const char *ParseNumber(const char *data, const char *end, uint64_t *value)
+{
+    const char *start = data;
+    *value = 0;
+    while (data < end && *data >= '0' && *data <= '9')
+    {
+        *value = *value * 10 + (uint64_t)(*data - '0');
+        data++;
+    }
+    return data == start ? NULL : data;
+}
+
+/**
+ * @brief Parses the time of the logs ("YYYY-MM-DD HH:MM:SS:uuuuuu" or ns since epoch)
+ *
+ * @param data start of the time
+ * @param end end of the data
+ * @param time parsed time in ns since epoch
+ * @return const char* end of the time, NULL if not a time
+ */
+static const char *ParseTime(const char *data, const char *end, uint64_t *time)
+{
+    uint64_t value;
+    const char *next = ParseNumber(data, end, &value);
+    if (NULL == next)
+    {
+        return NULL;
+    }
+    if (next == end || '-' != *next)
+    {
+        // Time Format epoch ns
+        *time = value;
+        return next;
+    }
+
+    // Date and time are converted once per second
+    if (end - data < 19)
+    {
+        return NULL;
+    }
+    int64_t second;
+    if (0 == memcmp(data, s_cachedPrefix, 19))
+    {
+        second = s_cachedSecond;
+    }
+    else
+    {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        char prefix[20];
+        memcpy(prefix, data, 19);
+        prefix[19] = '\0';
+        if (6 != sscanf(prefix, "%4d-%2d-%2d %2d:%2d:%2d",
+                        &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec))
+        {
+            return NULL;
+        }
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        second = (int64_t)(s_isUtc ? timegm(&tm) : mktime(&tm));
+        memcpy(s_cachedPrefix, prefix, sizeof(prefix));
+        s_cachedSecond = second;
+    }
+
+    // Microseconds are optional in the arguments
+    uint64_t microSeconds = 0;
+    next = data + 19;
+    if (next < end && ':' == *next)
+    {
+        next = ParseNumber(next + 1, end, &microSeconds);
+        if (NULL == next)
+        {
+            return NULL;
+        }
+    }
+    *time = (uint64_t)second * 1000000000ULL + microSeconds * 1000ULL;
+    return next;
+}
+
+/**
+ * @brief Parses the level name (padded with spaces for the text logs)
+ *
+ * @return int level, -1 if not a level
+ */
+static int ParseLevel(const char *data, size_t length)
+{
+    while (length && ' ' == *data)
+    {
+        data++;
+        length--;
+    }
+    while (length && ' ' == data[length - 1])
+    {
+        length--;
+    }
+
+    int level;
+    for (level = LOG_LEVEL_FATAL; level < LOG_MAX_LEVEL; level++)
+    {
+        const char *name = logLevelNames[level];
+        while (' ' == *name)
+        {
+            name++;
+        }
+        size_t nameLength = strlen(name);
+        while (nameLength && ' ' == name[nameLength - 1])
+        {
+            nameLength--;
+        }
+        if (nameLength == length && 0 == strncasecmp(name, data, length))
+        {
+            return level;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Finds the character in the line
+ */
+static const char *FindChar(const char *data, const char *end, char c)
+{
+    return (const char *)memchr(data, c, (size_t)(end - data));
+}
+
+/**
+ * @brief Parses the time and the level of the log
+ * Text  : [time]:[LEVEL] [tag:line] message
+ * JSON  : {"ts":"time","level":"LEVEL",...}
+ * logfmt: ts="time" level=LEVEL ...
+ *
+ * @return int 0 -> parsed, -1 -> not the start of a log (continuation line)
+ */
+static int ParseLog(const char *line, const char *end, uint64_t *time, int *level)
+{
+    const char *next;
+    if (end - line > 1 && '[' == line[0])
+    {
+        next = ParseTime(line + 1, end, time);
+        if (NULL == next || end - next < 3 || 0 != memcmp(next, "]:[", 3))
+        {
+            return -1;
+        }
+        const char *levelEnd = FindChar(next + 3, end, ']');
+        if (NULL == levelEnd)
+        {
+            return -1;
+        }
+        *level = ParseLevel(next + 3, (size_t)(levelEnd - next - 3));
+        return *level < 0 ? -1 : 0;
+    }
+
+    const char *levelKey;
+    if (end - line > 7 && 0 == memcmp(line, "{\"ts\":", 6))
+    {
+        next = line + 6;
+        levelKey = ",\"level\":\"";
+    }
+    else if (end - line > 3 && 0 == memcmp(line, "ts=", 3))
+    {
+        next = line + 3;
+        levelKey = " level=";
+    }
+    else
+    {
+        return -1;
+    }
+
+    if ('"' == *next)
+    {
+        next++;
+    }
+    next = ParseTime(next, end, time);
+    if (NULL == next)
+    {
+        return -1;
+    }
+    if (next < end && '"' == *next)
+    {
+        next++;
+    }
+    size_t keyLength = strlen(levelKey);
+    if ((size_t)(end - next) < keyLength || 0 != memcmp(next, levelKey, keyLength))
+    {
+        return -1;
+    }
+    next += keyLength;
+    const char *levelEnd = next;
+    while (levelEnd < end && '"' != *levelEnd && ' ' != *levelEnd && '\n' != *levelEnd)
+    {
+        levelEnd++;
+    }
+    *level = ParseLevel(next, (size_t)(levelEnd - next));
+    return *level < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Parses the levels of the argument (names or numbers separated by ',')
+ *
+ * @return uint32_t mask of the levels, 0 on invalid levels
+ */
+static uint32_t ParseLevels(const char *levels)
+{
+    uint32_t mask = 0;
+    while (*levels)
+    {
+        const char *end = strchr(levels, ',');
+        size_t length = end ? (size_t)(end - levels) : strlen(levels);
+        int level = -1;
+        if (1 == length && levels[0] > '0' && levels[0] < '0' + LOG_MAX_LEVEL)
+        {
+            level = levels[0] - '0';
+        }
+        else
+        {
+            level = ParseLevel(levels, length);
+        }
+        if (level < 0)
+        {
+            return 0;
+        }
+        mask |= 1u << level;
+        levels += length + (end ? 1 : 0);
+    }
+    return mask;
+}
+
+/**
+ * @brief Reads the entries of the index file
+ *
+ * @param indexPath path of the index file
+ * @param count number of entries read
+ * @return IndexEntry* entries (to be freed), NULL if the index is not available
+ */
+static IndexEntry *ReadIndex(const char *indexPath, size_t *count)
+{
+    *count = 0;
+    FILE *fp = fopen(indexPath, "rb");
+    if (NULL == fp)
+    {
+        return NULL;
+    }
+
+    IndexHeader header;
+    if (1 != fread(&header, sizeof(header), 1, fp) ||
+        0 != memcmp(header.magic, UL_INDEX_MAGIC, sizeof(UL_INDEX_MAGIC)) ||
+        UL_INDEX_VERSION != header.version || UL_INDEX_BYTE_ORDER != header.byteOrder)
+    {
+        fprintf(stderr, "Index file %s is invalid (or of another byte order)\n", indexPath);
+        fclose(fp);
+        return NULL;
+    }
+
+    struct stat fileStat;
+    if (0 != fstat(fileno(fp), &fileStat) || (size_t)fileStat.st_size < sizeof(header))
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    // Partial entry written at a crash is ignored
+    size_t capacity = ((size_t)fileStat.st_size - sizeof(header)) / sizeof(IndexEntry);
+    IndexEntry *entries = (IndexEntry *)malloc((capacity ? capacity : 1) * sizeof(IndexEntry));
+    if (NULL == entries)
+    {
+        fclose(fp);
+        return NULL;
+    }
+    *count = fread(entries, sizeof(IndexEntry), capacity, fp);
+    fclose(fp);
+    return entries;
+}
+
+/**
+ * @brief Adds the range, merged with the last range if overlapping
+ */
+static void AddRange(QueryRange *ranges, size_t *count, uint64_t start, uint64_t end)
+{
+    if (start >= end)
+    {
+        return;
+    }
+    if (*count && start <= ranges[*count - 1].end)
+    {
+        if (end > ranges[*count - 1].end)
+        {
+            ranges[*count - 1].end = end;
+        }
+        return;
+    }
+    ranges[*count].start = start;
+    ranges[*count].end = end;
+    (*count)++;
+}
+
+/**
+ * @brief Writes the logs of the range matching the time range and levels
+ */
+static void ScanRange(const char *data, uint64_t start, uint64_t end,
+                      uint64_t from, uint64_t to, uint32_t levelMask)
+{
+    // Start at the beginning of the line
+    while (start > 0 && '\n' != data[start - 1])
+    {
+        start--;
+    }
+
+    unsigned char isMatching = 0;
+    const char *line = data + start;
+    const char *rangeEnd = data + end;
+    while (line < rangeEnd && '\0' != *line)
+    {
+        const char *lineEnd = FindChar(line, rangeEnd, '\n');
+        lineEnd = lineEnd ? lineEnd + 1 : rangeEnd;
+
+        uint64_t time;
+        int level;
+        if (0 == ParseLog(line, lineEnd, &time, &level))
+        {
+            isMatching = time >= from && time <= to && ((levelMask >> level) & 1u);
+        }
+        // Lines of a multi-line log follow its first line
+        if (isMatching)
+        {
+            fwrite(line, 1, (size_t)(lineEnd - line), stdout);
+        }
+        line = lineEnd;
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    const char *filepath = NULL;
+    const char *fromArg = NULL;
+    const char *toArg = NULL;
+    uint32_t levelMask = ~0u;
+    unsigned long slackBlocks = 2;
+    unsigned char isVerbose = 0;
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "-u"))
+        {
+            s_isUtc = 1;
+        }
+        else if (0 == strcmp(argv[i], "-v"))
+        {
+            isVerbose = 1;
+        }
+        else if (0 == strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            slackBlocks = strtoul(argv[++i], NULL, 10);
+        }
+        else if (0 == strcmp(argv[i], "-f") && i + 1 < argc)
+        {
+            fromArg = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            toArg = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "-l") && i + 1 < argc)
+        {
+            levelMask = ParseLevels(argv[++i]);
+            if (0 == levelMask)
+            {
+                fprintf(stderr, "Invalid levels %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            filepath = argv[i];
+        }
+    }
+
+    if (NULL == filepath)
+    {
+        fprintf(stderr, "Usage: %s [-u] [-v] [-s blocks] [-f from] [-t to] [-l levels] <log file>\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t from = 0;
+    uint64_t to = UINT64_MAX;
+    if ((fromArg && NULL == ParseTime(fromArg, fromArg + strlen(fromArg), &from)) ||
+        (toArg && NULL == ParseTime(toArg, toArg + strlen(toArg), &to)))
+    {
+        fprintf(stderr, "Invalid time, expected \"YYYY-MM-DD HH:MM:SS[:uuuuuu]\" or ns since epoch\n");
+        return 1;
+    }
+    // Time without the microseconds includes the whole second
+    if (toArg && 19 == strlen(toArg) && '-' == toArg[4])
+    {
+        to += 999999999ULL;
+    }
+
+    int fd = open(filepath, O_RDONLY);
+    struct stat fileStat;
+    if (fd < 0 || 0 != fstat(fd, &fileStat))
+    {
+        fprintf(stderr, "Failed to open file %s\n", filepath);
+        return 1;
+    }
+    if (0 == fileStat.st_size)
+    {
+        close(fd);
+        return 0;
+    }
+
+    const char *data = (const char *)mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+    {
+        fprintf(stderr, "Failed to map file %s\n", filepath);
+        return 1;
+    }
+    uint64_t size = (uint64_t)fileStat.st_size;
+    if (UL_BINARY_MARKER == (unsigned char)data[0])
+    {
+        fprintf(stderr, "Binary log file %s, query the output of unilogger-decode\n", filepath);
+        munmap((void *)data, (size_t)size);
+        return 1;
+    }
+
+    size_t indexPathSize = strlen(filepath) + sizeof(UL_INDEX_SUFFIX);
+    char *indexPath = (char *)malloc(indexPathSize);
+    size_t entryCount = 0;
+    IndexEntry *entries = NULL;
+    if (indexPath)
+    {
+        snprintf(indexPath, indexPathSize, "%s" UL_INDEX_SUFFIX, filepath);
+        entries = ReadIndex(indexPath, &entryCount);
+        if (NULL == entries)
+        {
+            fprintf(stderr, "Index file %s is not available, scanning the whole file\n", indexPath);
+        }
+        free(indexPath);
+    }
+
+    // Head before the first block, matching blocks, and the open block after the last block
+    QueryRange *ranges = (QueryRange *)malloc((entryCount + 2) * sizeof(QueryRange));
+    if (NULL == ranges)
+    {
+        fprintf(stderr, "Failed to allocate the ranges\n");
+        munmap((void *)data, (size_t)size);
+        free(entries);
+        return 1;
+    }
+    size_t rangeCount = 0;
+    if (0 == entryCount)
+    {
+        AddRange(ranges, &rangeCount, 0, size);
+    }
+    else
+    {
+        AddRange(ranges, &rangeCount, 0, entries[0].startOffset < size ? entries[0].startOffset : size);
+        size_t entry;
+        for (entry = 0; entry < entryCount; entry++)
+        {
+            const IndexEntry *block = &entries[entry];
+            if (!(block->levelMask & levelMask) || block->firstTime > to ||
+                block->lastTime + UL_QUERY_TIME_SLACK_NS < from)
+            {
+                continue;
+            }
+            // Records of the block can be written in the next blocks
+            uint64_t end = (entry + slackBlocks < entryCount) ? entries[entry + slackBlocks].endOffset : size;
+            AddRange(ranges, &rangeCount, block->startOffset < size ? block->startOffset : size,
+                     end < size ? end : size);
+        }
+        uint64_t tail = entries[entryCount - 1].endOffset;
+        AddRange(ranges, &rangeCount, tail < size ? tail : size, size);
+    }
+
+    uint64_t scanned = 0;
+    size_t range;
+    for (range = 0; range < rangeCount; range++)
+    {
+        ScanRange(data, ranges[range].start, ranges[range].end, from, to, levelMask);
+        scanned += ranges[range].end - ranges[range].start;
+    }
+    fflush(stdout);
+
+    if (isVerbose)
+    {
+        fprintf(stderr, "Scanned %llu of %llu bytes in %zu ranges (%zu blocks in the index)\n",
+                (unsigned long long)scanned, (unsigned long long)size, rangeCount, entryCount);
+    }
+
+    munmap((void *)data, (size_t)size);
+    free(ranges);
+    free(entries);
+    return 0;
+}
@@ -35,7 +35,11 @@ extern "C"
  * #endif // LOG_TAG
  */
 #ifndef __FILENAME__
-#define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
+#ifdef __FILE_NAME__
+#define __FILENAME__ __FILE_NAME__
+#else
+#define __FILENAME__ (__builtin_strrchr(__FILE__, '/') ? __builtin_strrchr(__FILE__, '/') + 1 : __FILE__)
+#endif // __FILE_NAME__
 #endif // __FILENAME__
 
 #ifdef USE_FILE_NAME
@@ -77,9 +81,259 @@ extern "C"
         // For stdout stream prints
         STREAM_STDOUT,
         // For stderr stream prints
-        STREAM_STDERR
+        STREAM_STDERR,
+        // For socket of a local collector (UniLogger_SetLogSocket())
+        STREAM_SOCKET
     };
 
+    /**
+     * @brief Enum for Time Format of the Logs
+     */
+    enum LogTimeFormat
+    {
+        // Local time (YYYY-MM-DD HH:MM:SS:uuuuuu)
+        TIME_FORMAT_LOCAL,
+        // UTC time (YYYY-MM-DD HH:MM:SS:uuuuuu)
+        TIME_FORMAT_UTC,
+        // Nanoseconds since epoch
+        TIME_FORMAT_EPOCH_NS
+    };
+
+    /**
+     * @brief Enum for Encoding of the Logs
+     */
+    enum LogEncoding
+    {
+        // Formatted text logs (default)
+        ENCODING_TEXT,
+        // Binary records formatted offline by unilogger-decode
+        ENCODING_BINARY,
+        // JSON lines, one object per log
+        ENCODING_JSON,
+        // logfmt lines (key=value pairs)
+        ENCODING_LOGFMT
+    };
+
+    /**
+     * @brief Enum for Log File Sink
+     */
+    enum LogFileSink
+    {
+        // Logs are written to the file with write (default)
+        FILE_SINK_WRITE,
+        // Logs are copied to a memory mapping of the file
+        FILE_SINK_MMAP
+    };
+
+    /**
+     * @brief Enum for Log File Compression
+     */
+    enum LogFileCompression
+    {
+        // Log File is written as it is (default)
+        COMPRESSION_NONE,
+        // Blocks are written as gzip members (zlib)
+        COMPRESSION_GZIP,
+        // Blocks are written as LZ4 frames (liblz4)
+        COMPRESSION_LZ4,
+        // Blocks are written as zstd frames (libzstd)
+        COMPRESSION_ZSTD
+    };
+
+    /**
+     * @brief Enum for Asynchronous Logging Mode
+     */
+    enum LogAsyncMode
+    {
+        // Logs are written on the calling thread (default)
+        ASYNC_OFF,
+        // Logs are queued, callers wait when the queue is full
+        ASYNC_BLOCK,
+        // Logs are queued, new logs are dropped when the queue is full
+        ASYNC_DROP_NEWEST,
+        // Logs are queued, oldest logs are dropped when the queue is full
+        ASYNC_DROP_OLDEST,
+        // Logs are queued per thread and merged in order, callers wait when their queue is full
+        ASYNC_PER_THREAD
+    };
+
+    /**
+     * @brief Static descriptor of a log call site
+     * Defined by every expansion of the log macros, registered at the first log
+     *
+     * @paragraph
+     * LOG_TAG must be a constant expression (string literal), as it is used
+     * in the initializer of the descriptor
+     */
+    typedef struct UniLoggerCallSite
+    {
+        // Log level of the call site
+        enum LogLevel level;
+        // Log tag of the call site
+        const char *logTag;
+        // Line number of the call site
+        unsigned int lineNum;
+        // File name of the call site (without directory)
+        const char *fileName;
+        // Id of the call site, 0 till registered
+        unsigned int id;
+        // Format of the first log of the call site
+        const char *format;
+        // Pre-rendered "]:[LEVEL] [tag:line] " part of the log, read after the id is non-zero
+        const char *prefix;
+        // Length of the prefix
+        unsigned int prefixLength;
+        // Next registered call site
+        struct UniLoggerCallSite *next;
+        // Level mask of the tag of the call site, resolved at the first log
+        const unsigned int *levelMask;
+    } UniLoggerCallSite;
+
+    /**
+     * @brief Enum for Rate Limit of a call site
+     */
+    enum LogRateLimit
+    {
+        // Every Nth log of the call site is written
+        RATE_LIMIT_EVERY_N,
+        // First N logs of the call site are written
+        RATE_LIMIT_FIRST_N,
+        // At most one log of the call site in N milliseconds is written
+        RATE_LIMIT_EVERY_MS,
+        // N logs per second with bursts of M logs (token bucket)
+        RATE_LIMIT_TOKEN_BUCKET
+    };
+
+    /**
+     * @brief State of the rate limit of a call site
+     * Defined by every expansion of the rate limited log macros
+     */
+    typedef struct UniLoggerRateLimit
+    {
+        // Number of logs of the call site
+        unsigned long long count;
+        // Number of logs suppressed since the last written log
+        unsigned long long suppressed;
+        // Time of the last written log (EVERY_MS) or theoretical arrival time (TOKEN_BUCKET) in ns
+        unsigned long long timeNs;
+        // Call site of the rate limit, the suppressed logs are reported as its logs
+        UniLoggerCallSite *callSite;
+        // Time of the last report of the suppressed logs in ns
+        unsigned long long reportNs;
+        // Flag set when the rate limit is registered for the periodic reports
+        int isRegistered;
+        // Next registered rate limit
+        struct UniLoggerRateLimit *next;
+    } UniLoggerRateLimit;
+
+    /**
+     * @brief Formatted log submitted with UniLogger_LogBatch()
+     */
+    typedef struct UniLoggerRecord
+    {
+        // Log level of the log
+        enum LogLevel level;
+        // Log tag of the log (string literal for binary encoding)
+        const char *logTag;
+        // Line number of the log
+        unsigned int lineNum;
+        // Message of the log
+        const char *message;
+    } UniLoggerRecord;
+
+    /**
+     * @brief Enum for Type of a structured field
+     */
+    enum UniLoggerFieldType
+    {
+        UL_FIELD_INT,
+        UL_FIELD_UINT,
+        UL_FIELD_DOUBLE,
+        UL_FIELD_STRING,
+        UL_FIELD_BOOL
+    };
+
+    /**
+     * @brief Key and value of a structured log (UL_INT(), UL_STR(), ...)
+     * Key and string value are not copied, they must be valid during the log
+     */
+    typedef struct UniLoggerField
+    {
+        // Key of the field
+        const char *key;
+        // Type of the value
+        enum UniLoggerFieldType type;
+        // Value of the field
+        union
+        {
+            long long intValue;
+            unsigned long long uintValue;
+            double doubleValue;
+            const char *stringValue;
+        } value;
+    } UniLoggerField;
+
+    /**
+     * @brief Function of a custom sink
+     * Called with every formatted log of the enabled levels of the sink
+     *
+     * @param context context passed to UniLogger_AddCustomSink()
+     * @param level log level of the log
+     * @param data formatted log without color codes (ends with a newline)
+     * @param length length of the log
+     */
+    typedef void (*UniLoggerSinkFn)(void *context, enum LogLevel level, const char *data, size_t length);
+
+    /**
+     * @brief Runtime statistics of the logger, counted from the start of the process
+     */
+    typedef struct UniLoggerStats
+    {
+        // Records written to the Log Stream, per level
+        unsigned long long emitted[LOG_MAX_LEVEL];
+        // Records not written because of the log level (seen by the library), per level
+        unsigned long long filtered[LOG_MAX_LEVEL];
+        // Records dropped by a full queue, shared ring or socket buffer, per level (not counted in emitted)
+        unsigned long long dropped[LOG_MAX_LEVEL];
+        // Repeated records written as a summary (UniLogger_SetDuplicateCollapse()), per level
+        unsigned long long collapsed[LOG_MAX_LEVEL];
+        // Bytes written to the Log Stream / Log File and the sinks
+        unsigned long long bytesWritten;
+        // Write system calls
+        unsigned long long writeCalls;
+        // Failed writes
+        unsigned long long failedWrites;
+        // Contended locks of the log mutex
+        unsigned long long mutexWaits;
+        // Time waiting for the log mutex in ns
+        unsigned long long mutexWaitNs;
+        // Time in the write system calls in ns
+        unsigned long long ioNs;
+    } UniLoggerStats;
+
+    /**
+     * @brief Static descriptor of a profile scope
+     * Defined by every expansion of LOG_PROFILE_SCOPE(), registered at the first use
+     */
+    typedef struct UniLoggerProfileSite
+    {
+        // Name of the scope (string literal)
+        const char *name;
+        // Id of the scope, 0 till registered
+        unsigned int id;
+    } UniLoggerProfileSite;
+
+    /**
+     * @brief Profile scope, measured till the end of the enclosing block
+     */
+    typedef struct UniLoggerProfileScope
+    {
+        // Descriptor of the scope
+        UniLoggerProfileSite *site;
+        // Start time of the scope in ns (CLOCK_MONOTONIC), 0 if not profiled
+        unsigned long long startNs;
+    } UniLoggerProfileScope;
+
     /**
      * @brief Set the Log Level for Logging
      *
@@ -87,6 +341,15 @@ extern "C"
      */
     void UniLogger_SetLogLevel(enum LogLevel level);
 
+    /**
+     * @brief Set the Log Level of a Tag
+     * Logs of the tag use this level instead of the level of UniLogger_SetLogLevel()
+     *
+     * @param logTag log tag (LOG_TAG)
+     * @param level Log Level (LogLevel)
+     */
+    void UniLogger_SetTagLevel(const char *logTag, enum LogLevel level);
+
     /**
      * @brief Set the Log Stream
      *
@@ -101,6 +364,213 @@ extern "C"
      */
     void UniLogger_SetLogFile(const char *filepath);
 
+    /**
+     * @brief Sends Logs to the socket of a local collector instead of console print
+     * Logs are buffered and sent by a background thread, which reconnects while the collector is down
+     *
+     * @param address "unix:<path>", "unix-stream:<path>", "udp:<host>:<port>" or "tcp:<host>:<port>"
+     *                (NULL -> UL_SOCKET_DEFAULT_ADDRESS)
+     * @param bufferSize size of the buffer in bytes, logs beyond it are dropped (0 -> 1 MB)
+     */
+    void UniLogger_SetLogSocket(const char *address, unsigned int bufferSize);
+
+    /**
+     * @brief Set the Time Format of the Logs
+     *
+     * @param format time format (LogTimeFormat)
+     */
+    void UniLogger_SetTimeFormat(enum LogTimeFormat format);
+
+    /**
+     * @brief Set the Rotation of the Log File
+     * Must be called after UniLogger_SetLogFile()
+     *
+     * @param maxSize maximum size of the log file in bytes (0 -> no limit)
+     * @param rotateInterval rotation interval in seconds (0 -> no interval)
+     * @param keepFiles number of rotated files kept (<file>.1 to <file>.N)
+     */
+    void UniLogger_SetLogFileRotation(unsigned long long maxSize,
+                                      unsigned int rotateInterval,
+                                      unsigned int keepFiles);
+
+    /**
+     * @brief Set the Sink of the Log File
+     * Must be called after UniLogger_SetLogFile()
+     *
+     * @param sink log file sink (LogFileSink)
+     */
+    void UniLogger_SetLogFileSink(enum LogFileSink sink);
+
+    /**
+     * @brief Set the Compression of the Log File
+     * Logs are compressed in blocks by a background thread, every block is a
+     * complete frame, so the file can be read (zcat, lz4cat, zstdcat) while it grows.
+     * Must be called after UniLogger_SetLogFile() and before the first log,
+     * not supported with the rotation, the memory mapped sink and the index
+     *
+     * @param compression log file compression (LogFileCompression)
+     * @param blockSize uncompressed bytes of a block (0 -> default)
+     * @param flushInterval milliseconds after which a partly filled block is written (0 -> default)
+     */
+    void UniLogger_SetLogFileCompression(enum LogFileCompression compression,
+                                         unsigned int blockSize,
+                                         unsigned int flushInterval);
+
+    /**
+     * @brief Set the Sidecar Index of the Log File ("<file>.idx", read by unilogger-query)
+     * A block of the index is closed every blockRecords records or blockBytes bytes.
+     * Must be called after UniLogger_SetLogFile(), not supported with the rotation
+     *
+     * @param blockRecords records in a block (0 -> no limit)
+     * @param blockBytes bytes of the log file in a block (0 -> no limit)
+     */
+    void UniLogger_SetLogFileIndex(unsigned int blockRecords, unsigned long long blockBytes);
+
+    /**
+     * @brief Adds a console sink, logs are written with color codes
+     * Logs are written to every sink in addition to the Log Stream / Log File
+     *
+     * @param stream console stream (LogStream)
+     * @param level Log Level of the sink (LogLevel)
+     * @return int 0 -> Success, -1 -> Failure
+     */
+    int UniLogger_AddConsoleSink(enum LogStream stream, enum LogLevel level);
+
+    /**
+     * @brief Adds a file sink, logs are written without color codes
+     *
+     * @param filepath filepath to save the log
+     * @param level Log Level of the sink (LogLevel)
+     * @return int 0 -> Success, -1 -> Failure
+     */
+    int UniLogger_AddFileSink(const char *filepath, enum LogLevel level);
+
+    /**
+     * @brief Adds a custom sink (socket, ring buffer, ...)
+     *
+     * @param sinkFn function called with every log of the sink
+     * @param context context passed to sinkFn
+     * @param level Log Level of the sink (LogLevel)
+     * @return int 0 -> Success, -1 -> Failure
+     */
+    int UniLogger_AddCustomSink(UniLoggerSinkFn sinkFn, void *context, enum LogLevel level);
+
+    /**
+     * @brief Set the Encoding of the Logs
+     * Binary logs are not formatted while logging, format strings must be literals
+     *
+     * @param encoding log encoding (LogEncoding)
+     */
+    void UniLogger_SetLogEncoding(enum LogEncoding encoding);
+
+    /**
+     * @brief Set the Asynchronous Logging Mode
+     * Logs are queued and written by a background thread
+     *
+     * @param mode asynchronous mode (LogAsyncMode)
+     * @param queueSize number of logs in the queue, per thread for ASYNC_PER_THREAD (0 for default)
+     */
+    void UniLogger_SetAsyncMode(enum LogAsyncMode mode, unsigned int queueSize);
+
+    /**
+     * @brief Set the Shared Memory Ring of the processes
+     * Logs of all the processes using the ring are written to one file by unilogger-collector,
+     * instead of the Log Stream / Log File of the process
+     *
+     * @param name name of the shared memory object (NULL for "/unilogger")
+     * @param ringSize number of logs in the ring, used if the ring is created (0 for default)
+     */
+    void UniLogger_SetSharedRing(const char *name, unsigned int ringSize);
+
+    /**
+     * @brief Set the Flight Recorder
+     * Logs till the level are kept in an in-memory ring, written only by
+     * LOG_FATAL(), UniLogger_DumpFlightRecorder() or on a crash signal
+     *
+     * @param level Log Level of the kept logs (LOG_LEVEL_OFF -> disabled)
+     * @param size number of logs in the ring (0 for default)
+     */
+    void UniLogger_SetFlightRecorder(enum LogLevel level, unsigned int size);
+
+    /**
+     * @brief Writes the logs kept by the Flight Recorder to the stream
+     */
+    void UniLogger_DumpFlightRecorder();
+
+    /**
+     * @brief Set the Interval of the Profile Dump
+     * Statistics of the profile scopes are written every interval by a background thread
+     *
+     * @param interval dump interval in seconds (0 -> only UniLogger_DumpProfile())
+     */
+    void UniLogger_SetProfileDump(unsigned int interval);
+
+    /**
+     * @brief Writes the statistics of every profile scope (count, min, mean, p50, p99 and max)
+     */
+    void UniLogger_DumpProfile();
+
+    /**
+     * @brief Gets the runtime statistics of the logger
+     *
+     * @param stats statistics summed over all the threads
+     */
+    void UniLogger_GetStats(UniLoggerStats *stats);
+
+    /**
+     * @brief Set the Interval of the Statistics Report
+     * Statistics of the last interval are written as INFO log by a background thread
+     *
+     * @param interval report interval in seconds (0 -> no report)
+     */
+    void UniLogger_SetStatsReport(unsigned int interval);
+
+    /**
+     * @brief Set the Cost Counters of the Call Sites
+     * Hits, bytes and time spent formatting and writing are counted for every log call site,
+     * the dump is also written on SIGUSR2
+     *
+     * @param topCount number of call sites written by the dump (0 -> counters are disabled)
+     */
+    void UniLogger_SetCallSiteStats(unsigned int topCount);
+
+    /**
+     * @brief Writes the call sites with the highest time spent formatting and writing
+     *
+     * @param topCount number of call sites to be written (0 -> count set by UniLogger_SetCallSiteStats())
+     */
+    void UniLogger_DumpCallSiteStats(unsigned int topCount);
+
+    /**
+     * @brief Set the Collapsing of the Repeated Logs
+     * A log equal to one of the recent logs of the thread (same call site and message) is not written,
+     * its repeats are written as one "Message repeated N times in T ms" log of the call site
+     *
+     * @param windowSize recent logs compared per thread (0 -> collapsing is disabled, maximum 16)
+     * @param flushInterval milliseconds after which the repeats are written (0 -> default)
+     */
+    void UniLogger_SetDuplicateCollapse(unsigned int windowSize, unsigned int flushInterval);
+
+    /**
+     * @brief Reads the clock of the profile scopes
+     *
+     * @return unsigned long long CLOCK_MONOTONIC time in ns
+     */
+    unsigned long long UniLogger_ProfileNow();
+
+    /**
+     * @brief Ends the profile scope, used by LOG_PROFILE_SCOPE()
+     * Duration of the scope is added to the histogram of the scope in the calling thread
+     *
+     * @param scope profile scope
+     */
+    void UniLogger_EndProfileScope(UniLoggerProfileScope *scope);
+
+    /**
+     * @brief Function to write all the pending logs to the stream
+     */
+    void UniLogger_Flush();
+
     /**
      * @brief Function to close the UniLogger
      */
@@ -120,48 +590,323 @@ extern "C"
                                unsigned int lineNum,
                                const char *format, ...);
 
+    /**
+     * @brief Log function used by the log macros
+     *
+     * @param callSite descriptor of the call site
+     * @param format print format arguments
+     * @param ...
+     */
+    void UniLogger_LogCallSite(UniLoggerCallSite *callSite,
+                               const char *format, ...);
+
+    /**
+     * @brief Log function used by the structured log macros (LOG_<LEVEL>_KV)
+     *
+     * @param callSite descriptor of the call site
+     * @param message message of the log
+     * @param fields fields of the log
+     * @param count number of fields
+     */
+    void UniLogger_LogFields(UniLoggerCallSite *callSite,
+                             const char *message,
+                             const UniLoggerField *fields,
+                             unsigned int count);
+
+    /**
+     * @brief Log function to write many logs together
+     * Logs of enabled levels are formatted and written with a single write
+     *
+     * @param records logs to be written
+     * @param count number of logs
+     */
+    void UniLogger_LogBatch(const UniLoggerRecord *records, unsigned int count);
+
+    /**
+     * @brief Checks if the log of a rate limited call site can be written
+     *
+     * @param rateLimit state of the rate limit of the call site
+     * @param kind rate limit (LogRateLimit)
+     * @param value N of the rate limit (count, milliseconds or logs per second)
+     * @param burst burst of the token bucket
+     * @param suppressed number of logs suppressed before this log
+     * @return int 1 -> write the log, 0 -> suppress the log
+     */
+    int UniLogger_RateLimitAllows(UniLoggerRateLimit *rateLimit,
+                                  enum LogRateLimit kind,
+                                  unsigned int value,
+                                  unsigned int burst,
+                                  unsigned long long *suppressed);
+
+    /**
+     * @brief Writes the number of suppressed logs of the call site
+     *
+     * @param callSite descriptor of the call site
+     * @param suppressed number of suppressed logs
+     */
+    void UniLogger_LogSuppressed(UniLoggerCallSite *callSite, unsigned long long suppressed);
+
+    /**
+     * @brief Get the registered call sites (call sites which logged at least once)
+     *
+     * @return const UniLoggerCallSite* first call site, linked by next
+     */
+    const UniLoggerCallSite *UniLogger_GetCallSites();
+
+    // Bit mask of the enabled log levels (bit n for LogLevel n), written or kept by the flight recorder
+    extern unsigned int gCurrLogLevelMask;
+
+    /**
+     * @brief Checks if the log level is enabled
+     * Used by the log macros before evaluating the arguments
+     *
+     * @param level log level
+     * @return int 1 -> enabled, 0 -> disabled
+     */
+    static inline int UniLogger_IsLevelEnabled(enum LogLevel level)
+    {
+        return (int)((__atomic_load_n(&gCurrLogLevelMask, __ATOMIC_RELAXED) >> (unsigned int)level) & 1u);
+    }
+
+    /**
+     * @brief Level mask of the call sites which are not resolved to their tag
+     */
+    extern const unsigned int gUnresolvedLevelMask;
+
+    /**
+     * @brief Checks if the level of the call site is enabled for its tag
+     * Unresolved call sites are enabled, resolved at the first log
+     *
+     * @param callSite descriptor of the call site
+     * @return int 1 -> enabled, 0 -> disabled
+     */
+    static inline int UniLogger_IsCallSiteEnabled(const UniLoggerCallSite *callSite)
+    {
+        const unsigned int *levelMask = __atomic_load_n(&callSite->levelMask, __ATOMIC_ACQUIRE);
+        return (int)((__atomic_load_n(levelMask, __ATOMIC_RELAXED) >> (unsigned int)callSite->level) & 1u);
+    }
+
+    /**
+     * @brief Creates the fields of the structured logs
+     */
+    static inline UniLoggerField UniLogger_IntField(const char *key, long long value)
+    {
+        UniLoggerField field;
+        field.key = key;
+        field.type = UL_FIELD_INT;
+        field.value.intValue = value;
+        return field;
+    }
+
+    static inline UniLoggerField UniLogger_UintField(const char *key, unsigned long long value)
+    {
+        UniLoggerField field;
+        field.key = key;
+        field.type = UL_FIELD_UINT;
+        field.value.uintValue = value;
+        return field;
+    }
+
+    static inline UniLoggerField UniLogger_DoubleField(const char *key, double value)
+    {
+        UniLoggerField field;
+        field.key = key;
+        field.type = UL_FIELD_DOUBLE;
+        field.value.doubleValue = value;
+        return field;
+    }
+
+    static inline UniLoggerField UniLogger_StringField(const char *key, const char *value)
+    {
+        UniLoggerField field;
+        field.key = key;
+        field.type = UL_FIELD_STRING;
+        field.value.stringValue = value;
+        return field;
+    }
+
+    static inline UniLoggerField UniLogger_BoolField(const char *key, int value)
+    {
+        UniLoggerField field;
+        field.key = key;
+        field.type = UL_FIELD_BOOL;
+        field.value.intValue = value ? 1 : 0;
+        return field;
+    }
+
+/**
+ * @brief Logs with level greater than this are removed at compile time
+ * Set with the CMake option UL_COMPILE_TIME_MIN_LEVEL (default 7, all logs)
+ *
+ * @paragraph
+ * Example: 4 keeps FATAL, ERROR, WARN and INFO logs
+ */
+#ifndef UL_COMPILE_TIME_MIN_LEVEL
+#define UL_COMPILE_TIME_MIN_LEVEL 7
+#endif // UL_COMPILE_TIME_MIN_LEVEL
+
+/**
+ * @brief Common log method, arguments are evaluated only if the level is enabled
+ * Every expansion defines the static descriptor of its call site
+ */
+#define UL_LOG(level, ...) (__extension__({                                                        \
+    static UniLoggerCallSite _ulCallSite = {level, LOG_TAG, __LINE__, __FILENAME__, 0, 0, 0, 0, 0, \
+                                            &gUnresolvedLevelMask};                                \
+    (((level) <= UL_COMPILE_TIME_MIN_LEVEL) && UniLogger_IsCallSiteEnabled(&_ulCallSite))          \
+        ? UniLogger_LogCallSite(&_ulCallSite, ##__VA_ARGS__)                                       \
+        : (void)0;                                                                                 \
+}))
+
+/**
+ * @brief Fields of the structured logs
+ */
+#define UL_INT(key, value) UniLogger_IntField(key, (long long)(value))
+#define UL_UINT(key, value) UniLogger_UintField(key, (unsigned long long)(value))
+#define UL_DOUBLE(key, value) UniLogger_DoubleField(key, (double)(value))
+#define UL_STR(key, value) UniLogger_StringField(key, value)
+#define UL_BOOL(key, value) UniLogger_BoolField(key, (value) ? 1 : 0)
+
+/**
+ * @brief Structured log method, fields are kept on the stack of the caller
+ * Fields are evaluated only if the level is enabled
+ */
+#define UL_LOG_KV(level, message, ...) (__extension__({                                            \
+    static UniLoggerCallSite _ulCallSite = {level, LOG_TAG, __LINE__, __FILENAME__, 0, 0, 0, 0, 0, \
+                                            &gUnresolvedLevelMask};                                \
+    if (((level) <= UL_COMPILE_TIME_MIN_LEVEL) && UniLogger_IsCallSiteEnabled(&_ulCallSite))       \
+    {                                                                                              \
+        const UniLoggerField _ulFields[] = {__VA_ARGS__};                                          \
+        UniLogger_LogFields(&_ulCallSite, message, _ulFields,                                      \
+                            (unsigned int)(sizeof(_ulFields) / sizeof(UniLoggerField)));           \
+    }                                                                                              \
+}))
+
+/**
+ * @brief Rate limited log method, the state of the rate limit is kept per call site
+ * Number of suppressed logs is written before the next written log, by the suppressed
+ * logs every UL_RATE_LIMIT_REPORT_MS and by UniLogger_Flush()
+ */
+#define UL_LOG_RATE_LIMITED(level, kind, value, burst, ...) (__extension__({                       \
+    static UniLoggerCallSite _ulCallSite = {level, LOG_TAG, __LINE__, __FILENAME__, 0, 0, 0, 0, 0, \
+                                            &gUnresolvedLevelMask};                                \
+    static UniLoggerRateLimit _ulRateLimit = {0, 0, 0, &_ulCallSite, 0, 0, 0};                     \
+    unsigned long long _ulSuppressed = 0;                                                          \
+    (((level) <= UL_COMPILE_TIME_MIN_LEVEL) && UniLogger_IsCallSiteEnabled(&_ulCallSite) &&        \
+     UniLogger_RateLimitAllows(&_ulRateLimit, kind, value, burst, &_ulSuppressed))                 \
+        ? ((_ulSuppressed ? UniLogger_LogSuppressed(&_ulCallSite, _ulSuppressed) : (void)0),       \
+           UniLogger_LogCallSite(&_ulCallSite, ##__VA_ARGS__))                                     \
+        : (void)0;                                                                                 \
+}))
+
+/**
+ * @brief Writes every Nth log of the call site
+ */
+#define UL_LOG_EVERY_N(level, n, ...) UL_LOG_RATE_LIMITED(level, RATE_LIMIT_EVERY_N, n, 0, ##__VA_ARGS__)
+/**
+ * @brief Writes the first N logs of the call site
+ */
+#define UL_LOG_FIRST_N(level, n, ...) UL_LOG_RATE_LIMITED(level, RATE_LIMIT_FIRST_N, n, 0, ##__VA_ARGS__)
+/**
+ * @brief Writes at most one log of the call site every ms milliseconds
+ */
+#define UL_LOG_EVERY_MS(level, ms, ...) UL_LOG_RATE_LIMITED(level, RATE_LIMIT_EVERY_MS, ms, 0, ##__VA_ARGS__)
+/**
+ * @brief Writes rate logs per second with bursts of burst logs
+ */
+#define UL_LOG_THROTTLED(level, rate, burst, ...) UL_LOG_RATE_LIMITED(level, RATE_LIMIT_TOKEN_BUCKET, rate, burst, ##__VA_ARGS__)
+
 /**
  * @brief Log method for fatal error
  */
-#define LOG_FATAL(...) UniLogger_CustomLogFn(LOG_LEVEL_FATAL, \
-                                             LOG_TAG,         \
-                                             __LINE__, ##__VA_ARGS__)
+#define LOG_FATAL(...) UL_LOG(LOG_LEVEL_FATAL, ##__VA_ARGS__)
 /**
  * @brief Log method for default error
  */
-#define LOG_ERROR(...) UniLogger_CustomLogFn(LOG_LEVEL_ERROR, \
-                                             LOG_TAG,         \
-                                             __LINE__, ##__VA_ARGS__)
+#define LOG_ERROR(...) UL_LOG(LOG_LEVEL_ERROR, ##__VA_ARGS__)
 /**
  * @brief Log method for warnings
  */
-#define LOG_WARN(...) UniLogger_CustomLogFn(LOG_LEVEL_WARN, \
-                                            LOG_TAG,        \
-                                            __LINE__, ##__VA_ARGS__)
+#define LOG_WARN(...) UL_LOG(LOG_LEVEL_WARN, ##__VA_ARGS__)
 /**
  * @brief Log method for information logs
  */
-#define LOG_INFO(...) UniLogger_CustomLogFn(LOG_LEVEL_INFO, \
-                                            LOG_TAG,        \
-                                            __LINE__, ##__VA_ARGS__)
+#define LOG_INFO(...) UL_LOG(LOG_LEVEL_INFO, ##__VA_ARGS__)
 /**
  * @brief Log method for debug logs
  */
-#define LOG_DEBUG(...) UniLogger_CustomLogFn(LOG_LEVEL_DEBUG, \
-                                             LOG_TAG,         \
-                                             __LINE__, ##__VA_ARGS__)
+#define LOG_DEBUG(...) UL_LOG(LOG_LEVEL_DEBUG, ##__VA_ARGS__)
 /**
  * @brief Log method for trace logs
  */
-#define LOG_TRACE(...) UniLogger_CustomLogFn(LOG_LEVEL_TRACE, \
-                                             LOG_TAG,         \
-                                             __LINE__, ##__VA_ARGS__)
+#define LOG_TRACE(...) UL_LOG(LOG_LEVEL_TRACE, ##__VA_ARGS__)
 /**
  * @brief Log method for profile logs
  */
-#define LOG_PROFILE(...) UniLogger_CustomLogFn(LOG_LEVEL_PROFILE, \
-                                               LOG_TAG,           \
-                                               __LINE__, ##__VA_ARGS__)
+#define LOG_PROFILE(...) UL_LOG(LOG_LEVEL_PROFILE, ##__VA_ARGS__)
+
+/**
+ * @brief Structured log methods, LOG_<LEVEL>_KV(message, UL_INT("key", value), ...)
+ */
+#define LOG_FATAL_KV(message, ...) UL_LOG_KV(LOG_LEVEL_FATAL, message, ##__VA_ARGS__)
+#define LOG_ERROR_KV(message, ...) UL_LOG_KV(LOG_LEVEL_ERROR, message, ##__VA_ARGS__)
+#define LOG_WARN_KV(message, ...) UL_LOG_KV(LOG_LEVEL_WARN, message, ##__VA_ARGS__)
+#define LOG_INFO_KV(message, ...) UL_LOG_KV(LOG_LEVEL_INFO, message, ##__VA_ARGS__)
+#define LOG_DEBUG_KV(message, ...) UL_LOG_KV(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
+#define LOG_TRACE_KV(message, ...) UL_LOG_KV(LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
+#define LOG_PROFILE_KV(message, ...) UL_LOG_KV(LOG_LEVEL_PROFILE, message, ##__VA_ARGS__)
+
+/**
+ * @brief Concatenates the tokens after expanding them
+ */
+#define UL_CONCAT_(first, second) first##second
+#define UL_CONCAT(first, second) UL_CONCAT_(first, second)
+
+/**
+ * @brief Profiles the enclosing block, its duration is added to the histogram of name
+ * Nothing is written per scope, statistics are written by UniLogger_DumpProfile()
+ */
+#define LOG_PROFILE_SCOPE(name)                                                  \
+    static UniLoggerProfileSite UL_CONCAT(_ulProfileSite, __LINE__) = {name, 0}; \
+    UniLoggerProfileScope UL_CONCAT(_ulProfileScope, __LINE__)                   \
+        __attribute__((cleanup(UniLogger_EndProfileScope))) = {                  \
+            &UL_CONCAT(_ulProfileSite, __LINE__),                                \
+            ((LOG_LEVEL_PROFILE <= UL_COMPILE_TIME_MIN_LEVEL) &&                 \
+             UniLogger_IsLevelEnabled(LOG_LEVEL_PROFILE))                        \
+                ? UniLogger_ProfileNow()                                         \
+                : 0}
+
+/**
+ * @brief Rate limited log methods, LOG_<LEVEL>_EVERY_N(n, ...), LOG_<LEVEL>_FIRST_N(n, ...),
+ * LOG_<LEVEL>_EVERY_MS(ms, ...) and LOG_<LEVEL>_THROTTLED(rate, burst, ...)
+ */
+#define LOG_FATAL_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_FATAL, n, ##__VA_ARGS__)
+#define LOG_FATAL_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_FATAL, n, ##__VA_ARGS__)
+#define LOG_FATAL_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_FATAL, ms, ##__VA_ARGS__)
+#define LOG_FATAL_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_FATAL, rate, burst, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_ERROR, n, ##__VA_ARGS__)
+#define LOG_ERROR_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_ERROR, n, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_ERROR, ms, ##__VA_ARGS__)
+#define LOG_ERROR_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_ERROR, rate, burst, ##__VA_ARGS__)
+#define LOG_WARN_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_WARN, n, ##__VA_ARGS__)
+#define LOG_WARN_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_WARN, n, ##__VA_ARGS__)
+#define LOG_WARN_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_WARN, ms, ##__VA_ARGS__)
+#define LOG_WARN_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_WARN, rate, burst, ##__VA_ARGS__)
+#define LOG_INFO_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_INFO, n, ##__VA_ARGS__)
+#define LOG_INFO_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_INFO, n, ##__VA_ARGS__)
+#define LOG_INFO_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_INFO, ms, ##__VA_ARGS__)
+#define LOG_INFO_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_INFO, rate, burst, ##__VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_DEBUG, n, ##__VA_ARGS__)
+#define LOG_DEBUG_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_DEBUG, n, ##__VA_ARGS__)
+#define LOG_DEBUG_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_DEBUG, ms, ##__VA_ARGS__)
+#define LOG_DEBUG_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_DEBUG, rate, burst, ##__VA_ARGS__)
+#define LOG_TRACE_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_TRACE, n, ##__VA_ARGS__)
+#define LOG_TRACE_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_TRACE, n, ##__VA_ARGS__)
+#define LOG_TRACE_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_TRACE, ms, ##__VA_ARGS__)
+#define LOG_TRACE_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_TRACE, rate, burst, ##__VA_ARGS__)
+#define LOG_PROFILE_EVERY_N(n, ...) UL_LOG_EVERY_N(LOG_LEVEL_PROFILE, n, ##__VA_ARGS__)
+#define LOG_PROFILE_FIRST_N(n, ...) UL_LOG_FIRST_N(LOG_LEVEL_PROFILE, n, ##__VA_ARGS__)
+#define LOG_PROFILE_EVERY_MS(ms, ...) UL_LOG_EVERY_MS(LOG_LEVEL_PROFILE, ms, ##__VA_ARGS__)
+#define LOG_PROFILE_THROTTLED(rate, burst, ...) UL_LOG_THROTTLED(LOG_LEVEL_PROFILE, rate, burst, ##__VA_ARGS__)
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,463 @@
+/**
+ * @file UniLogger.hpp
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Type safe C++17 front-end of UniLogger with "{}" format strings
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * The "{}" format of every call site is parsed at compile time and checked
+ * against the types of the arguments, a mismatch is a compile error. The
+ * format is translated at compile time into a printf format with the
+ * conversion of every argument type (e.g. "{}" -> "%lld" for integers),
+ * stored once per call site, and logged through UniLogger_LogCallSite().
+ * Nothing of the "{}" format is parsed at runtime, the logs follow the log
+ * levels, encodings and sinks of UniLogger (binary encoding saves only the
+ * values of the arguments).
+ *
+ * Format : "{}" for an argument, "{{" and "}}" for braces,
+ *          "{:[<|>][flags][width][.precision][type]}" with printf flags and types
+ */
+#ifndef __UNI_LOGGER_HPP__
+#define __UNI_LOGGER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <UniLogger.h>
+
+namespace UniLogger
+{
+    namespace detail
+    {
+        /**
+         * @brief Kind of the argument, decides the printf conversion
+         */
+        enum class ArgKind
+        {
+            Invalid,
+            Signed,
+            Unsigned,
+            Floating,
+            LongDouble,
+            Char,
+            Bool,
+            String,
+            StringView,
+            Pointer
+        };
+
+        /**
+         * @brief Errors of the format, reported by static_assert
+         */
+        enum class FormatError
+        {
+            None,
+            ArgumentCount,
+            UnmatchedBrace,
+            InvalidSpec,
+            UnsupportedType
+        };
+
+        /**
+         * @brief Serialization of the argument types
+         * Kind of the type and conversion of the value to the printf arguments
+         */
+        template <typename T, typename = void>
+        struct ArgTraits
+        {
+            static constexpr ArgKind kind = ArgKind::Invalid;
+        };
+
+        template <>
+        struct ArgTraits<bool>
+        {
+            static constexpr ArgKind kind = ArgKind::Bool;
+            static std::tuple<const char *> Convert(bool value) { return std::tuple<const char *>(value ? "true" : "false"); }
+        };
+
+        template <>
+        struct ArgTraits<char>
+        {
+            static constexpr ArgKind kind = ArgKind::Char;
+            static std::tuple<int> Convert(char value) { return std::tuple<int>(value); }
+        };
+
+        template <typename T>
+        struct ArgTraits<T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T> &&
+                                             !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+        {
+            static constexpr ArgKind kind = ArgKind::Signed;
+            static std::tuple<long long> Convert(T value) { return std::tuple<long long>(value); }
+        };
+
+        template <typename T>
+        struct ArgTraits<T, std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T> &&
+                                             !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+        {
+            static constexpr ArgKind kind = ArgKind::Unsigned;
+            static std::tuple<unsigned long long> Convert(T value) { return std::tuple<unsigned long long>(value); }
+        };
+
+        template <typename T>
+        struct ArgTraits<T, std::enable_if_t<std::is_enum_v<T>>>
+            : ArgTraits<std::underlying_type_t<T>>
+        {
+            static auto Convert(T value) { return ArgTraits<std::underlying_type_t<T>>::Convert(static_cast<std::underlying_type_t<T>>(value)); }
+        };
+
+        template <typename T>
+        struct ArgTraits<T, std::enable_if_t<std::is_same_v<T, float> || std::is_same_v<T, double>>>
+        {
+            static constexpr ArgKind kind = ArgKind::Floating;
+            static std::tuple<double> Convert(T value) { return std::tuple<double>(value); }
+        };
+
+        template <>
+        struct ArgTraits<long double>
+        {
+            static constexpr ArgKind kind = ArgKind::LongDouble;
+            static std::tuple<long double> Convert(long double value) { return std::tuple<long double>(value); }
+        };
+
+        template <>
+        struct ArgTraits<const char *>
+        {
+            static constexpr ArgKind kind = ArgKind::String;
+            static std::tuple<const char *> Convert(const char *value) { return std::tuple<const char *>(value); }
+        };
+
+        template <>
+        struct ArgTraits<char *> : ArgTraits<const char *>
+        {
+        };
+
+        template <>
+        struct ArgTraits<std::string>
+        {
+            static constexpr ArgKind kind = ArgKind::String;
+            static std::tuple<const char *> Convert(const std::string &value) { return std::tuple<const char *>(value.c_str()); }
+        };
+
+        template <>
+        struct ArgTraits<std::string_view>
+        {
+            // Not null terminated, written with "%.*s"
+            static constexpr ArgKind kind = ArgKind::StringView;
+            static std::tuple<int, const char *> Convert(std::string_view value)
+            {
+                return std::tuple<int, const char *>(static_cast<int>(value.size()), value.data());
+            }
+        };
+
+        template <typename T>
+        struct ArgTraits<T *, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>>
+        {
+            static constexpr ArgKind kind = ArgKind::Pointer;
+            static std::tuple<const void *> Convert(const T *value) { return std::tuple<const void *>(value); }
+        };
+
+        template <>
+        struct ArgTraits<std::nullptr_t>
+        {
+            static constexpr ArgKind kind = ArgKind::Pointer;
+            static std::tuple<const void *> Convert(std::nullptr_t) { return std::tuple<const void *>(nullptr); }
+        };
+
+        /**
+         * @brief Argument type without reference and const (arrays as pointers)
+         */
+        template <typename T>
+        using ArgType = std::decay_t<T>;
+
+        /**
+         * @brief Checks if the printf type is valid for the argument kind
+         */
+        constexpr bool IsValidType(ArgKind kind, char type)
+        {
+            switch (kind)
+            {
+            case ArgKind::Signed:
+            case ArgKind::Unsigned:
+            case ArgKind::Char:
+                return 'd' == type || 'x' == type || 'X' == type || 'o' == type ||
+                       ('u' == type && ArgKind::Unsigned == kind) || ('c' == type && ArgKind::Char == kind);
+            case ArgKind::Floating:
+            case ArgKind::LongDouble:
+                return 'e' == type || 'E' == type || 'f' == type || 'F' == type ||
+                       'g' == type || 'G' == type || 'a' == type || 'A' == type;
+            case ArgKind::Bool:
+            case ArgKind::String:
+            case ArgKind::StringView:
+                return 's' == type;
+            case ArgKind::Pointer:
+                return 'p' == type;
+            default:
+                return false;
+            }
+        }
+
+        /**
+         * @brief Default printf type of the argument kind
+         */
+        constexpr char DefaultType(ArgKind kind)
+        {
+            switch (kind)
+            {
+            case ArgKind::Signed:
+                return 'd';
+            case ArgKind::Unsigned:
+                return 'u';
+            case ArgKind::Floating:
+            case ArgKind::LongDouble:
+                return 'g';
+            case ArgKind::Char:
+                return 'c';
+            case ArgKind::Pointer:
+                return 'p';
+            default:
+                return 's';
+            }
+        }
+
+        /**
+         * @brief printf format translated from the "{}" format
+         * Every "{}" (2 characters) is at most 4 characters, every '%' is 2 characters
+         */
+        template <std::size_t Capacity>
+        struct PrintfFormat
+        {
+            char data[Capacity];
+            FormatError error;
+        };
+
+        /**
+         * @brief Translates the "{}" format into the printf format of the argument kinds
+         *
+         * @param format "{}" format
+         * @param kinds kinds of the arguments
+         * @param count number of arguments
+         * @return PrintfFormat<Capacity> printf format, or the error of the format
+         */
+        template <std::size_t Capacity>
+        constexpr PrintfFormat<Capacity> Translate(std::string_view format, const ArgKind *kinds, std::size_t count)
+        {
+            PrintfFormat<Capacity> result{{}, FormatError::None};
+            std::size_t length = 0;
+            std::size_t argIndex = 0;
+            std::size_t i = 0;
+            while (i < format.size())
+            {
+                char c = format[i++];
+                if ('}' == c)
+                {
+                    if (i < format.size() && '}' == format[i])
+                    {
+                        result.data[length++] = '}';
+                        i++;
+                        continue;
+                    }
+                    result.error = FormatError::UnmatchedBrace;
+                    return result;
+                }
+                if ('%' == c)
+                {
+                    result.data[length++] = '%';
+                    result.data[length++] = '%';
+                    continue;
+                }
+                if ('{' != c)
+                {
+                    result.data[length++] = c;
+                    continue;
+                }
+                if (i < format.size() && '{' == format[i])
+                {
+                    result.data[length++] = '{';
+                    i++;
+                    continue;
+                }
+
+                // Argument, with optional [flags][width][.precision][type]
+                if (argIndex >= count)
+                {
+                    result.error = FormatError::ArgumentCount;
+                    return result;
+                }
+                ArgKind kind = kinds[argIndex++];
+                if (ArgKind::Invalid == kind)
+                {
+                    result.error = FormatError::UnsupportedType;
+                    return result;
+                }
+
+                std::size_t specStart = i;
+                std::size_t specEnd = i;
+                char type = DefaultType(kind);
+                bool hasPrecision = false;
+                bool isLeftAligned = false;
+                if (i < format.size() && ':' == format[i])
+                {
+                    i++;
+                    // Alignment of "{}" formats, right is the default of printf
+                    if (i < format.size() && ('<' == format[i] || '>' == format[i]))
+                    {
+                        isLeftAligned = ('<' == format[i++]);
+                    }
+                    specStart = i;
+                    while (i < format.size() && ('-' == format[i] || '+' == format[i] || ' ' == format[i] ||
+                                                 '#' == format[i] || '0' == format[i]))
+                    {
+                        i++;
+                    }
+                    while (i < format.size() && format[i] >= '0' && format[i] <= '9')
+                    {
+                        i++;
+                    }
+                    if (i < format.size() && '.' == format[i])
+                    {
+                        hasPrecision = true;
+                        i++;
+                        while (i < format.size() && format[i] >= '0' && format[i] <= '9')
+                        {
+                            i++;
+                        }
+                    }
+                    specEnd = i;
+                    if (i < format.size() && '}' != format[i])
+                    {
+                        type = format[i++];
+                        if (!IsValidType(kind, type))
+                        {
+                            result.error = FormatError::InvalidSpec;
+                            return result;
+                        }
+                    }
+                }
+                if (i >= format.size() || '}' != format[i])
+                {
+                    result.error = (i >= format.size()) ? FormatError::UnmatchedBrace : FormatError::InvalidSpec;
+                    return result;
+                }
+                i++;
+
+                // Precision of the string view is its length
+                if (ArgKind::StringView == kind && hasPrecision)
+                {
+                    result.error = FormatError::InvalidSpec;
+                    return result;
+                }
+
+                result.data[length++] = '%';
+                if (isLeftAligned)
+                {
+                    result.data[length++] = '-';
+                }
+                for (std::size_t j = specStart; j < specEnd; j++)
+                {
+                    result.data[length++] = format[j];
+                }
+                if (ArgKind::StringView == kind)
+                {
+                    result.data[length++] = '.';
+                    result.data[length++] = '*';
+                }
+                else if (ArgKind::Signed == kind || ArgKind::Unsigned == kind)
+                {
+                    // Integers are passed as long long / unsigned long long
+                    result.data[length++] = 'l';
+                    result.data[length++] = 'l';
+                    if ('d' == type && ArgKind::Unsigned == kind)
+                    {
+                        type = 'u';
+                    }
+                }
+                else if (ArgKind::LongDouble == kind)
+                {
+                    result.data[length++] = 'L';
+                }
+                result.data[length++] = type;
+            }
+
+            if (argIndex != count)
+            {
+                result.error = FormatError::ArgumentCount;
+            }
+            result.data[length] = '\0';
+            return result;
+        }
+
+        /**
+         * @brief printf format of the call site, translated once at compile time
+         *
+         * @tparam Format type with static constexpr Get() returning the "{}" format
+         * @tparam Args types of the arguments
+         */
+        template <typename Format, typename... Args>
+        struct CallSiteFormat
+        {
+            static constexpr ArgKind kinds[] = {ArgTraits<Args>::kind..., ArgKind::Invalid};
+            static constexpr auto value =
+                Translate<2 * Format::Get().size() + 1>(Format::Get(), kinds, sizeof...(Args));
+        };
+
+        /**
+         * @brief Logs the arguments with the translated format of the call site
+         *
+         * @param callSite descriptor of the call site
+         * @param args arguments of the log
+         */
+        template <typename Format, typename... Args>
+        inline void Log(UniLoggerCallSite *callSite, const Args &...args)
+        {
+            using SiteFormat = CallSiteFormat<Format, ArgType<Args>...>;
+            static_assert(((ArgTraits<ArgType<Args>>::kind != ArgKind::Invalid) && ...),
+                          "UniLogger: unsupported argument type");
+            static_assert(SiteFormat::value.error != FormatError::ArgumentCount,
+                          "UniLogger: number of {} in format does not match the number of arguments");
+            static_assert(SiteFormat::value.error != FormatError::UnmatchedBrace,
+                          "UniLogger: unmatched { or } in format, use {{ and }} for braces");
+            static_assert(SiteFormat::value.error != FormatError::InvalidSpec,
+                          "UniLogger: invalid format specification for the argument type");
+            static_assert(SiteFormat::value.error == FormatError::None, "UniLogger: invalid format");
+
+            std::apply([callSite](auto... values)
+                       { UniLogger_LogCallSite(callSite, SiteFormat::value.data, values...); },
+                       std::tuple_cat(ArgTraits<ArgType<Args>>::Convert(args)...));
+        }
+    } // namespace detail
+} // namespace UniLogger
+
+/**
+ * @brief Type safe log method with "{}" format, format must be a string literal
+ */
+#define UL_LOG_FMT(level, format, ...) (__extension__({                                           \
+    static UniLoggerCallSite _ulCallSite = {level, LOG_TAG, __LINE__, __FILENAME__, 0, 0, 0, 0, 0, \
+                                            &gUnresolvedLevelMask};                                \
+    struct _UlFormat                                                                               \
+    {                                                                                              \
+        static constexpr std::string_view Get() { return format; }                                 \
+    };                                                                                             \
+    if (((level) <= UL_COMPILE_TIME_MIN_LEVEL) && UniLogger_IsCallSiteEnabled(&_ulCallSite))       \
+    {                                                                                              \
+        UniLogger::detail::Log<_UlFormat>(&_ulCallSite, ##__VA_ARGS__);                            \
+    }                                                                                              \
+}))
+
+/**
+ * @brief Type safe log methods, LOG_<LEVEL>_FMT("id {} name {}", id, name)
+ */
+#define LOG_FATAL_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_FATAL, format, ##__VA_ARGS__)
+#define LOG_ERROR_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define LOG_WARN_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_INFO_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_DEBUG_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_TRACE_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_TRACE, format, ##__VA_ARGS__)
+#define LOG_PROFILE_FMT(format, ...) UL_LOG_FMT(LOG_LEVEL_PROFILE, format, ##__VA_ARGS__)
+
+#endif // __UNI_LOGGER_HPP__
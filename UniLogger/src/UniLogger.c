@@ -9,35 +9,93 @@
  *
  */
 // System Include
-#include <sys/time.h>
 #include <time.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <UniLogger.h>
+#include "UniLoggerInternal.h"
 
 // Global Variables
 
 // Current Log Level, Default to Off
 enum LogLevel gCurrLogLevel = LOG_LEVEL_OFF;
+// Bit mask of the enabled log levels, checked by the log macros
+unsigned int gCurrLogLevelMask = 0;
 // Flag to Check Environment variable for Log Level is Read or not
 unsigned char gIsLogLevelInitalized = 0;
 
 // Current Log Stream, Default to stdout
-static FILE *gCurrLogStream;
+FILE *gCurrLogStream;
 // Flag to Check Environment variable for Log Stream is Read or not
 unsigned char gIsLogStreamInitalized = 0;
 
 // Flag to Check is Log File Initalized, Default to 0
 unsigned char gIsLogFileInitalized = 0;
+// Flag to Check is Log File opened in append mode (needed by the rotation)
+unsigned char gIsLogFileAppending = 0;
+// Flag to Check is Socket Log Stream Initalized
+unsigned char gIsLogSocketInitalized = 0;
 
 // Mutex for log handler
-static pthread_mutex_t s_logMutex;
+pthread_mutex_t s_logMutex;
 
 // Flag to check mutex initalized
 unsigned char gIsMutexInitalized = 0;
 
+// Flag to Check Environment variable for Time Format is Read or not
+unsigned char gIsLogTimeInitalized = 0;
+
+// Current Log Encoding, Default to text
+enum LogEncoding gCurrLogEncoding = ENCODING_TEXT;
+// Flag to Check Environment variable for Log Encoding is Read or not
+unsigned char gIsLogEncodingInitalized = 0;
+
+// Flag to Check Environment variable for Async Mode is Read or not
+unsigned char gIsLogAsyncInitalized = 0;
+// Flag to Check Environment variables for Log File Rotation are Read or not
+unsigned char gIsLogRotationInitalized = 0;
+// Flag to Check Environment variable for Log File Sink is Read or not
+unsigned char gIsLogFileSinkInitalized = 0;
+// Flag to Check Environment variables for Log File Compression are Read or not
+unsigned char gIsLogCompressionInitalized = 0;
+// Flag to Check Environment variable for Profile Dump is Read or not
+unsigned char gIsLogProfileInitalized = 0;
+// Flag to Check Environment variables for Flight Recorder are Read or not
+unsigned char gIsLogRecorderInitalized = 0;
+// Flag to Check Environment variable for Statistics Report is Read or not
+unsigned char gIsLogStatsInitalized = 0;
+// Flag to Check is Log File Index Initalized
+unsigned char gIsLogIndexInitalized = 0;
+// Flag to Check is Shared Ring Initalized
+unsigned char gIsLogSharedRingInitalized = 0;
+// Flag to Check Environment variable for Call Site Statistics is Read or not
+unsigned char gIsLogCallSiteStatsInitalized = 0;
+// Flag to Check Environment variables for Duplicate Collapse are Read or not
+unsigned char gIsLogDuplicateInitalized = 0;
+// Path of the Log File
+static char gCurrLogFilePath[4096];
+
+/**
+ * @brief Format of the structured logs, arguments are message, fields and count
+ * Identified by its address, the text of the format is not used
+ */
+static const char s_fieldsFormat[] = "%s";
+
+/**
+ * @brief Format of the repeats of a collapsed log, arguments are count and span in ms
+ * Identified by its address, the summaries are never collapsed
+ */
+static const char s_repeatedFormat[] = "Message repeated %llu times in %llu ms";
+
+// Buffer of the thread for formatting the log outside the mutex
+static __thread char t_stagingBuffer[UL_STAGING_BUFFER_SIZE];
+// Bytes formatted by the thread for the current log, counted for the call site statistics
+static __thread size_t t_recordLength = 0;
+
 /**
  * @brief Log level names
  */
@@ -68,19 +126,17 @@ const char colorCodes[LOG_MAX_LEVEL][10] = {
  * @brief Method to log line
  *
  * @param stream type of the stream
- * @param logLevelName log level name in string
+ * @param level log level
  * @param logTag log tag in string
  * @param lineNum log line number
- * @param colorCode color code for the for log level
  * @param isSavingToFile flag to save the log to file
  * @param format format of print
  * @param ... arguments of print
  */
 static inline void LogLine(FILE *stream,
-                           const char *logLevelName,
+                           enum LogLevel level,
                            const char *logTag,
                            unsigned int lineNum,
-                           const char *colorCode,
                            unsigned char isSavingToFile,
                            const char *format,
                            ...);
@@ -89,53 +145,61 @@ static inline void LogLine(FILE *stream,
  * @brief Method to log the line with va_list args
  *
  * @param stream type of the stream
- * @param logLevelName log level name in string
- * @param logTag log tag in string
- * @param lineNum log line number
- * @param colorCode color code for the for log level
+ * @param callSite descriptor of the call site
  * @param isSavingToFile flag to save the log to file
  * @param args args of the print
  * @param format format of the print
+ * @param encoding encoding of the log
  */
 static inline void LogLineArgs(FILE *stream,
-                               const char *logLevelName,
-                               const char *logTag,
-                               unsigned int lineNum,
-                               const char *colorCode,
+                               const UniLoggerCallSite *callSite,
                                unsigned char isSavingToFile,
                                va_list args,
-                               const char *format);
+                               const char *format,
+                               enum LogEncoding encoding);
 
 /**
  * @brief Information log
  */
-#define INFO_LOG(...) LogLine(stdout,                        \
-                              logLevelNames[LOG_LEVEL_INFO], \
-                              LOG_TAG,                       \
-                              __LINE__,                      \
-                              colorCodes[LOG_LEVEL_INFO],    \
+#define INFO_LOG(...) LogLine(stdout,         \
+                              LOG_LEVEL_INFO, \
+                              LOG_TAG,        \
+                              __LINE__,       \
                               0, ##__VA_ARGS__)
 
 /**
  * @brief Error log
  */
-#define ERROR_LOG(...) LogLine(stdout,                         \
-                               logLevelNames[LOG_LEVEL_ERROR], \
-                               LOG_TAG,                        \
-                               __LINE__,                       \
-                               colorCodes[LOG_LEVEL_ERROR],    \
+#define ERROR_LOG(...) LogLine(stdout,          \
+                               LOG_LEVEL_ERROR, \
+                               LOG_TAG,         \
+                               __LINE__,        \
                                0, ##__VA_ARGS__)
 
 /**
  * @brief Warning log
  */
-#define WARN_LOG(...) LogLine(stdout,                        \
-                              logLevelNames[LOG_LEVEL_WARN], \
-                              LOG_TAG,                       \
-                              __LINE__,                      \
-                              colorCodes[LOG_LEVEL_WARN],    \
+#define WARN_LOG(...) LogLine(stdout,         \
+                              LOG_LEVEL_WARN, \
+                              LOG_TAG,        \
+                              __LINE__,       \
                               0, ##__VA_ARGS__)
 
+/**
+ * @brief Sets the current log level and the mask of enabled levels
+ *
+ * @param level log level
+ */
+static inline void SetCurrLogLevel(enum LogLevel level)
+{
+    unsigned int mask = LevelMask(level);
+
+    gCurrLogLevel = level;
+    __atomic_store_n(&gCurrLogLevelMask, PublishedMask(mask), __ATOMIC_RELAXED);
+
+    // tags without their own level follow the current level
+    TagLevel_SetDefault(mask);
+}
 /**
  * @brief Print Available Log Levels
  *
@@ -178,116 +242,522 @@ int InitalizeMutex()
 }
 
 /**
- * @brief Function to initalize the log file with respective to the stream
+ * @brief Function to initalize the log file
+ * File is opened as a new stream, stdout and stderr stay with the console
  *
- * @param stream current selected stream
  * @param filepath filepath to save the log
  * @return true
  * @return false
  */
-unsigned char InitalizeLogFile(FILE *stream, const char *filepath)
+unsigned char InitalizeLogFile(const char *filepath)
 {
     unsigned char isInitalized = 1;
-    FILE *fp = freopen(filepath, "w", stream);
+    FILE *fp = fopen(filepath, "w");
     if (!fp)
     {
         ERROR_LOG("Failed to open file %s for writing", filepath);
         isInitalized = 0;
     }
+    else
+    {
+        snprintf(gCurrLogFilePath, sizeof(gCurrLogFilePath), "%s", filepath);
+
+        // Logs are group committed under s_logMutex, O_APPEND keeps the writes at the end after a rotation
+        int flags = fcntl(fileno(fp), F_GETFL);
+        gIsLogFileAppending = (flags >= 0 && 0 == fcntl(fileno(fp), F_SETFL, flags | O_APPEND));
+
+        // Output of the console is written before the logs move to the file
+        fflush(gCurrLogStream);
+        gCurrLogStream = fp;
+    }
     return isInitalized;
 }
 
-static inline void LogLineArgs(FILE *stream,
-                               const char *logLevelName,
-                               const char *logTag,
-                               unsigned int lineNum,
-                               const char *colorCode,
+/**
+ * @brief Clamps the return value of snprintf to the bytes in buffer
+ *
+ * @param written return value of snprintf
+ * @param available size of the buffer
+ * @return size_t number of bytes in buffer (excluding null)
+ */
+static inline size_t ClampWritten(int written, size_t available)
+{
+    if (written < 0 || 0 == available)
+    {
+        return 0;
+    }
+    if ((size_t)written >= available)
+    {
+        return available - 1;
+    }
+    return (size_t)written;
+}
+
+/**
+ * @brief Formats a complete log line into buffer
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param isSavingToFile flag to remove the color codes
+ * @param args args of the print
+ * @param format format of the print
+ * @param encoding encoding of the log
+ * @param requiredSize size required for the complete log (NULL if not required)
+ * @return size_t number of bytes written (always ends with a newline)
+ */
+static size_t EncodeLogRecord(char *buffer,
+                              size_t bufferSize,
+                              const UniLoggerCallSite *callSite,
+                              unsigned char isSavingToFile,
+                              va_list args,
+                              const char *format,
+                              enum LogEncoding encoding,
+                              size_t *requiredSize);
+
+/**
+ * @brief Formats a complete log line into buffer (text or binary encoding)
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param isSavingToFile flag to remove the color codes
+ * @param encoding encoding of the log (ENCODING_TEXT or ENCODING_BINARY)
+ * @param requiredSize size required for the complete log (NULL if not required)
+ * @param format format of the print
+ * @param ... arguments of the print
+ * @return size_t number of bytes written
+ */
+static size_t RenderTextRecord(char *buffer,
+                               size_t bufferSize,
+                               const UniLoggerCallSite *callSite,
                                unsigned char isSavingToFile,
-                               va_list args,
-                               const char *format)
+                               enum LogEncoding encoding,
+                               size_t *requiredSize,
+                               const char *format,
+                               ...)
 {
-    static char dateTime[50];
-    struct timeval currTime;
+    va_list args;
+    va_start(args, format);
+    size_t length = EncodeLogRecord(buffer, bufferSize, callSite, isSavingToFile,
+                                    args, format, encoding, requiredSize);
+    va_end(args);
+    return length;
+}
 
-    // Get time
-    gettimeofday(&currTime, NULL);
-
-    struct tm tm = *localtime((time_t *)(&currTime.tv_sec));
-    sprintf(dateTime,
-#if __linux__
-            "%d-%02d-%02d %02d:%02d:%02d:%06ld",
-#else
-            "%d-%02d-%02d %02d:%02d:%02d:%06d",
-#endif // __linux__
-            tm.tm_year + 1900,
-            tm.tm_mon + 1,
-            tm.tm_mday,
-            tm.tm_hour,
-            tm.tm_min,
-            tm.tm_sec,
-            currTime.tv_usec);
+static size_t EncodeLogRecord(char *buffer,
+                              size_t bufferSize,
+                              const UniLoggerCallSite *callSite,
+                              unsigned char isSavingToFile,
+                              va_list args,
+                              const char *format,
+                              enum LogEncoding encoding,
+                              size_t *requiredSize)
+{
+    // Structured logs
+    if (s_fieldsFormat == format)
+    {
+        const char *message = va_arg(args, const char *);
+        const UniLoggerField *fields = va_arg(args, const UniLoggerField *);
+        unsigned int count = va_arg(args, unsigned int);
+        if (ENCODING_JSON == encoding || ENCODING_LOGFMT == encoding)
+        {
+            // Encoded in place, long records are truncated at the fields
+            if (requiredSize)
+            {
+                *requiredSize = 0;
+            }
+            return Structured_EncodeRecord(buffer, bufferSize, callSite, encoding, message, fields, count);
+        }
+        return RenderTextRecord(buffer, bufferSize, callSite, isSavingToFile, encoding, requiredSize,
+                                "%s", Structured_Text(message, fields, count));
+    }
 
-    // To avoid interleaved messages
-    if (gIsMutexInitalized)
+    // printf logs as structured records with the message only
+    if (ENCODING_JSON == encoding || ENCODING_LOGFMT == encoding)
+    {
+        if (requiredSize)
+        {
+            *requiredSize = 0;
+        }
+        return Structured_EncodeArgs(buffer, bufferSize, callSite, encoding, args, format);
+    }
+
+    // Binary records are formatted offline
+    if (ENCODING_BINARY == encoding)
     {
-        pthread_mutex_lock(&s_logMutex);
+        if (requiredSize)
+        {
+            *requiredSize = 0;
+        }
+        return EncodeBinaryRecord(buffer, bufferSize, callSite, args, format);
     }
 
+    unsigned char level = (unsigned char)callSite->level;
+    char dateTime[UL_TIMESTAMP_SIZE];
+    size_t dateTimeLength;
+    struct timespec currTime;
+
+    // Get time
+    Timestamp_Now(&currTime);
+    dateTimeLength = Timestamp_Format(&currTime, dateTime);
+
+    // Reserve space for the suffix, so that truncated logs still end the line
+    const char *suffix = isSavingToFile ? "\n" : "\033[1;0m\n";
+    size_t suffixLength = strlen(suffix);
+    size_t limit = bufferSize - suffixLength;
+    size_t length = 0;
+
     // if saving to file remove color codes
-    if (isSavingToFile)
-    {
-        // remove the color codes
-        fprintf(stream,
-                "[%s]:[%s] [%s:%d] ",
-                dateTime,
-                logLevelName,
-                logTag,
-                lineNum);
-        vfprintf(stream, format, args);
-        vfprintf(stream, "\n", args);
+    if (!isSavingToFile)
+    {
+        length = strlen(colorCodes[level]);
+        memcpy(buffer, colorCodes[level], length);
+    }
+
+    // The prefix is published by the release store of the id
+    const char *prefix = NULL;
+    size_t prefixLength = 0;
+    if (0 != __atomic_load_n(&callSite->id, __ATOMIC_ACQUIRE))
+    {
+        prefix = callSite->prefix;
+        prefixLength = callSite->prefixLength;
+    }
+
+    if (prefix && length + 1 + dateTimeLength + prefixLength < limit)
+    {
+        // Pre-rendered level, tag and line of the call site
+        buffer[length++] = '[';
+        memcpy(buffer + length, dateTime, dateTimeLength);
+        length += dateTimeLength;
+        memcpy(buffer + length, prefix, prefixLength);
+        length += prefixLength;
     }
     else
     {
-        fprintf(stream,
-                "%s[%s]:[%s] [%s:%d] ",
-                colorCode,
-                dateTime,
-                logLevelName,
-                logTag,
-                lineNum);
-        vfprintf(stream, format, args);
-        vfprintf(stream, "\033[1;0m\n", args);
+        length += ClampWritten(snprintf(buffer + length,
+                                        limit - length,
+                                        "[%s]:[%s] [%s:%d] ",
+                                        dateTime,
+                                        logLevelNames[level],
+                                        callSite->logTag,
+                                        callSite->lineNum),
+                               limit - length);
+    }
+    int written = vsnprintf(buffer + length, limit - length, format, args);
+    if (requiredSize)
+    {
+        *requiredSize = length + (written > 0 ? (size_t)written : 0) + suffixLength + 1;
+    }
+    length += ClampWritten(written, limit - length);
+
+    memcpy(buffer + length, suffix, suffixLength + 1);
+    return length + suffixLength;
+}
+
+/**
+ * @brief Formats a complete log line into buffer, see EncodeLogRecord()
+ * Length is added to the bytes of the current log of the thread
+ */
+static size_t RenderLogRecord(char *buffer,
+                              size_t bufferSize,
+                              const UniLoggerCallSite *callSite,
+                              unsigned char isSavingToFile,
+                              va_list args,
+                              const char *format,
+                              enum LogEncoding encoding,
+                              size_t *requiredSize)
+{
+    size_t length = EncodeLogRecord(buffer, bufferSize, callSite, isSavingToFile,
+                                    args, format, encoding, requiredSize);
+    t_recordLength += length;
+    return length;
+}
+
+size_t FormatLogRecord(char *buffer,
+                       size_t bufferSize,
+                       const UniLoggerCallSite *callSite,
+                       unsigned char isSavingToFile,
+                       va_list args,
+                       const char *format)
+{
+    return RenderLogRecord(buffer, bufferSize, callSite, isSavingToFile, args, format, gCurrLogEncoding, NULL);
+}
+
+size_t FormatTextRecord(char *buffer,
+                        size_t bufferSize,
+                        const UniLoggerCallSite *callSite,
+                        va_list args,
+                        const char *format)
+{
+    return RenderLogRecord(buffer, bufferSize, callSite, 1, args, format, ENCODING_TEXT, NULL);
+}
+
+size_t FormatQueuedRecord(char *buffer,
+                          size_t bufferSize,
+                          const UniLoggerCallSite *callSite,
+                          va_list args,
+                          const char *format,
+                          enum LogEncoding encoding,
+                          char **overflow)
+{
+    size_t requiredSize;
+    size_t length;
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    *overflow = NULL;
+
+    if (ENCODING_TEXT != encoding)
+    {
+        // Size is not known before encoding, limited by the buffer of the synchronous logs
+        length = RenderLogRecord(t_stagingBuffer, sizeof(t_stagingBuffer), callSite, 1,
+                                 args, format, encoding, NULL);
+        va_end(argsCopy);
+        if (length <= bufferSize)
+        {
+            memcpy(buffer, t_stagingBuffer, length);
+            return length;
+        }
+
+        *overflow = (char *)malloc(length);
+        if (NULL == *overflow)
+        {
+            // Partial record can not be decoded, its strings are written again with the next records
+            if (ENCODING_BINARY == encoding && BinaryFormat_HasStrings(t_stagingBuffer, length))
+            {
+                BinaryFormat_ResetStrings();
+            }
+            Stats_DropRecord(callSite->level);
+            return 0;
+        }
+        memcpy(*overflow, t_stagingBuffer, length);
+        return length;
+    }
+
+    length = RenderLogRecord(buffer, bufferSize, callSite, 1, args, format, encoding, &requiredSize);
+    if (requiredSize > bufferSize)
+    {
+        *overflow = (char *)malloc(requiredSize);
+        if (*overflow)
+        {
+            // Truncated log is not counted
+            t_recordLength -= length;
+            length = RenderLogRecord(*overflow, requiredSize, callSite, 1,
+                                     argsCopy, format, encoding, NULL);
+        }
+        else if (length > 4)
+        {
+            // Truncated log is marked
+            memcpy(buffer + length - 4, "...\n", 4);
+        }
+    }
+    va_end(argsCopy);
+    return length;
+}
+
+void WriteLogData(FILE *stream, const char *data, size_t length)
+{
+    struct iovec vector = {(void *)data, length};
+    WriteLogVectors(stream, &vector, 1);
+}
+
+void WriteLogVectors(FILE *stream, const struct iovec *vectors, int count)
+{
+    int i;
+    if (stream == gCurrLogStream && SocketSink_IsRunning())
+    {
+        // Copied to the buffer of the socket, sent by its thread
+        SocketSink_Write(vectors, count);
+        return;
+    }
+
+    if (stream == gCurrLogStream && CompressSink_IsRunning())
+    {
+        // Copied to the open block, compressed and written by its thread
+        CompressSink_Write(vectors, count);
+        return;
+    }
+
+    if (stream == gCurrLogStream && MmapSink_IsRunning())
+    {
+        // Copied to the mapping of the file, no system call
+        // Log File is written without color codes, logs are in a single part
+        size_t length = 0;
+        for (i = 0; i < count; i++)
+        {
+            MmapSink_Write((const char *)vectors[i].iov_base, vectors[i].iov_len);
+            Stats_AddBytes(vectors[i].iov_len);
+            length += vectors[i].iov_len;
+        }
+        if (Index_IsRunning())
+        {
+            Index_AddBytes(length);
+        }
+        return;
+    }
+
+    if (stream == gCurrLogStream && gIsMutexInitalized)
+    {
+        // Written together with the records of the other threads
+        size_t written = GroupCommit_Write(stream, vectors, count);
+        if (written && Rotation_IsRunning())
+        {
+            Rotation_AddBytes(written);
+        }
+        return;
     }
 
     // To avoid interleaved messages
     if (gIsMutexInitalized)
+    {
+        Stats_LockMutex(&s_logMutex);
+    }
+    unsigned long long start = Stats_Now();
+    size_t written = 0;
+    size_t length = 0;
+    for (i = 0; i < count; i++)
+    {
+        written += fwrite(vectors[i].iov_base, 1, vectors[i].iov_len, stream);
+        length += vectors[i].iov_len;
+    }
+    Stats_AddWrite(written, Stats_Now() - start, written != length);
+    if (stream == gCurrLogStream && Index_IsRunning())
+    {
+        Index_AddBytes(written);
+    }
+    if (gIsMutexInitalized)
     {
         pthread_mutex_unlock(&s_logMutex);
     }
 }
 
+static inline void LogLineArgs(FILE *stream,
+                               const UniLoggerCallSite *callSite,
+                               unsigned char isSavingToFile,
+                               va_list args,
+                               const char *format,
+                               enum LogEncoding encoding)
+{
+    size_t requiredSize;
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+
+    // Format outside the mutex
+    size_t length = RenderLogRecord(t_stagingBuffer,
+                                    sizeof(t_stagingBuffer),
+                                    callSite,
+                                    isSavingToFile,
+                                    args,
+                                    format,
+                                    encoding,
+                                    &requiredSize);
+
+    // Format the long logs in a buffer of required size
+    if (requiredSize > sizeof(t_stagingBuffer))
+    {
+        char *record = (char *)malloc(requiredSize);
+        if (record)
+        {
+            // Truncated log is not counted
+            t_recordLength -= length;
+            length = RenderLogRecord(record, requiredSize, callSite, isSavingToFile,
+                                     argsCopy, format, encoding, NULL);
+            WriteLogData(stream, record, length);
+            free(record);
+            va_end(argsCopy);
+            return;
+        }
+    }
+    va_end(argsCopy);
+
+    WriteLogData(stream, t_stagingBuffer, length);
+}
+
 static inline void LogLine(FILE *stream,
-                           const char *logLevelName,
+                           enum LogLevel level,
                            const char *logTag,
                            unsigned int lineNum,
-                           const char *colorCode,
                            unsigned char isSavingToFile,
                            const char *format,
                            ...)
 {
+    UniLoggerCallSite callSite = {level, logTag, lineNum, NULL, 0, format, NULL, 0, NULL};
     va_list args;
     va_start(args, format);
     LogLineArgs(stream,
-                logLevelName,
-                logTag,
-                lineNum,
-                colorCode,
+                &callSite,
                 isSavingToFile,
                 args,
-                format);
+                format,
+                ENCODING_TEXT);
     va_end(args);
 }
 
+/**
+ * @brief Parses the character of the log level ('0' to '6', 'P')
+ *
+ * @param logLevel character of the log level
+ * @param level parsed log level
+ * @return int 0 on success, -1 on invalid character
+ */
+static int ParseLogLevel(unsigned char logLevel, enum LogLevel *level)
+{
+    if (logLevel == 'P')
+    {
+        *level = LOG_LEVEL_PROFILE;
+        return 0;
+    }
+    if (logLevel < 48 || logLevel > (48 + (LOG_MAX_LEVEL - 2)))
+    {
+        return -1;
+    }
+    *level = (enum LogLevel)(logLevel - 48);
+    return 0;
+}
+
+/**
+ * @brief Sets the levels of the tags from the Environment variable
+ *
+ * @param tagLevels comma separated levels of the tags ("net=6,db=2")
+ */
+static void SetTagLevelsFromEnv(const char *tagLevels)
+{
+    while (*tagLevels)
+    {
+        const char *end = strchr(tagLevels, ',');
+        size_t length = end ? (size_t)(end - tagLevels) : strlen(tagLevels);
+        const char *separator = memchr(tagLevels, '=', length);
+
+        char logTag[128];
+        enum LogLevel level;
+        size_t tagLength = separator ? (size_t)(separator - tagLevels) : 0;
+        if (NULL == separator || 0 == tagLength || tagLength >= sizeof(logTag) ||
+            (size_t)(separator - tagLevels) + 2 != length || 0 != ParseLogLevel(separator[1], &level))
+        {
+            ERROR_LOG("Invalid Tag Level (%.*s) passed, expected <tag>=<level>", (int)length, tagLevels);
+        }
+        else
+        {
+            memcpy(logTag, tagLevels, tagLength);
+            logTag[tagLength] = '\0';
+            if (0 != TagLevel_Set(logTag, LevelMask(level), 1))
+            {
+                ERROR_LOG("Failed to set the Log Level of the tag %s", logTag);
+            }
+            else
+            {
+                INFO_LOG("Setting Log Level of the tag %s to %c", logTag, separator[1]);
+            }
+        }
+
+        if (NULL == end)
+        {
+            break;
+        }
+        tagLevels = end + 1;
+    }
+}
+
 void UniLogger_SetLogLevel(enum LogLevel level)
 {
     // initalize the stream
@@ -313,7 +783,7 @@ void UniLogger_SetLogLevel(enum LogLevel level)
     if (envVarData == NULL)
     {
         INFO_LOG("Environment variable \"%s\" is not available.", envName);
-        gCurrLogLevel = level;
+        SetCurrLogLevel(level);
         if (gCurrLogLevel == LOG_LEVEL_PROFILE)
         {
             INFO_LOG("Setting Log Level to Profile");
@@ -327,14 +797,27 @@ void UniLogger_SetLogLevel(enum LogLevel level)
     {
         INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
 
-        // Check the Size of the Environment variable (it should be 1)
-        size_t envVarSize = strlen(envVarData);
-        if (envVarSize != 1)
+        // Levels of the tags follow the level, "4,net=6,db=2"
+        const char *tagLevels = strchr(envVarData, ',');
+        if (tagLevels)
+        {
+            SetTagLevelsFromEnv(tagLevels + 1);
+        }
+
+        // Check the Size of the level (it should be 1)
+        size_t envVarSize = tagLevels ? (size_t)(tagLevels - envVarData) : strlen(envVarData);
+        if (0 == envVarSize && tagLevels)
+        {
+            // Only the levels of the tags are set
+            SetCurrLogLevel(level);
+            INFO_LOG("Setting Log Level to %d", (unsigned char)(gCurrLogLevel));
+        }
+        else if (envVarSize != 1)
         {
             ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
             // Avaialble Logs
             PrintAvaialbleLogs(envName);
-            gCurrLogLevel = LOG_LEVEL_OFF;
+            SetCurrLogLevel(LOG_LEVEL_OFF);
             INFO_LOG("Setting Log Level to %d", (unsigned char)(gCurrLogLevel));
             return;
         }
@@ -348,19 +831,19 @@ void UniLogger_SetLogLevel(enum LogLevel level)
             {
                 ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
                 PrintAvaialbleLogs(envName);
-                gCurrLogLevel = LOG_LEVEL_OFF;
+                SetCurrLogLevel(LOG_LEVEL_OFF);
                 INFO_LOG("Setting Log Level to %d", (unsigned char)(gCurrLogLevel));
                 return;
             }
 
             if (logLevel == 'P')
             {
-                gCurrLogLevel = LOG_LEVEL_PROFILE;
+                SetCurrLogLevel(LOG_LEVEL_PROFILE);
                 INFO_LOG("Setting Log Level to Profile");
             }
             else
             {
-                gCurrLogLevel = (enum LogLevel)(logLevel - 48);
+                SetCurrLogLevel((enum LogLevel)(logLevel - 48));
                 INFO_LOG("Setting Log Level to %d", (unsigned char)(gCurrLogLevel));
             }
         }
@@ -372,10 +855,37 @@ void UniLogger_SetLogLevel(enum LogLevel level)
     return;
 }
 
+void UniLogger_SetTagLevel(const char *logTag, enum LogLevel level)
+{
+    if (NULL == logTag || (unsigned int)level >= LOG_MAX_LEVEL)
+    {
+        ERROR_LOG("Invalid Tag Level passed");
+        return;
+    }
+
+    int status = TagLevel_Set(logTag, LevelMask(level), 0);
+    if (status > 0)
+    {
+        INFO_LOG("Log Level of the tag %s is set by the Environment variable \"LOG_LEVEL\"", logTag);
+    }
+    else if (status < 0)
+    {
+        ERROR_LOG("Failed to set the Log Level of the tag %s", logTag);
+    }
+    else
+    {
+        INFO_LOG("Setting Log Level of the tag %s to %d", logTag, (unsigned char)(level));
+    }
+    return;
+}
+
 void UniLogger_SetLogStream(enum LogStream stream)
 {
-    // default value of strea,
-    gCurrLogStream = stdout;
+    // default value of strea, (logs stay in the log file or socket if opened)
+    if (!gIsLogFileInitalized && !gIsLogSocketInitalized)
+    {
+        gCurrLogStream = stdout;
+    }
 
     // initalize the mutex
     if (!gIsMutexInitalized)
@@ -394,6 +904,8 @@ void UniLogger_SetLogStream(enum LogStream stream)
     const char *envName = "LOG_STREAM";
     const char *envVarData = getenv(envName);
 
+    // Socket is opened with the address of LOG_SOCKET
+    unsigned char isSocket = 0;
     if (envVarData == NULL)
     {
         char *streamName = "stdout";
@@ -408,6 +920,11 @@ void UniLogger_SetLogStream(enum LogStream stream)
             gCurrLogStream = stderr;
             streamName = "stderr";
         }
+        else if (STREAM_SOCKET == stream)
+        {
+            isSocket = 1;
+            streamName = "socket";
+        }
         else
         {
             // unknown log stream
@@ -427,7 +944,7 @@ void UniLogger_SetLogStream(enum LogStream stream)
         {
             ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
             // Avaialble Logs Stream
-            INFO_LOG("Available values for Log Stream are: 0 and 1");
+            INFO_LOG("Available values for Log Stream are: 0 1 2");
             gCurrLogStream = stdout;
             INFO_LOG("Setting Log Stream to stdout");
             return;
@@ -450,11 +967,16 @@ void UniLogger_SetLogStream(enum LogStream stream)
                 gCurrLogStream = stderr;
                 streamName = "stderr";
             }
+            else if (50 == logStream)
+            {
+                isSocket = 1;
+                streamName = "socket";
+            }
             else
             {
                 ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
                 // Avaialble Logs Stream
-                INFO_LOG("Available values for Log Stream are: 0 and 1");
+                INFO_LOG("Available values for Log Stream are: 0 1 2");
                 gCurrLogStream = stdout;
                 streamName = "stdout";
             }
@@ -465,6 +987,11 @@ void UniLogger_SetLogStream(enum LogStream stream)
     // Set the Flag for Initalize
     gIsLogStreamInitalized = 1;
 
+    if (isSocket)
+    {
+        UniLogger_SetLogSocket(NULL, 0);
+    }
+
     return;
 }
 
@@ -487,6 +1014,13 @@ void UniLogger_SetLogFile(const char *filepath)
             return;
         }
 
+        // Logs of the socket are not written to a file
+        if (gIsLogSocketInitalized)
+        {
+            ERROR_LOG("Log File is not supported with the socket Log Stream");
+            return;
+        }
+
         // Read the Environment variable
         const char *envName = "LOG_FILE";
         const char *envVarData = getenv(envName);
@@ -501,13 +1035,13 @@ void UniLogger_SetLogFile(const char *filepath)
             {
                 // Defaulting to logger.log
                 WARN_LOG("Found NULL in filepath, Defaulting to logger.log");
-                gIsLogFileInitalized = InitalizeLogFile(gCurrLogStream, "logger.log");
+                gIsLogFileInitalized = InitalizeLogFile("logger.log");
             }
             else
             {
                 // Save to the respective file
                 INFO_LOG("Saving Logs to file (%s)", filepath);
-                gIsLogFileInitalized = InitalizeLogFile(gCurrLogStream, filepath);
+                gIsLogFileInitalized = InitalizeLogFile(filepath);
             }
             return;
         }
@@ -516,7 +1050,7 @@ void UniLogger_SetLogFile(const char *filepath)
             // Save to the Environment variable file
             INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
             INFO_LOG("Saving Logs to file (%s)", envVarData);
-            gIsLogFileInitalized = InitalizeLogFile(gCurrLogStream, envVarData);
+            gIsLogFileInitalized = InitalizeLogFile(envVarData);
             return;
         }
     }
@@ -530,61 +1064,1412 @@ void UniLogger_SetLogFile(const char *filepath)
     return;
 }
 
-void UniLogger_CustomLogFn(enum LogLevel level, const char *logTag, unsigned int lineNum, const char *format, ...)
+/**
+ * @brief Formats the log once and writes it to the sinks
+ * Text logs are also written to the current stream (with color codes for
+ * the console), binary logs are written to the stream by the caller
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ * @param isWritingStream flag to write the log to the current stream
+ */
+static void LogSinksArgs(const UniLoggerCallSite *callSite,
+                         va_list args,
+                         const char *format,
+                         unsigned char isWritingStream)
 {
-    if (!gCurrLogStream)
-    {
-        gCurrLogStream = stdout;
-    }
+    size_t requiredSize;
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+
+    // Formatted without color codes, sinks add them
+    char *buffer = t_stagingBuffer;
+    size_t length = RenderLogRecord(buffer, sizeof(t_stagingBuffer), callSite, 1,
+                                    args, format, ENCODING_TEXT, &requiredSize);
 
-    if (LOG_LEVEL_PROFILE == gCurrLogLevel)
+    // Format the long logs in a buffer of required size
+    if (requiredSize > sizeof(t_stagingBuffer))
     {
-        if (LOG_LEVEL_PROFILE == level)
+        char *record = (char *)malloc(requiredSize);
+        if (record)
         {
-            // print profile logs and return
-            va_list args;
-            va_start(args, format);
-            LogLineArgs(gCurrLogStream,
-                        logLevelNames[(unsigned char)level],
-                        logTag,
-                        lineNum,
-                        colorCodes[(unsigned char)(level)],
-                        gIsLogFileInitalized,
-                        args,
-                        format);
-            va_end(args);
-            return;
+            buffer = record;
+            t_recordLength -= length;
+            length = RenderLogRecord(buffer, requiredSize, callSite, 1,
+                                     argsCopy, format, ENCODING_TEXT, NULL);
         }
     }
-    else
+    va_end(argsCopy);
+
+    LogRecord record = {buffer, length, callSite->level};
+    if (isWritingStream)
     {
-        // Check if the log level is greater than Enabled Log Level
-        // If greater, return. as it is not required to print
-        if (level > gCurrLogLevel)
+        if (IsLogStreamPlain())
         {
-            return;
+            WriteLogData(gCurrLogStream, record.data, record.length);
+        }
+        else
+        {
+            struct iovec vectors[3];
+            int count = LogRecord_ColoredVectors(&record, vectors);
+            WriteLogVectors(gCurrLogStream, vectors, count);
         }
+    }
+    Sinks_Write(&record);
 
-        va_list args;
-        va_start(args, format);
-        LogLineArgs(gCurrLogStream,
-                    logLevelNames[(unsigned char)level],
-                    logTag,
-                    lineNum,
-                    colorCodes[(unsigned char)(level)],
-                    gIsLogFileInitalized,
-                    args,
-                    format);
-        va_end(args);
-        return;
+    if (buffer != t_stagingBuffer)
+    {
+        free(buffer);
+    }
+}
+
+/**
+ * @brief Writes the log of the call site to the current mode
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+static inline void WriteCallSiteArgs(const UniLoggerCallSite *callSite, va_list args, const char *format)
+{
+    unsigned char isSinkActive = Sinks_IsActive();
+    unsigned char isQueued = SharedRing_IsRunning() || AsyncWriter_IsRunning() || MergeWriter_IsRunning();
+    if (isSinkActive && (isQueued || ENCODING_TEXT != gCurrLogEncoding))
+    {
+        // Stream gets binary or structured records, sinks get the text log from here
+        if (ENCODING_TEXT != gCurrLogEncoding)
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            LogSinksArgs(callSite, argsCopy, format, 0);
+            va_end(argsCopy);
+        }
+        isSinkActive = 0;
+    }
+
+    if (SharedRing_IsRunning())
+    {
+        // Formatted into the shared ring, written by the collector
+        SharedRing_Push(callSite, args, format);
+    }
+    else if (AsyncWriter_IsRunning())
+    {
+        // Queue the log for the writer thread
+        AsyncWriter_Push(callSite, args, format);
+    }
+    else if (MergeWriter_IsRunning())
+    {
+        // Queue the log in the thread buffer for the merger thread
+        MergeWriter_Push(callSite, args, format);
+    }
+    else
+    {
+        // Indexed with the bytes of the write of this thread
+        if (Index_IsRunning())
+        {
+            Index_AddRecord(callSite->level, NULL);
+        }
+
+        if (isSinkActive)
+        {
+            // Formatted once for the stream and the sinks
+            LogSinksArgs(callSite, args, format, 1);
+        }
+        else
+        {
+            LogLineArgs(gCurrLogStream,
+                        callSite,
+                        IsLogStreamPlain(),
+                        args,
+                        format,
+                        gCurrLogEncoding);
+        }
+    }
+}
+
+/**
+ * @brief Writes the log of the call site and keeps it in the flight recorder
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+static inline void LogCallSiteArgs(const UniLoggerCallSite *callSite, va_list args, const char *format)
+{
+    if (!gCurrLogStream)
+    {
+        gCurrLogStream = stdout;
+    }
+
+    // Call sites without resolved tag follow the global level
+    const unsigned int *levelMask = __atomic_load_n(&callSite->levelMask, __ATOMIC_ACQUIRE);
+    if (NULL == levelMask || &gUnresolvedLevelMask == levelMask)
+    {
+        levelMask = &gCurrLogLevelMask;
+    }
+    unsigned int level = (unsigned int)callSite->level;
+
+    // Kept in the ring of the flight recorder, written only when dumped
+    if (((__atomic_load_n(&gRecorderLevelMask, __ATOMIC_RELAXED) >> level) & 1u) && FlightRecorder_IsRunning())
+    {
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        FlightRecorder_Push(callSite, argsCopy, format);
+        va_end(argsCopy);
+    }
+
+    // Levels enabled only for the flight recorder are not written
+    if ((__atomic_load_n(levelMask, __ATOMIC_RELAXED) >> (level + UL_STREAM_MASK_SHIFT)) & 1u)
+    {
+        // Fatal logs, summaries and structured logs (fields are not in the message) are never collapsed
+        if (Duplicate_IsRunning() && LOG_LEVEL_FATAL != callSite->level &&
+            s_repeatedFormat != format && s_fieldsFormat != format)
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            unsigned char isRepeated = Duplicate_IsRepeated(callSite, argsCopy, format);
+            va_end(argsCopy);
+            if (isRepeated)
+            {
+                Stats_AddRecord(STATS_COLLAPSED, callSite->level);
+                return;
+            }
+        }
+
+        Stats_AddRecord(STATS_EMITTED, callSite->level);
+        if (CallSiteStats_IsRunning())
+        {
+            // Cost of formatting and writing, by the caller or in the queue
+            t_recordLength = 0;
+            unsigned long long start = Stats_Now();
+            WriteCallSiteArgs(callSite, args, format);
+            CallSiteStats_Add(callSite, t_recordLength, Stats_Now() - start);
+        }
+        else
+        {
+            WriteCallSiteArgs(callSite, args, format);
+        }
+    }
+    else
+    {
+        Stats_AddRecord(STATS_FILTERED, callSite->level);
+    }
+
+    // Context of the fatal log
+    if (LOG_LEVEL_FATAL == callSite->level && FlightRecorder_IsRunning())
+    {
+        UniLogger_DumpFlightRecorder();
+    }
+}
+
+void UniLogger_CustomLogFn(enum LogLevel level, const char *logTag, unsigned int lineNum, const char *format, ...)
+{
+    // Call site without pre-rendered prefix, level of its tag is looked up at every log
+    UniLoggerCallSite callSite = {level, logTag, lineNum, NULL, 0, format, NULL, 0, NULL, TagLevel_Lookup(logTag)};
+
+    // Check if the log level is enabled for the tag
+    // If not, return. as it is not required to print
+    if (!UniLogger_IsCallSiteEnabled(&callSite))
+    {
+        Stats_AddRecord(STATS_FILTERED, level);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    LogCallSiteArgs(&callSite, args, format);
+    va_end(args);
+    return;
+}
+
+/**
+ * @brief Formats the log of the batch
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the log
+ * @param requiredSize size required for the complete log
+ * @param format format of the print
+ * @param ... arguments of the print
+ * @return size_t number of bytes written
+ */
+static size_t RenderBatchRecord(char *buffer,
+                                size_t bufferSize,
+                                const UniLoggerCallSite *callSite,
+                                size_t *requiredSize,
+                                const char *format,
+                                ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t length = RenderLogRecord(buffer, bufferSize, callSite, IsLogStreamPlain(),
+                                    args, format, gCurrLogEncoding, requiredSize);
+    va_end(args);
+    return length;
+}
+
+/**
+ * @brief Logs with the descriptor of the call site
+ *
+ * @param callSite descriptor of the call site
+ * @param format format of the print
+ * @param ... arguments of the print
+ */
+static void LogCallSite(const UniLoggerCallSite *callSite, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    LogCallSiteArgs(callSite, args, format);
+    va_end(args);
+}
+
+void UniLogger_LogSuppressed(UniLoggerCallSite *callSite, unsigned long long suppressed)
+{
+    LogCallSite(callSite, "Suppressed %llu messages", suppressed);
+}
+
+void LogRepeated(const UniLoggerCallSite *callSite, unsigned long long repeated, unsigned long long spanNs)
+{
+    LogCallSite(callSite, s_repeatedFormat, repeated, spanNs / 1000000ULL);
+}
+
+void UniLogger_LogBatch(const UniLoggerRecord *records, unsigned int count)
+{
+    if (!gCurrLogStream)
+    {
+        gCurrLogStream = stdout;
+    }
+
+    unsigned int i;
+    if (SharedRing_IsRunning() || AsyncWriter_IsRunning() || MergeWriter_IsRunning() || Sinks_IsActive() ||
+        FlightRecorder_IsRunning())
+    {
+        // Queued one by one for the background writer, or written to the sinks and the flight recorder
+        for (i = 0; i < count; i++)
+        {
+            UniLoggerCallSite callSite = {records[i].level, records[i].logTag, records[i].lineNum,
+                                          NULL, 0, "%s", NULL, 0, NULL, TagLevel_Lookup(records[i].logTag)};
+            if (UniLogger_IsCallSiteEnabled(&callSite))
+            {
+                LogCallSite(&callSite, "%s", records[i].message);
+            }
+            else
+            {
+                Stats_AddRecord(STATS_FILTERED, records[i].level);
+            }
+        }
+        return;
+    }
+
+    // Format all the logs, written with a single write
+    char *batch = t_stagingBuffer;
+    size_t capacity = sizeof(t_stagingBuffer);
+    size_t length = 0;
+    for (i = 0; i < count; i++)
+    {
+        UniLoggerCallSite callSite = {records[i].level, records[i].logTag, records[i].lineNum,
+                                      NULL, 0, "%s", NULL, 0, NULL, TagLevel_Lookup(records[i].logTag)};
+        if (!UniLogger_IsCallSiteEnabled(&callSite))
+        {
+            Stats_AddRecord(STATS_FILTERED, records[i].level);
+            continue;
+        }
+        Stats_AddRecord(STATS_EMITTED, records[i].level);
+        if (Index_IsRunning())
+        {
+            // Indexed with the bytes of the batch
+            Index_AddRecord(records[i].level, NULL);
+        }
+
+        for (;;)
+        {
+            size_t requiredSize;
+            size_t written = RenderBatchRecord(batch + length, capacity - length, &callSite,
+                                               &requiredSize, "%s", records[i].message);
+            if (requiredSize <= capacity - length && length + UL_MAX_RECORD_SIZE <= capacity)
+            {
+                length += written;
+                break;
+            }
+
+            // Grow the batch and format the log again
+            size_t newCapacity = capacity * 2;
+            while (newCapacity < length + requiredSize || newCapacity < length + UL_MAX_RECORD_SIZE)
+            {
+                newCapacity *= 2;
+            }
+            char *newBatch = (char *)malloc(newCapacity);
+            if (NULL == newBatch)
+            {
+                // Write the formatted logs and continue in the existing batch
+                WriteLogData(gCurrLogStream, batch, length);
+                length = 0;
+                if (requiredSize > capacity)
+                {
+                    break;
+                }
+                continue;
+            }
+            memcpy(newBatch, batch, length);
+            if (batch != t_stagingBuffer)
+            {
+                free(batch);
+            }
+            batch = newBatch;
+            capacity = newCapacity;
+        }
+    }
+
+    if (length)
+    {
+        WriteLogData(gCurrLogStream, batch, length);
+    }
+    if (batch != t_stagingBuffer)
+    {
+        free(batch);
+    }
+}
+
+void UniLogger_LogCallSite(UniLoggerCallSite *callSite, const char *format, ...)
+{
+    // Resolve the level of the tag at the first log
+    if (&gUnresolvedLevelMask == __atomic_load_n(&callSite->levelMask, __ATOMIC_ACQUIRE))
+    {
+        TagLevel_Resolve(callSite);
+    }
+
+    // Check if the log level is enabled for the tag
+    if (!UniLogger_IsCallSiteEnabled(callSite))
+    {
+        Stats_AddRecord(STATS_FILTERED, callSite->level);
+        return;
+    }
+
+    // Register at the first log of the call site
+    if (0 == __atomic_load_n(&callSite->id, __ATOMIC_ACQUIRE))
+    {
+        CallSite_Register(callSite, format);
+    }
+
+    va_list args;
+    va_start(args, format);
+    LogCallSiteArgs(callSite, args, format);
+    va_end(args);
+    return;
+}
+
+void UniLogger_LogFields(UniLoggerCallSite *callSite,
+                         const char *message,
+                         const UniLoggerField *fields,
+                         unsigned int count)
+{
+    // Resolve the level of the tag at the first log
+    if (&gUnresolvedLevelMask == __atomic_load_n(&callSite->levelMask, __ATOMIC_ACQUIRE))
+    {
+        TagLevel_Resolve(callSite);
+    }
+
+    // Check if the log level is enabled for the tag
+    if (!UniLogger_IsCallSiteEnabled(callSite))
+    {
+        Stats_AddRecord(STATS_FILTERED, callSite->level);
+        return;
+    }
+
+    // Register at the first log of the call site, message is the format of the call site
+    if (0 == __atomic_load_n(&callSite->id, __ATOMIC_ACQUIRE))
+    {
+        CallSite_Register(callSite, message);
+    }
+
+    // Fields are encoded by the encoding of every output
+    LogCallSite(callSite, s_fieldsFormat, message, fields, count);
+}
+
+/**
+ * @brief Reads the number from the Environment variable
+ * Size suffixes K, M and G are accepted
+ *
+ * @param envName name of the Environment variable
+ * @param value value used if the Environment variable is not available
+ * @return unsigned long long value of the Environment variable or value
+ */
+static unsigned long long ReadEnvNumber(const char *envName, unsigned long long value)
+{
+    const char *envVarData = getenv(envName);
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+        return value;
+    }
+
+    INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+    char *end = NULL;
+    unsigned long long number = strtoull(envVarData, &end, 10);
+    switch (*end)
+    {
+    case 'K':
+        number <<= 10;
+        end++;
+        break;
+    case 'M':
+        number <<= 20;
+        end++;
+        break;
+    case 'G':
+        number <<= 30;
+        end++;
+        break;
+    default:
+        break;
+    }
+
+    if (end == envVarData || *end != '\0' || '-' == envVarData[0])
+    {
+        ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+        return value;
+    }
+    return number;
+}
+
+void UniLogger_SetLogFileRotation(unsigned long long maxSize,
+                                  unsigned int rotateInterval,
+                                  unsigned int keepFiles)
+{
+    // Return if already Intialized
+    if (gIsLogRotationInitalized)
+        return;
+
+    // Rotation needs the opened log file
+    if (!gIsLogFileInitalized)
+    {
+        ERROR_LOG("Please call the function UniLogger_SetLogFileRotation() after UniLogger_SetLogFile()");
+        return;
+    }
+
+    // Read the Environment variables
+    maxSize = ReadEnvNumber("LOG_FILE_MAX_SIZE", maxSize);
+    rotateInterval = (unsigned int)ReadEnvNumber("LOG_FILE_ROTATE_INTERVAL", rotateInterval);
+    keepFiles = (unsigned int)ReadEnvNumber("LOG_FILE_KEEP", keepFiles);
+
+    if (0 == maxSize && 0 == rotateInterval)
+    {
+        INFO_LOG("Log File Rotation is disabled");
+    }
+    else if (!gIsLogFileAppending || MmapSink_IsRunning() || Index_IsRunning() || CompressSink_IsRunning())
+    {
+        ERROR_LOG("Log File Rotation is not supported for the file (%s)", gCurrLogFilePath);
+    }
+    else if (0 != Rotation_Start(gCurrLogStream, gCurrLogFilePath, maxSize, rotateInterval, keepFiles))
+    {
+        ERROR_LOG("Failed to start the rotation of the file (%s)", gCurrLogFilePath);
+    }
+    else
+    {
+        INFO_LOG("Rotating Log File at %llu bytes, every %u seconds, keeping %u files",
+                 maxSize, rotateInterval, keepFiles);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogRotationInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetLogFileSink(enum LogFileSink sink)
+{
+    // Return if already Intialized
+    if (gIsLogFileSinkInitalized)
+        return;
+
+    // Sink is used only for the log file
+    if (!gIsLogFileInitalized)
+    {
+        ERROR_LOG("Please call the function UniLogger_SetLogFileSink() after UniLogger_SetLogFile()");
+        return;
+    }
+
+    // Read the Environment variable
+    const char *envName = "LOG_FILE_SINK";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_FILE_SINK ('0' to '1')
+        if (strlen(envVarData) != 1 || envVarData[0] < 48 || envVarData[0] > 48 + FILE_SINK_MMAP)
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            INFO_LOG("Available values for Log File Sink are: 0 1");
+            sink = FILE_SINK_WRITE;
+        }
+        else
+        {
+            sink = (enum LogFileSink)(envVarData[0] - 48);
+        }
+    }
+
+    if (FILE_SINK_MMAP == sink)
+    {
+        // Rotation replaces the descriptor of the file, mapping can not follow it
+        if (Rotation_IsRunning())
+        {
+            ERROR_LOG("Memory mapped Log File can not be rotated, Defaulting to write");
+            sink = FILE_SINK_WRITE;
+        }
+        else if (CompressSink_IsRunning())
+        {
+            // Frames are written by the compressor thread
+            ERROR_LOG("Compressed Log File can not be memory mapped, Defaulting to write");
+            sink = FILE_SINK_WRITE;
+        }
+        else if (0 != MmapSink_Start(gCurrLogStream, gCurrLogFilePath))
+        {
+            ERROR_LOG("Failed to map the Log File (%s), Defaulting to write", gCurrLogFilePath);
+            sink = FILE_SINK_WRITE;
+        }
+    }
+    INFO_LOG("Setting Log File Sink to %d", (unsigned char)(sink));
+
+    // Set the Flag for Initalize
+    gIsLogFileSinkInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetLogFileCompression(enum LogFileCompression compression,
+                                     unsigned int blockSize,
+                                     unsigned int flushInterval)
+{
+    // Return if already Intialized
+    if (gIsLogCompressionInitalized)
+        return;
+
+    // Compression is used only for the log file
+    if (!gIsLogFileInitalized)
+    {
+        ERROR_LOG("Please call the function UniLogger_SetLogFileCompression() after UniLogger_SetLogFile()");
+        return;
+    }
+
+    // Read the Environment variable
+    const char *envName = "LOG_FILE_COMPRESSION";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_FILE_COMPRESSION ('0' to '3')
+        if (strlen(envVarData) != 1 || envVarData[0] < 48 || envVarData[0] > 48 + COMPRESSION_ZSTD)
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            INFO_LOG("Available values for Log File Compression are: 0 1 2 3");
+            compression = COMPRESSION_NONE;
+        }
+        else
+        {
+            compression = (enum LogFileCompression)(envVarData[0] - 48);
+        }
+    }
+    blockSize = (unsigned int)ReadEnvNumber("LOG_FILE_COMPRESSION_BLOCK", blockSize);
+    flushInterval = (unsigned int)ReadEnvNumber("LOG_FILE_COMPRESSION_FLUSH", flushInterval);
+    if (0 == blockSize)
+    {
+        blockSize = UL_COMPRESS_DEFAULT_BLOCK_SIZE;
+    }
+    else if (blockSize > UL_COMPRESS_MAX_BLOCK_SIZE)
+    {
+        blockSize = UL_COMPRESS_MAX_BLOCK_SIZE;
+    }
+    if (0 == flushInterval)
+    {
+        flushInterval = UL_COMPRESS_DEFAULT_FLUSH_MS;
+    }
+
+    if (COMPRESSION_NONE == compression)
+    {
+        INFO_LOG("Log File Compression is disabled");
+    }
+    else if (!CompressSink_IsAvailable(compression))
+    {
+        ERROR_LOG("Log File Compression %d is not built in (zlib, liblz4 or libzstd not found)",
+                  (unsigned char)(compression));
+    }
+    else if (Rotation_IsRunning() || MmapSink_IsRunning() || Index_IsRunning())
+    {
+        ERROR_LOG("Log File Compression is not supported with the rotation, the mapping or the index of the file (%s)",
+                  gCurrLogFilePath);
+    }
+    else if (0 != CompressSink_Start(gCurrLogStream, gCurrLogFilePath, compression, blockSize, flushInterval))
+    {
+        // Frames can not follow plain logs or frames of another format
+        ERROR_LOG("Failed to compress the Log File (%s), file must be empty or of the same format", gCurrLogFilePath);
+    }
+    else
+    {
+        INFO_LOG("Compressing Log File with %d in blocks of %u bytes, written every %u ms",
+                 (unsigned char)(compression), blockSize, flushInterval);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogCompressionInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetLogFileIndex(unsigned int blockRecords, unsigned long long blockBytes)
+{
+    // Return if already Intialized
+    if (gIsLogIndexInitalized)
+        return;
+
+    // Index needs the opened log file
+    if (!gIsLogFileInitalized)
+    {
+        ERROR_LOG("Please call the function UniLogger_SetLogFileIndex() after UniLogger_SetLogFile()");
+        return;
+    }
+
+    // Read the Environment variables
+    blockRecords = (unsigned int)ReadEnvNumber("LOG_FILE_INDEX_RECORDS", blockRecords);
+    blockBytes = ReadEnvNumber("LOG_FILE_INDEX_BYTES", blockBytes);
+
+    if (0 == blockRecords && 0 == blockBytes)
+    {
+        INFO_LOG("Log File Index is disabled");
+    }
+    else if (Rotation_IsRunning())
+    {
+        // Offsets of the index would point into the rotated segments
+        ERROR_LOG("Log File Index is not supported with the rotation of the file (%s)", gCurrLogFilePath);
+    }
+    else if (CompressSink_IsRunning())
+    {
+        // Offsets of the index would point into the compressed frames
+        ERROR_LOG("Log File Index is not supported with the compression of the file (%s)", gCurrLogFilePath);
+    }
+    else
+    {
+        // Offset of the next record, buffered records are written first
+        fflush(gCurrLogStream);
+        off_t fileOffset = MmapSink_IsRunning() ? (off_t)MmapSink_GetOffset()
+                                                : lseek(fileno(gCurrLogStream), 0, SEEK_END);
+        if (fileOffset < 0 ||
+            0 != Index_Start(gCurrLogFilePath, (unsigned long long)fileOffset, blockRecords, blockBytes))
+        {
+            ERROR_LOG("Failed to start the index of the file (%s)", gCurrLogFilePath);
+        }
+        else
+        {
+            INFO_LOG("Indexing Log File every %u records or %llu bytes", blockRecords, blockBytes);
+        }
+    }
+
+    // Set the Flag for Initalize
+    gIsLogIndexInitalized = 1;
+
+    return;
+}
+
+int UniLogger_AddConsoleSink(enum LogStream stream, enum LogLevel level)
+{
+    // stdout and stderr are not replaced by the log file
+    FILE *consoleStream = (STREAM_STDERR == stream) ? stderr : stdout;
+    if (0 != Sinks_AddFd(fileno(consoleStream), consoleStream, 0, 1, LevelMask(level)))
+    {
+        ERROR_LOG("Failed to add the console sink, maximum %d sinks", UL_MAX_SINKS);
+        return -1;
+    }
+
+    INFO_LOG("Adding console sink (%s) with Log Level %d",
+             (STREAM_STDERR == stream) ? "stderr" : "stdout", (unsigned char)(level));
+    return 0;
+}
+
+int UniLogger_AddFileSink(const char *filepath, enum LogLevel level)
+{
+    if (NULL == filepath)
+    {
+        ERROR_LOG("Found NULL in filepath of the file sink");
+        return -1;
+    }
+
+    // Appends with O_APPEND are atomic, logs are written without the mutex
+    int fd = open(filepath, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        ERROR_LOG("Failed to open file %s for writing", filepath);
+        return -1;
+    }
+
+    if (0 != Sinks_AddFd(fd, NULL, 1, 0, LevelMask(level)))
+    {
+        ERROR_LOG("Failed to add the file sink, maximum %d sinks", UL_MAX_SINKS);
+        close(fd);
+        return -1;
+    }
+
+    INFO_LOG("Adding file sink (%s) with Log Level %d", filepath, (unsigned char)(level));
+    return 0;
+}
+
+int UniLogger_AddCustomSink(UniLoggerSinkFn sinkFn, void *context, enum LogLevel level)
+{
+    if (NULL == sinkFn)
+    {
+        ERROR_LOG("Found NULL in function of the custom sink");
+        return -1;
+    }
+
+    if (0 != Sinks_AddFn(sinkFn, context, LevelMask(level)))
+    {
+        ERROR_LOG("Failed to add the custom sink, maximum %d sinks", UL_MAX_SINKS);
+        return -1;
+    }
+
+    INFO_LOG("Adding custom sink with Log Level %d", (unsigned char)(level));
+    return 0;
+}
+
+void UniLogger_SetLogSocket(const char *address, unsigned int bufferSize)
+{
+    // initalize the mutex
+    if (!gIsMutexInitalized)
+    {
+        if (0 != InitalizeMutex())
+        {
+            ERROR_LOG("Failed to initalize mutex");
+        }
+    }
+
+    // Return if already Intialized
+    if (gIsLogSocketInitalized)
+        return;
+
+    // Logs of the log file are not sent
+    if (gIsLogFileInitalized)
+    {
+        ERROR_LOG("Socket Log Stream is not supported with the Log File");
+        return;
+    }
+
+    // Read the Environment variables
+    const char *envName = "LOG_SOCKET";
+    const char *envVarData = getenv(envName);
+    if (NULL == envVarData)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+        address = envVarData;
+    }
+    if (NULL == address)
+    {
+        address = UL_SOCKET_DEFAULT_ADDRESS;
+    }
+    bufferSize = (unsigned int)ReadEnvNumber("LOG_SOCKET_BUFFER", bufferSize);
+    if (0 == bufferSize)
+    {
+        bufferSize = UL_SOCKET_DEFAULT_BUFFER_SIZE;
+    }
+
+    // Output of the console is written before the logs move to the socket
+    if (gCurrLogStream)
+    {
+        fflush(gCurrLogStream);
+    }
+    if (0 != SocketSink_Start(address, bufferSize))
+    {
+        ERROR_LOG("Failed to start the socket Log Stream (%s)", address);
+        return;
+    }
+    gCurrLogStream = SocketSink_GetStream();
+
+    // Binary records are not split into datagrams
+    if (ENCODING_BINARY == gCurrLogEncoding && SocketSink_IsDatagram())
+    {
+        ERROR_LOG("Binary Log Encoding needs a stream socket (unix-stream: or tcp:), Setting Log Encoding to 0");
+        gCurrLogEncoding = ENCODING_TEXT;
+    }
+
+    INFO_LOG("Sending Logs to socket (%s) with buffer of %u bytes", address, bufferSize);
+
+    // Set the Flag for Initalize
+    gIsLogSocketInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetTimeFormat(enum LogTimeFormat format)
+{
+    // Return if already Intialized
+    if (gIsLogTimeInitalized)
+        return;
+
+    // Read the Environment variable
+    const char *envName = "LOG_TIME";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_TIME ('0' to '2')
+        if (strlen(envVarData) != 1 || envVarData[0] < 48 || envVarData[0] > 48 + TIME_FORMAT_EPOCH_NS)
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            INFO_LOG("Available values for Time Format are: 0 1 2");
+            format = TIME_FORMAT_LOCAL;
+        }
+        else
+        {
+            format = (enum LogTimeFormat)(envVarData[0] - 48);
+        }
+    }
+
+    Timestamp_SetFormat(format);
+    INFO_LOG("Setting Time Format to %d", (unsigned char)(format));
+
+    // Set the Flag for Initalize
+    gIsLogTimeInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetLogEncoding(enum LogEncoding encoding)
+{
+    if (!gCurrLogStream)
+    {
+        gCurrLogStream = stdout;
+    }
+
+    // Return if already Intialized
+    if (gIsLogEncodingInitalized)
+        return;
+
+    // Read the Environment variable
+    const char *envName = "LOG_ENCODING";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_ENCODING ('0' to '3')
+        if (strlen(envVarData) != 1 || envVarData[0] < 48 || envVarData[0] > 48 + ENCODING_LOGFMT)
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            INFO_LOG("Available values for Log Encoding are: 0 1 2 3");
+            encoding = ENCODING_TEXT;
+        }
+        else
+        {
+            encoding = (enum LogEncoding)(envVarData[0] - 48);
+        }
+    }
+
+    // Binary records are not split into datagrams
+    if (ENCODING_BINARY == encoding && SocketSink_IsRunning() && SocketSink_IsDatagram())
+    {
+        ERROR_LOG("Binary Log Encoding needs a stream socket (unix-stream: or tcp:)");
+        encoding = ENCODING_TEXT;
+    }
+
+    INFO_LOG("Setting Log Encoding to %d", (unsigned char)(encoding));
+
+    if (ENCODING_BINARY == encoding)
+    {
+        // Header to identify the binary logs
+        char header[32];
+        size_t length = EncodeBinaryHeader(header, sizeof(header));
+        WriteLogData(gCurrLogStream, header, length);
+    }
+    gCurrLogEncoding = encoding;
+
+    // Set the Flag for Initalize
+    gIsLogEncodingInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetAsyncMode(enum LogAsyncMode mode, unsigned int queueSize)
+{
+    if (!gCurrLogStream)
+    {
+        gCurrLogStream = stdout;
+    }
+
+    // initalize the mutex
+    if (!gIsMutexInitalized)
+    {
+        if (0 != InitalizeMutex())
+        {
+            ERROR_LOG("Failed to initalize mutex");
+        }
+    }
+
+    // Return if already Intialized
+    if (gIsLogAsyncInitalized)
+        return;
+
+    // Read the Environment variable
+    const char *envName = "LOG_ASYNC";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_ASYNC ('0' to '4')
+        if (strlen(envVarData) != 1 || envVarData[0] < 48 || envVarData[0] > 48 + ASYNC_PER_THREAD)
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            INFO_LOG("Available values for Async Mode are: 0 1 2 3 4");
+            mode = ASYNC_OFF;
+        }
+        else
+        {
+            mode = (enum LogAsyncMode)(envVarData[0] - 48);
+        }
+    }
+
+    if (0 == queueSize)
+    {
+        queueSize = (ASYNC_PER_THREAD == mode) ? UL_THREAD_BUFFER_DEFAULT_SIZE : UL_ASYNC_DEFAULT_QUEUE_SIZE;
+    }
+
+    if (ASYNC_OFF == mode)
+    {
+        INFO_LOG("Setting Async Mode to off");
+    }
+    else if (0 != ((ASYNC_PER_THREAD == mode) ? MergeWriter_Start(queueSize) : AsyncWriter_Start(mode, queueSize)))
+    {
+        ERROR_LOG("Failed to start the asynchronous writer, logging synchronously");
+    }
+    else
+    {
+        INFO_LOG("Setting Async Mode to %d with queue size %u", (unsigned char)(mode), queueSize);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogAsyncInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetSharedRing(const char *name, unsigned int ringSize)
+{
+    if (!gCurrLogStream)
+    {
+        gCurrLogStream = stdout;
+    }
+
+    // Return if already Intialized
+    if (gIsLogSharedRingInitalized)
+        return;
+
+    // Read the Environment variables
+    const char *envName = "LOG_SHARED_RING";
+    const char *envVarData = getenv(envName);
+
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+        name = envVarData;
+    }
+    ringSize = (unsigned int)ReadEnvNumber("LOG_SHARED_RING_SIZE", ringSize);
+
+    if (NULL == name || '\0' == name[0])
+    {
+        WARN_LOG("Found NULL in shared ring name, Defaulting to /unilogger");
+        name = "/unilogger";
+    }
+    if (0 == ringSize)
+    {
+        ringSize = UL_SHARED_DEFAULT_SIZE;
+    }
+
+    if (0 != SharedRing_Start(name, ringSize))
+    {
+        ERROR_LOG("Failed to open the shared ring (%s), logging to the Log Stream", name);
+    }
+    else
+    {
+        INFO_LOG("Writing Logs to the shared ring (%s)", name);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogSharedRingInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetFlightRecorder(enum LogLevel level, unsigned int size)
+{
+    // Return if already Intialized
+    if (gIsLogRecorderInitalized)
+        return;
+
+    // Read the Environment variables
+    const char *envName = "LOG_FLIGHT_RECORDER";
+    const char *envVarData = getenv(envName);
+    if (envVarData == NULL)
+    {
+        INFO_LOG("Environment variable \"%s\" is not available", envName);
+    }
+    else
+    {
+        INFO_LOG("Environment variable \"%s\" is set to %s", envName, envVarData);
+
+        // Check the Character in LOG_FLIGHT_RECORDER ('0' to '6', 'P')
+        if (strlen(envVarData) != 1 || 0 != ParseLogLevel((unsigned char)envVarData[0], &level))
+        {
+            ERROR_LOG("Invalid Environment variable Value (%s) passed", envVarData);
+            PrintAvaialbleLogs(envName);
+            level = LOG_LEVEL_OFF;
+        }
+    }
+    size = (unsigned int)ReadEnvNumber("LOG_FLIGHT_RECORDER_SIZE", size);
+    if (0 == size)
+    {
+        size = UL_FLIGHT_RECORDER_DEFAULT_SIZE;
+    }
+
+    if (LOG_LEVEL_OFF == level)
+    {
+        INFO_LOG("Flight Recorder is disabled");
+    }
+    else if (0 != FlightRecorder_Start(size))
+    {
+        ERROR_LOG("Failed to start the Flight Recorder");
+    }
+    else
+    {
+        // Levels of the recorder are enabled for every call site
+        __atomic_store_n(&gRecorderLevelMask, LevelMask(level), __ATOMIC_RELAXED);
+        SetCurrLogLevel(gCurrLogLevel);
+        TagLevel_Republish();
+        INFO_LOG("Keeping the last %u logs till Log Level %d in the Flight Recorder",
+                 size, (unsigned char)(level));
+    }
+
+    // Set the Flag for Initalize
+    gIsLogRecorderInitalized = 1;
+
+    return;
+}
+
+/**
+ * @brief Writes a record of the flight recorder to the current stream
+ *
+ * @param data formatted record
+ * @param length length of the record
+ */
+static void WriteRecorderData(const char *data, size_t length)
+{
+    WriteLogData(gCurrLogStream, data, length);
+}
+
+void UniLogger_DumpFlightRecorder()
+{
+    // Logs queued before the dump are written first
+    UniLogger_Flush();
+    FlightRecorder_Dump(WriteRecorderData);
+    if (gCurrLogStream)
+    {
+        fflush(gCurrLogStream);
+    }
+}
+
+void UniLogger_SetProfileDump(unsigned int interval)
+{
+    // Return if already Intialized
+    if (gIsLogProfileInitalized)
+        return;
+
+    // Read the Environment variable
+    interval = (unsigned int)ReadEnvNumber("LOG_PROFILE_DUMP", interval);
+
+    if (0 == interval)
+    {
+        INFO_LOG("Periodic Profile Dump is disabled");
+    }
+    else if (0 != Profile_StartDump(interval))
+    {
+        ERROR_LOG("Failed to start the Profile Dump thread");
+    }
+    else
+    {
+        INFO_LOG("Writing Profile Dump every %u seconds", interval);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogProfileInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetStatsReport(unsigned int interval)
+{
+    // Return if already Intialized
+    if (gIsLogStatsInitalized)
+        return;
+
+    // Read the Environment variable
+    interval = (unsigned int)ReadEnvNumber("LOG_STATS_REPORT", interval);
+
+    if (0 == interval)
+    {
+        INFO_LOG("Statistics Report is disabled");
+    }
+    else if (0 != Stats_StartReport(interval))
+    {
+        ERROR_LOG("Failed to start the Statistics Report thread");
+    }
+    else
+    {
+        INFO_LOG("Writing Statistics Report every %u seconds", interval);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogStatsInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetCallSiteStats(unsigned int topCount)
+{
+    // Return if already Intialized
+    if (gIsLogCallSiteStatsInitalized)
+        return;
+
+    // Read the Environment variable
+    topCount = (unsigned int)ReadEnvNumber("LOG_CALLSITE_STATS", topCount);
+
+    if (0 == topCount)
+    {
+        INFO_LOG("Call Site Statistics are disabled");
+    }
+    else if (0 != CallSiteStats_Start(topCount))
+    {
+        ERROR_LOG("Failed to start the Call Site Statistics");
+    }
+    else if (0 != CallSiteStats_StartSignalDump())
+    {
+        INFO_LOG("Counting cost of the Call Sites, SIGUSR2 is in use, dump only with UniLogger_DumpCallSiteStats()");
+    }
+    else
+    {
+        INFO_LOG("Counting cost of the Call Sites, top %u written on SIGUSR2", topCount);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogCallSiteStatsInitalized = 1;
+
+    return;
+}
+
+void UniLogger_SetDuplicateCollapse(unsigned int windowSize, unsigned int flushInterval)
+{
+    // Return if already Intialized
+    if (gIsLogDuplicateInitalized)
+        return;
+
+    // Read the Environment variables
+    windowSize = (unsigned int)ReadEnvNumber("LOG_DUPLICATE_WINDOW", windowSize);
+    flushInterval = (unsigned int)ReadEnvNumber("LOG_DUPLICATE_FLUSH", flushInterval);
+    if (windowSize > UL_DUPLICATE_MAX_WINDOW)
+    {
+        windowSize = UL_DUPLICATE_MAX_WINDOW;
+    }
+    if (0 == flushInterval)
+    {
+        flushInterval = UL_DUPLICATE_DEFAULT_FLUSH_MS;
+    }
+
+    if (0 == windowSize)
+    {
+        INFO_LOG("Collapsing of the repeated logs is disabled");
+    }
+    else if (0 != Duplicate_Start(windowSize, flushInterval))
+    {
+        ERROR_LOG("Failed to start the collapsing of the repeated logs");
+    }
+    else
+    {
+        INFO_LOG("Collapsing repeats of the last %u logs of every thread, written every %u ms",
+                 windowSize, flushInterval);
+    }
+
+    // Set the Flag for Initalize
+    gIsLogDuplicateInitalized = 1;
+
+    return;
+}
+
+void UniLogger_Flush()
+{
+    // Repeats and suppressed logs are written with the pending logs
+    Duplicate_Flush();
+    RateLimit_Flush();
+
+    if (SharedRing_IsRunning())
+    {
+        SharedRing_Flush();
+    }
+
+    if (AsyncWriter_IsRunning())
+    {
+        AsyncWriter_Flush();
+    }
+    else if (MergeWriter_IsRunning())
+    {
+        MergeWriter_Flush();
+    }
+
+    // Start writing back the mapped logs
+    MmapSink_Flush();
+
+    // Compress the open block
+    CompressSink_Flush();
+
+    if (SocketSink_IsRunning())
+    {
+        SocketSink_Flush();
+    }
+
+    if (gCurrLogStream)
+    {
+        fflush(gCurrLogStream);
     }
 }
 
 void UniLogger_CloseLogger()
 {
+    // stop the flight recorder before the levels are reset
+    if (gIsLogRecorderInitalized)
+    {
+        __atomic_store_n(&gRecorderLevelMask, 0, __ATOMIC_RELAXED);
+        SetCurrLogLevel(gCurrLogLevel);
+        TagLevel_Republish();
+        FlightRecorder_Stop();
+        gIsLogRecorderInitalized = 0;
+    }
+
+    // stop the profile dump before the writers
+    if (gIsLogProfileInitalized)
+    {
+        Profile_StopDump();
+        gIsLogProfileInitalized = 0;
+    }
+
+    // stop the statistics report before the writers
+    if (gIsLogStatsInitalized)
+    {
+        Stats_StopReport();
+        gIsLogStatsInitalized = 0;
+    }
+
+    // stop the call site statistics dump before the writers
+    if (gIsLogCallSiteStatsInitalized)
+    {
+        CallSiteStats_Stop();
+        gIsLogCallSiteStatsInitalized = 0;
+    }
+
+    // write the repeats and the suppressed logs before the writers are stopped
+    if (gIsLogDuplicateInitalized)
+    {
+        Duplicate_Stop();
+        gIsLogDuplicateInitalized = 0;
+    }
+    RateLimit_Flush();
+
+    // write the queued logs before closing the stream
+    if (gIsLogAsyncInitalized)
+    {
+        AsyncWriter_Stop();
+        MergeWriter_Stop();
+        gIsLogAsyncInitalized = 0;
+    }
+
+    // records in the ring are written by the collector
+    if (gIsLogSharedRingInitalized)
+    {
+        SharedRing_Stop();
+        gIsLogSharedRingInitalized = 0;
+    }
+
+    // send the buffered logs after the writers are stopped
+    if (gIsLogSocketInitalized)
+    {
+        SocketSink_Stop();
+        gCurrLogStream = stdout;
+        gIsLogSocketInitalized = 0;
+    }
+
+    // compress the open block before closing the file
+    if (gIsLogCompressionInitalized)
+    {
+        CompressSink_Stop();
+        gIsLogCompressionInitalized = 0;
+    }
+
+    // unmap the file before closing the file
+    if (gIsLogFileSinkInitalized)
+    {
+        MmapSink_Stop();
+        gIsLogFileSinkInitalized = 0;
+    }
+
+    // stop the rotation before closing the file
+    if (gIsLogRotationInitalized)
+    {
+        Rotation_Stop();
+        gIsLogRotationInitalized = 0;
+    }
+
+    // write the open block of the index before closing the file
+    if (gIsLogIndexInitalized)
+    {
+        Index_Stop();
+        gIsLogIndexInitalized = 0;
+    }
+
+    // destroy the mutex after the threads writing the file are stopped
     if (gIsMutexInitalized)
     {
-        // Destroy the mutex
+        gIsMutexInitalized = 0;
         pthread_mutex_destroy(&s_logMutex);
     }
 
@@ -592,13 +2477,20 @@ void UniLogger_CloseLogger()
     if (gIsLogFileInitalized)
     {
         fclose(gCurrLogStream);
+        gCurrLogStream = stdout;
+        gIsLogFileInitalized = 0;
+        gIsLogFileAppending = 0;
     }
 
+    // close the files of the sinks
+    Sinks_Close();
+
     if (gIsLogLevelInitalized)
     {
         // Reset the values
         gIsLogLevelInitalized = 0;
-        gCurrLogLevel = LOG_LEVEL_OFF;
+        SetCurrLogLevel(LOG_LEVEL_OFF);
+        TagLevel_Reset();
     }
 
     if (gIsLogStreamInitalized)
@@ -608,5 +2500,19 @@ void UniLogger_CloseLogger()
         gCurrLogStream = stdout;
     }
 
+    if (gIsLogEncodingInitalized)
+    {
+        // Reset the values
+        gIsLogEncodingInitalized = 0;
+        gCurrLogEncoding = ENCODING_TEXT;
+    }
+
+    if (gIsLogTimeInitalized)
+    {
+        // Reset the values
+        gIsLogTimeInitalized = 0;
+        Timestamp_SetFormat(TIME_FORMAT_LOCAL);
+    }
+
     return;
 }
\ No newline at end of file
@@ -0,0 +1,441 @@
+/**
+ * @file UniLoggerAsync.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Asynchronous background writer for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Callers format the record directly into a slot of a bounded lock-free
+ * multi-producer queue (sequence numbered ring) and return. A single writer
+ * thread drains the queue to gCurrLogStream. Records longer than a slot are
+ * formatted into an allocated buffer referenced by the slot.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Single record slot of the queue
+ */
+typedef struct AsyncSlot
+{
+    // Sequence number of the slot, (pos) -> free, (pos + 1) -> ready
+    atomic_size_t sequence;
+    // Length of the formatted record
+    size_t length;
+    // Log level of the record, LOG_LEVEL_OFF for binary and structured records
+    enum LogLevel level;
+    // Level and time of the log, for the index of the log file
+    enum LogLevel logLevel;
+    struct timespec time;
+    // Formatted record
+    char data[UL_MAX_RECORD_SIZE];
+    // Allocated record longer than data, NULL if the record is in data
+    char *overflow;
+} AsyncSlot;
+
+// Slots of the queue
+static AsyncSlot *s_slots = NULL;
+// Mask for the position in queue (capacity - 1)
+static size_t s_mask = 0;
+// Overflow policy of the queue
+static enum LogAsyncMode s_mode = ASYNC_OFF;
+
+// Position of the next record to be claimed by producers
+static atomic_size_t s_enqueuePos;
+// Position of the next record to be taken
+static atomic_size_t s_dequeuePos;
+// Number of records written or dropped
+static atomic_size_t s_completed;
+// Number of records dropped because of full queue
+static atomic_size_t s_dropped;
+// Number of dropped records already reported by the writer
+static size_t s_droppedReported = 0;
+
+// Flag to check writer is running
+static atomic_int s_isRunning;
+// Flag to request the writer to stop
+static atomic_int s_isStopping;
+// Flag to check writer is waiting for records
+static atomic_int s_isWriterIdle;
+
+// Batch of records written with a single write by the writer thread
+static char s_batch[UL_ASYNC_BATCH_SIZE];
+
+// Writer thread
+static pthread_t s_writerThread;
+// Mutex and condition to wake the writer
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Claims a free slot for writing
+ *
+ * @param pos position of the claimed slot
+ * @return AsyncSlot* claimed slot, NULL if queue is full
+ */
+static AsyncSlot *ClaimSlot(size_t *pos)
+{
+    size_t currPos = atomic_load_explicit(&s_enqueuePos, memory_order_relaxed);
+    for (;;)
+    {
+        AsyncSlot *slot = &s_slots[currPos & s_mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)currPos;
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(&s_enqueuePos, &currPos, currPos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *pos = currPos;
+                return slot;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Queue is full
+            return NULL;
+        }
+        else
+        {
+            currPos = atomic_load_explicit(&s_enqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Takes the oldest ready slot from the queue
+ *
+ * @param pos position of the taken slot
+ * @return AsyncSlot* taken slot, NULL if no record is ready
+ */
+static AsyncSlot *TakeSlot(size_t *pos)
+{
+    size_t currPos = atomic_load_explicit(&s_dequeuePos, memory_order_relaxed);
+    for (;;)
+    {
+        AsyncSlot *slot = &s_slots[currPos & s_mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(currPos + 1);
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(&s_dequeuePos, &currPos, currPos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *pos = currPos;
+                return slot;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Queue is empty or the record is still being formatted
+            return NULL;
+        }
+        else
+        {
+            currPos = atomic_load_explicit(&s_dequeuePos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Returns the taken slot to the producers
+ *
+ * @param slot taken slot
+ * @param pos position of the taken slot
+ */
+static inline void ReleaseSlot(AsyncSlot *slot, size_t pos)
+{
+    if (slot->overflow)
+    {
+        free(slot->overflow);
+        slot->overflow = NULL;
+    }
+    atomic_store_explicit(&slot->sequence, pos + s_mask + 1, memory_order_release);
+    atomic_fetch_add_explicit(&s_completed, 1, memory_order_release);
+}
+
+/**
+ * @brief Checks if the oldest record is ready to be written
+ */
+static inline unsigned char HasReadyRecord()
+{
+    size_t currPos = atomic_load_explicit(&s_dequeuePos, memory_order_relaxed);
+    size_t sequence = atomic_load_explicit(&s_slots[currPos & s_mask].sequence, memory_order_acquire);
+    return sequence == currPos + 1;
+}
+
+/**
+ * @brief Wakes the writer thread
+ */
+static inline void WakeWriter()
+{
+    pthread_mutex_lock(&s_wakeMutex);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+}
+
+/**
+ * @brief Formats a notice from the writer thread
+ *
+ * @param record destination buffer of UL_MAX_RECORD_SIZE
+ * @param format format of the print
+ * @param ... arguments of the print
+ * @return size_t length of the notice
+ */
+static size_t FormatNotice(char *record, const char *format, ...)
+{
+    UniLoggerCallSite callSite = {LOG_LEVEL_WARN, "UniLogger", __LINE__, NULL, 0, format, NULL, 0, NULL};
+    va_list args;
+    va_start(args, format);
+    size_t length = FormatLogRecord(record,
+                                    UL_MAX_RECORD_SIZE,
+                                    &callSite,
+                                    IsLogStreamPlain(),
+                                    args,
+                                    format);
+    va_end(args);
+    return length;
+}
+
+/**
+ * @brief Writer thread, drains the queue to the current stream
+ */
+static void *AsyncWriterThread(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        size_t pos;
+        AsyncSlot *slot = TakeSlot(&pos);
+        if (slot)
+        {
+            // Copy the ready records to the batch, written with a single write
+            size_t batchLength = 0;
+            do
+            {
+                LogRecord record = {slot->overflow ? slot->overflow : slot->data, slot->length, slot->level};
+                if (batchLength && record.length + UL_MAX_COLOR_SIZE > sizeof(s_batch) - batchLength)
+                {
+                    // Records of the batch are written before the long record
+                    WriteLogData(gCurrLogStream, s_batch, batchLength);
+                    batchLength = 0;
+                }
+                // Indexed with the bytes of the write of the batch or of the long record
+                if (Index_IsRunning())
+                {
+                    Index_AddRecord(slot->logLevel, &slot->time);
+                }
+                if (record.length + UL_MAX_COLOR_SIZE > sizeof(s_batch))
+                {
+                    LogRecord_Write(gCurrLogStream, &record, !IsLogStreamPlain());
+                }
+                else
+                {
+                    batchLength += LogRecord_Copy(s_batch + batchLength, &record, !IsLogStreamPlain());
+                }
+                Sinks_Write(&record);
+                ReleaseSlot(slot, pos);
+            } while (batchLength + UL_MAX_RECORD_SIZE + UL_MAX_COLOR_SIZE <= sizeof(s_batch) &&
+                     NULL != (slot = TakeSlot(&pos)));
+
+            size_t dropped = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+            if (dropped != s_droppedReported && batchLength + UL_MAX_RECORD_SIZE <= sizeof(s_batch))
+            {
+                batchLength += FormatNotice(s_batch + batchLength,
+                                            "Dropped %zu log records, asynchronous queue is full",
+                                            dropped - s_droppedReported);
+                s_droppedReported = dropped;
+            }
+
+            if (batchLength)
+            {
+                WriteLogData(gCurrLogStream, s_batch, batchLength);
+            }
+            fflush(gCurrLogStream);
+            continue;
+        }
+
+        if (atomic_load(&s_isStopping) &&
+            atomic_load(&s_dequeuePos) == atomic_load(&s_enqueuePos))
+        {
+            break;
+        }
+
+        // Wait till producers push new records
+        pthread_mutex_lock(&s_wakeMutex);
+        atomic_store(&s_isWriterIdle, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!HasReadyRecord() && !atomic_load(&s_isStopping))
+        {
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += 10 * 1000 * 1000;
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec += 1;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout);
+        }
+        atomic_store(&s_isWriterIdle, 0);
+        pthread_mutex_unlock(&s_wakeMutex);
+    }
+    return NULL;
+}
+
+int AsyncWriter_Start(enum LogAsyncMode mode, unsigned int queueSize)
+{
+    if (atomic_load(&s_isRunning) || ASYNC_OFF == mode)
+    {
+        return 0;
+    }
+
+    // Capacity must be power of 2
+    size_t capacity = 2;
+    while (capacity < queueSize)
+    {
+        capacity <<= 1;
+    }
+
+    s_slots = (AsyncSlot *)calloc(capacity, sizeof(AsyncSlot));
+    if (NULL == s_slots)
+    {
+        return -1;
+    }
+
+    size_t i;
+    for (i = 0; i < capacity; i++)
+    {
+        atomic_init(&s_slots[i].sequence, i);
+    }
+    s_mask = capacity - 1;
+    s_mode = mode;
+    atomic_store(&s_enqueuePos, 0);
+    atomic_store(&s_dequeuePos, 0);
+    atomic_store(&s_completed, 0);
+    atomic_store(&s_dropped, 0);
+    s_droppedReported = 0;
+    atomic_store(&s_isStopping, 0);
+    atomic_store(&s_isWriterIdle, 0);
+
+    if (0 != pthread_create(&s_writerThread, NULL, AsyncWriterThread, NULL))
+    {
+        free(s_slots);
+        s_slots = NULL;
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char AsyncWriter_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void AsyncWriter_Push(const UniLoggerCallSite *callSite,
+                      va_list args,
+                      const char *format)
+{
+    size_t pos;
+    AsyncSlot *slot;
+    while (NULL == (slot = ClaimSlot(&pos)))
+    {
+        if (ASYNC_DROP_NEWEST == s_mode)
+        {
+            atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+            Stats_DropRecord(callSite->level);
+            return;
+        }
+        else if (ASYNC_DROP_OLDEST == s_mode)
+        {
+            // Discard the oldest record to make space
+            size_t oldPos;
+            AsyncSlot *oldSlot = TakeSlot(&oldPos);
+            if (oldSlot)
+            {
+                // Strings of the dropped record are written again with the next records
+                if (ENCODING_BINARY == gCurrLogEncoding &&
+                    BinaryFormat_HasStrings(oldSlot->overflow ? oldSlot->overflow : oldSlot->data, oldSlot->length))
+                {
+                    BinaryFormat_ResetStrings();
+                }
+                Stats_DropRecord(oldSlot->logLevel);
+                ReleaseSlot(oldSlot, oldPos);
+                atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+                continue;
+            }
+        }
+
+        // Wait for the writer to make space
+        WakeWriter();
+        sched_yield();
+    }
+
+    // Records longer than the slot are allocated, freed when the slot is released
+    slot->length = FormatQueuedRecord(slot->data,
+                                      sizeof(slot->data),
+                                      callSite,
+                                      args,
+                                      format,
+                                      gCurrLogEncoding,
+                                      &slot->overflow);
+    slot->level = (ENCODING_TEXT == gCurrLogEncoding) ? callSite->level : LOG_LEVEL_OFF;
+    slot->logLevel = callSite->level;
+    Timestamp_Last(&slot->time);
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    // Wake the writer only if it is waiting
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s_isWriterIdle, memory_order_relaxed))
+    {
+        WakeWriter();
+    }
+}
+
+void AsyncWriter_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    // Wait till all the records claimed till now are written
+    size_t target = atomic_load(&s_enqueuePos);
+    while (atomic_load_explicit(&s_completed, memory_order_acquire) < target)
+    {
+        struct timespec delay = {0, 100 * 1000};
+        WakeWriter();
+        nanosleep(&delay, NULL);
+    }
+    fflush(gCurrLogStream);
+}
+
+void AsyncWriter_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    // Writer drains the remaining records before exiting
+    atomic_store(&s_isStopping, 1);
+    WakeWriter();
+    pthread_join(s_writerThread, NULL);
+
+    atomic_store(&s_isRunning, 0);
+    free(s_slots);
+    s_slots = NULL;
+    s_mode = ASYNC_OFF;
+}
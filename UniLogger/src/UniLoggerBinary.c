@@ -0,0 +1,514 @@
+/**
+ * @file UniLoggerBinary.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Deferred formatting binary records for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * In binary encoding the logs are not formatted with printf. The record
+ * holds the address of the format string and of the tag, the raw values
+ * of the arguments and the timestamp. The text of the format strings and
+ * tags is written only once, as a string record, when the address is seen
+ * first time. The records are rendered to text offline by unilogger-decode.
+ * Logs whose format and tag do not fit in full into half of the record are
+ * written as text lines, a string is never written truncated.
+ *
+ * Format strings must be string literals (or never change their content),
+ * as the address of the format is used as its identity.
+ */
+// System Include
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <wchar.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Number of format strings and tags tracked as written
+ * When full, the strings are written again with every record
+ */
+#ifndef UL_BINARY_STRING_TABLE_SIZE
+#define UL_BINARY_STRING_TABLE_SIZE 4096
+#endif // UL_BINARY_STRING_TABLE_SIZE
+
+// Addresses of the strings already written to the stream
+static atomic_uintptr_t s_writtenStrings[UL_BINARY_STRING_TABLE_SIZE];
+
+/**
+ * @brief Checks the string is already written, without marking it
+ *
+ * @param string address of the string
+ * @return unsigned char 1 -> written, 0 -> needs to be written
+ */
+static unsigned char IsStringWritten(const char *string)
+{
+    uintptr_t address = (uintptr_t)string;
+    size_t index = (size_t)((address >> 3) * 0x9E3779B97F4A7C15ULL) % UL_BINARY_STRING_TABLE_SIZE;
+    size_t probe;
+    for (probe = 0; probe < UL_BINARY_STRING_TABLE_SIZE; probe++)
+    {
+        uintptr_t current = atomic_load_explicit(&s_writtenStrings[(index + probe) % UL_BINARY_STRING_TABLE_SIZE],
+                                                 memory_order_relaxed);
+        if (current == address || 0 == current)
+        {
+            return current == address;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Marks the string as written
+ *
+ * @param string address of the string
+ * @return unsigned char 1 -> string needs to be written, 0 -> already written
+ */
+static unsigned char MarkStringWritten(const char *string)
+{
+    uintptr_t address = (uintptr_t)string;
+    size_t index = (size_t)((address >> 3) * 0x9E3779B97F4A7C15ULL) % UL_BINARY_STRING_TABLE_SIZE;
+    size_t probe;
+    for (probe = 0; probe < UL_BINARY_STRING_TABLE_SIZE; probe++)
+    {
+        atomic_uintptr_t *entry = &s_writtenStrings[(index + probe) % UL_BINARY_STRING_TABLE_SIZE];
+        uintptr_t current = atomic_load_explicit(entry, memory_order_relaxed);
+        if (current == address)
+        {
+            return 0;
+        }
+        if (0 == current)
+        {
+            if (atomic_compare_exchange_strong_explicit(entry, &current, address,
+                                                        memory_order_relaxed, memory_order_relaxed))
+            {
+                return 1;
+            }
+            if (current == address)
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Appends bytes to the record if space is available
+ *
+ * @return unsigned char 1 -> appended, 0 -> no space
+ */
+static inline unsigned char Append(char *buffer, size_t bufferSize, size_t *length, const void *data, size_t size)
+{
+    if (*length + size > bufferSize)
+    {
+        return 0;
+    }
+    memcpy(buffer + *length, data, size);
+    *length += size;
+    return 1;
+}
+
+/**
+ * @brief Gets the length of the string record
+ *
+ * @param stringLength length of the string
+ */
+static inline size_t StringRecordLength(size_t stringLength)
+{
+    return 2 + sizeof(uint64_t) + sizeof(uint16_t) + stringLength;
+}
+
+/**
+ * @brief Appends the string record for the whole string, the caller checks it fits
+ *
+ * @param stringLength length of the string
+ */
+static void AppendStringRecord(char *buffer, size_t bufferSize, size_t *length, const char *string, size_t stringLength)
+{
+    uint8_t header[2] = {UL_BINARY_MARKER, UL_BINARY_STRING};
+    uint64_t id = (uint64_t)(uintptr_t)string;
+    uint16_t size = (uint16_t)stringLength;
+
+    Append(buffer, bufferSize, length, header, sizeof(header));
+    Append(buffer, bufferSize, length, &id, sizeof(id));
+    Append(buffer, bufferSize, length, &size, sizeof(size));
+    Append(buffer, bufferSize, length, string, stringLength);
+}
+
+const char *BinaryFormat_NextSpec(const char *format, BinarySpec *spec)
+{
+    // Skip the text till the next conversion
+    while (*format && '%' != *format)
+    {
+        format++;
+    }
+    if ('\0' == *format)
+    {
+        return NULL;
+    }
+
+    spec->start = format++;
+    spec->starCount = 0;
+    spec->precision = -1;
+    spec->modifier = BINARY_MODIFIER_NONE;
+
+    // Flags
+    while (*format && strchr("-+ #0'", *format))
+    {
+        format++;
+    }
+    // Width
+    if ('*' == *format)
+    {
+        spec->starCount++;
+        format++;
+    }
+    while (*format >= '0' && *format <= '9')
+    {
+        format++;
+    }
+    // Precision
+    if ('.' == *format)
+    {
+        format++;
+        spec->precision = 0;
+        if ('*' == *format)
+        {
+            spec->starCount++;
+            spec->precision = -2;
+            format++;
+        }
+        while (*format >= '0' && *format <= '9')
+        {
+            spec->precision = spec->precision * 10 + (*format - '0');
+            format++;
+        }
+    }
+    // Length modifier
+    switch (*format)
+    {
+    case 'h':
+        format++;
+        spec->modifier = BINARY_MODIFIER_SHORT;
+        if ('h' == *format)
+        {
+            format++;
+            spec->modifier = BINARY_MODIFIER_CHAR;
+        }
+        break;
+    case 'l':
+        format++;
+        spec->modifier = BINARY_MODIFIER_LONG;
+        if ('l' == *format)
+        {
+            format++;
+            spec->modifier = BINARY_MODIFIER_LONG_LONG;
+        }
+        break;
+    case 'j':
+        format++;
+        spec->modifier = BINARY_MODIFIER_INTMAX;
+        break;
+    case 'z':
+        format++;
+        spec->modifier = BINARY_MODIFIER_SIZE;
+        break;
+    case 't':
+        format++;
+        spec->modifier = BINARY_MODIFIER_PTRDIFF;
+        break;
+    case 'L':
+        format++;
+        spec->modifier = BINARY_MODIFIER_LONG_DOUBLE;
+        break;
+    default:
+        break;
+    }
+
+    spec->conversion = *format;
+    switch (*format)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+        spec->type = BINARY_ARG_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->type = BINARY_ARG_DOUBLE;
+        break;
+    case 's':
+        spec->type = BINARY_ARG_STRING;
+        break;
+    case 'p':
+        spec->type = BINARY_ARG_POINTER;
+        break;
+    case 'n':
+        spec->type = BINARY_ARG_COUNT;
+        break;
+    case '%':
+        spec->type = BINARY_ARG_NONE;
+        break;
+    default:
+        // Invalid conversion, printed as it is
+        spec->type = BINARY_ARG_NONE;
+        spec->conversion = '\0';
+        spec->length = (size_t)(format - spec->start);
+        return format;
+    }
+
+    format++;
+    spec->length = (size_t)(format - spec->start);
+    return format;
+}
+
+/**
+ * @brief Reads the integer argument of the conversion
+ */
+static inline int64_t ReadInteger(const BinarySpec *spec, va_list *args)
+{
+    unsigned char isUnsigned = (NULL != strchr("uoxX", spec->conversion));
+    switch (spec->modifier)
+    {
+    case BINARY_MODIFIER_LONG:
+        if ('c' == spec->conversion)
+        {
+            return (int64_t)va_arg(*args, wint_t);
+        }
+        return isUnsigned ? (int64_t)va_arg(*args, unsigned long) : (int64_t)va_arg(*args, long);
+    case BINARY_MODIFIER_LONG_LONG:
+        return isUnsigned ? (int64_t)va_arg(*args, unsigned long long) : (int64_t)va_arg(*args, long long);
+    case BINARY_MODIFIER_INTMAX:
+        return isUnsigned ? (int64_t)va_arg(*args, uintmax_t) : (int64_t)va_arg(*args, intmax_t);
+    case BINARY_MODIFIER_SIZE:
+        return (int64_t)va_arg(*args, size_t);
+    case BINARY_MODIFIER_PTRDIFF:
+        return (int64_t)va_arg(*args, ptrdiff_t);
+    default:
+        return isUnsigned ? (int64_t)va_arg(*args, unsigned int) : (int64_t)va_arg(*args, int);
+    }
+}
+
+size_t EncodeBinaryRecord(char *buffer,
+                          size_t bufferSize,
+                          const UniLoggerCallSite *callSite,
+                          va_list args,
+                          const char *format)
+{
+    size_t length = 0;
+    const char *logTag = callSite->logTag;
+    struct timespec currTime;
+    Timestamp_Now(&currTime);
+
+    // Text of the format and the tag, written only once and only in full
+    unsigned char isTagNeeded = !IsStringWritten(logTag);
+    unsigned char isFormatNeeded = !IsStringWritten(format);
+    size_t tagLength = isTagNeeded ? strlen(logTag) : 0;
+    size_t formatLength = isFormatNeeded ? strlen(format) : 0;
+    size_t stringsLength = (isTagNeeded ? StringRecordLength(tagLength) : 0) +
+                           (isFormatNeeded ? StringRecordLength(formatLength) : 0);
+    if (tagLength > UINT16_MAX || formatLength > UINT16_MAX || stringsLength > bufferSize / 2)
+    {
+        // Strings too long for the record, the log is written as a text line
+        return FormatTextRecord(buffer, bufferSize, callSite, args, format);
+    }
+    if (isTagNeeded && MarkStringWritten(logTag))
+    {
+        AppendStringRecord(buffer, bufferSize, &length, logTag, tagLength);
+    }
+    if (isFormatNeeded && MarkStringWritten(format))
+    {
+        AppendStringRecord(buffer, bufferSize, &length, format, formatLength);
+    }
+
+    size_t recordStart = length;
+    uint8_t header[3] = {UL_BINARY_MARKER, UL_BINARY_LOG, (uint8_t)callSite->level};
+    uint16_t argLength = 0;
+    uint32_t line = (uint32_t)callSite->lineNum;
+    uint64_t timeNs = (uint64_t)currTime.tv_sec * 1000000000ULL + (uint64_t)currTime.tv_nsec;
+    uint64_t formatId = (uint64_t)(uintptr_t)format;
+    uint64_t tagId = (uint64_t)(uintptr_t)logTag;
+    size_t argLengthOffset = length + sizeof(header);
+    if (!Append(buffer, bufferSize, &length, header, sizeof(header)) ||
+        !Append(buffer, bufferSize, &length, &argLength, sizeof(argLength)) ||
+        !Append(buffer, bufferSize, &length, &line, sizeof(line)) ||
+        !Append(buffer, bufferSize, &length, &timeNs, sizeof(timeNs)) ||
+        !Append(buffer, bufferSize, &length, &formatId, sizeof(formatId)) ||
+        !Append(buffer, bufferSize, &length, &tagId, sizeof(tagId)))
+    {
+        return recordStart;
+    }
+    size_t argStart = length;
+
+    // Raw values of the arguments
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    BinarySpec spec;
+    const char *next = format;
+    while (NULL != (next = BinaryFormat_NextSpec(next, &spec)))
+    {
+        unsigned int i;
+        int precision = spec.precision;
+        for (i = 0; i < spec.starCount; i++)
+        {
+            int32_t star = (int32_t)va_arg(argsCopy, int);
+            Append(buffer, bufferSize, &length, &star, sizeof(star));
+            // Precision is the last '*' argument, negative is not given
+            if (-2 == precision && i + 1 == spec.starCount)
+            {
+                precision = star;
+            }
+        }
+
+        if (BINARY_ARG_INT == spec.type)
+        {
+            int64_t value = ReadInteger(&spec, &argsCopy);
+            Append(buffer, bufferSize, &length, &value, sizeof(value));
+        }
+        else if (BINARY_ARG_DOUBLE == spec.type)
+        {
+            double value = (BINARY_MODIFIER_LONG_DOUBLE == spec.modifier)
+                               ? (double)va_arg(argsCopy, long double)
+                               : va_arg(argsCopy, double);
+            Append(buffer, bufferSize, &length, &value, sizeof(value));
+        }
+        else if (BINARY_ARG_POINTER == spec.type)
+        {
+            uint64_t value = (uint64_t)(uintptr_t)va_arg(argsCopy, void *);
+            Append(buffer, bufferSize, &length, &value, sizeof(value));
+        }
+        else if (BINARY_ARG_STRING == spec.type)
+        {
+            const char *string;
+            if (BINARY_MODIFIER_LONG == spec.modifier)
+            {
+                // Wide strings are not supported
+                va_arg(argsCopy, const wchar_t *);
+                string = "(wide string)";
+            }
+            else
+            {
+                string = va_arg(argsCopy, const char *);
+                if (NULL == string)
+                {
+                    string = "(null)";
+                }
+            }
+
+            // Only the precision is read, the string may not be null terminated
+            size_t stringLength = (precision >= 0) ? strnlen(string, (size_t)precision) : strlen(string);
+
+            // Truncate the string to the space left in the record
+            size_t available = bufferSize - length;
+            available = (available > sizeof(uint16_t)) ? available - sizeof(uint16_t) : 0;
+            if (stringLength > available)
+            {
+                stringLength = available;
+            }
+            uint16_t size = (uint16_t)(stringLength > UINT16_MAX ? UINT16_MAX : stringLength);
+            if (Append(buffer, bufferSize, &length, &size, sizeof(size)))
+            {
+                Append(buffer, bufferSize, &length, string, size);
+            }
+        }
+        else if (BINARY_ARG_COUNT == spec.type)
+        {
+            // %n is not supported, argument is skipped
+            va_arg(argsCopy, void *);
+        }
+    }
+    va_end(argsCopy);
+
+    argLength = (uint16_t)(length - argStart);
+    memcpy(buffer + argLengthOffset, &argLength, sizeof(argLength));
+    return length;
+}
+
+size_t EncodeBinaryHeader(char *buffer, size_t bufferSize)
+{
+    size_t length = 0;
+    uint8_t header[2] = {UL_BINARY_MARKER, UL_BINARY_HEADER};
+    uint8_t version = UL_BINARY_VERSION;
+    uint32_t byteOrder = UL_BINARY_BYTE_ORDER;
+
+    Append(buffer, bufferSize, &length, header, sizeof(header));
+    Append(buffer, bufferSize, &length, UL_BINARY_MAGIC, sizeof(UL_BINARY_MAGIC) - 1);
+    Append(buffer, bufferSize, &length, &version, sizeof(version));
+    Append(buffer, bufferSize, &length, &byteOrder, sizeof(byteOrder));
+    return length;
+}
+
+size_t BinaryFormat_RecordLength(const char *data, size_t length)
+{
+    size_t recordLength;
+    uint16_t size;
+    if (0 == length)
+    {
+        return 0;
+    }
+    if (UL_BINARY_MARKER != (uint8_t)data[0])
+    {
+        // Text line between the binary records
+        const char *newline = (const char *)memchr(data, '\n', length);
+        return newline ? (size_t)(newline - data) + 1 : 0;
+    }
+    if (length < 2)
+    {
+        return 0;
+    }
+
+    switch ((uint8_t)data[1])
+    {
+    case UL_BINARY_HEADER:
+        recordLength = 2 + sizeof(UL_BINARY_MAGIC) - 1 + sizeof(uint8_t) + sizeof(uint32_t);
+        break;
+    case UL_BINARY_STRING:
+        if (length < 2 + sizeof(uint64_t) + sizeof(size))
+        {
+            return 0;
+        }
+        memcpy(&size, data + 2 + sizeof(uint64_t), sizeof(size));
+        recordLength = 2 + sizeof(uint64_t) + sizeof(size) + size;
+        break;
+    case UL_BINARY_LOG:
+        if (length < 3 + sizeof(size))
+        {
+            return 0;
+        }
+        memcpy(&size, data + 3, sizeof(size));
+        recordLength = 3 + sizeof(size) + sizeof(uint32_t) + 3 * sizeof(uint64_t) + size;
+        break;
+    default:
+        return 0;
+    }
+    return recordLength <= length ? recordLength : 0;
+}
+
+unsigned char BinaryFormat_HasStrings(const char *data, size_t length)
+{
+    // String records are written before the log record
+    return length >= 2 && UL_BINARY_MARKER == (uint8_t)data[0] && UL_BINARY_STRING == (uint8_t)data[1];
+}
+
+void BinaryFormat_ResetStrings()
+{
+    size_t index;
+    for (index = 0; index < UL_BINARY_STRING_TABLE_SIZE; index++)
+    {
+        atomic_store_explicit(&s_writtenStrings[index], 0, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file UniLoggerCallSite.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Registry of the log call sites for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every log macro expansion has a static descriptor. At the first log the
+ * descriptor gets an id and the "]:[LEVEL] [tag:line] " part of the log
+ * is rendered once, later logs of the call site only copy it.
+ */
+// System Include
+#include <stdlib.h>
+
+#include "UniLoggerInternal.h"
+
+// Registered call sites
+static UniLoggerCallSite *s_callSites = NULL;
+// Number of registered call sites
+static unsigned int s_callSiteCount = 0;
+// Mutex for registering the call sites
+static pthread_mutex_t s_callSiteMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void CallSite_Register(UniLoggerCallSite *callSite, const char *format)
+{
+    pthread_mutex_lock(&s_callSiteMutex);
+
+    // Registered by other thread while waiting
+    if (0 == callSite->id)
+    {
+        char prefix[UL_MAX_RECORD_SIZE / 2];
+        int written = snprintf(prefix,
+                               sizeof(prefix),
+                               "]:[%s] [%s:%d] ",
+                               logLevelNames[(unsigned char)callSite->level],
+                               callSite->logTag,
+                               callSite->lineNum);
+
+        // Without prefix the fields are formatted for every log
+        char *renderedPrefix = NULL;
+        if (written > 0 && (size_t)written < sizeof(prefix))
+        {
+            renderedPrefix = strdup(prefix);
+        }
+        if (renderedPrefix)
+        {
+            callSite->prefix = renderedPrefix;
+            callSite->prefixLength = (unsigned int)written;
+        }
+
+        callSite->format = format;
+        callSite->next = s_callSites;
+        s_callSites = callSite;
+        // Publishes the fields above to the threads loading the id
+        __atomic_store_n(&callSite->id, ++s_callSiteCount, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&s_callSiteMutex);
+}
+
+const UniLoggerCallSite *UniLogger_GetCallSites()
+{
+    pthread_mutex_lock(&s_callSiteMutex);
+    const UniLoggerCallSite *callSites = s_callSites;
+    pthread_mutex_unlock(&s_callSiteMutex);
+    return callSites;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file UniLoggerCallSiteStats.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Cost of every log call site for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * When enabled, every emitted log of a registered call site adds its hits,
+ * formatted bytes and the time spent formatting and writing it to the
+ * counters of the call site. The counters are a table indexed by the id of
+ * the call site (no change to the descriptor read by every log), updated
+ * with relaxed atomic adds. UniLogger_DumpCallSiteStats() writes the call
+ * sites with the highest cost, SIGUSR2 wakes a thread doing the same.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <semaphore.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Counters of one call site, one cache line so the call sites do not share it
+ */
+typedef struct CallSiteCost
+{
+    // Number of the emitted logs
+    atomic_ullong hits;
+    // Bytes of the formatted logs
+    atomic_ullong bytes;
+    // Time spent formatting and writing in ns
+    atomic_ullong ns;
+} __attribute__((aligned(64))) CallSiteCost;
+
+/**
+ * @brief Snapshot of the counters for the dump
+ */
+typedef struct CallSiteCostEntry
+{
+    const UniLoggerCallSite *callSite;
+    unsigned long long hits;
+    unsigned long long bytes;
+    unsigned long long ns;
+} CallSiteCostEntry;
+
+// Counters of the call sites, index is id - 1
+static CallSiteCost s_costs[UL_MAX_CALL_SITE_STATS];
+// Logs of the call sites with id beyond the table
+static atomic_ullong s_untrackedHits;
+// Number of call sites written by the dump (0 -> UL_CALL_SITE_STATS_DEFAULT_TOP)
+static unsigned int s_topCount = 0;
+// Mutex for the dump
+static pthread_mutex_t s_dumpMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Flag to check the counters are running
+static atomic_int s_isRunning;
+// Flag to check dump thread is running
+static atomic_int s_isDumpRunning;
+// Flag to request the dump thread to stop
+static atomic_int s_isDumpStopping;
+// Dump thread, woken by SIGUSR2
+static pthread_t s_dumpThread;
+// Semaphore posted by the signal handler (sem_post is async signal safe)
+static sem_t s_dumpSemaphore;
+// Action of SIGUSR2 before the handler was installed
+static struct sigaction s_oldAction;
+
+int CallSiteStats_Start(unsigned int topCount)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    s_topCount = topCount;
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char CallSiteStats_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void CallSiteStats_Add(const UniLoggerCallSite *callSite, size_t bytes, unsigned long long ns)
+{
+    unsigned int id = __atomic_load_n(&callSite->id, __ATOMIC_RELAXED);
+    if (0 == id)
+    {
+        // Call site without descriptor (UniLogger_CustomLogFn())
+        return;
+    }
+    if (id > UL_MAX_CALL_SITE_STATS)
+    {
+        atomic_fetch_add_explicit(&s_untrackedHits, 1, memory_order_relaxed);
+        return;
+    }
+
+    CallSiteCost *cost = &s_costs[id - 1];
+    atomic_fetch_add_explicit(&cost->hits, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&cost->bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&cost->ns, ns, memory_order_relaxed);
+}
+
+/**
+ * @brief Orders the entries by the time, highest first
+ */
+static int CompareCost(const void *first, const void *second)
+{
+    const CallSiteCostEntry *firstEntry = (const CallSiteCostEntry *)first;
+    const CallSiteCostEntry *secondEntry = (const CallSiteCostEntry *)second;
+    if (firstEntry->ns != secondEntry->ns)
+    {
+        return firstEntry->ns < secondEntry->ns ? 1 : -1;
+    }
+    return firstEntry->bytes < secondEntry->bytes ? 1 : (firstEntry->bytes > secondEntry->bytes ? -1 : 0);
+}
+
+void UniLogger_DumpCallSiteStats(unsigned int topCount)
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+    if (0 == topCount)
+    {
+        topCount = s_topCount ? s_topCount : UL_CALL_SITE_STATS_DEFAULT_TOP;
+    }
+
+    pthread_mutex_lock(&s_dumpMutex);
+
+    // Call sites registered after the snapshot are not written
+    unsigned int count = 0;
+    const UniLoggerCallSite *callSite;
+    for (callSite = UniLogger_GetCallSites(); callSite; callSite = callSite->next)
+    {
+        count++;
+    }
+
+    CallSiteCostEntry *entries = (CallSiteCostEntry *)malloc((count ? count : 1) * sizeof(CallSiteCostEntry));
+    if (NULL == entries)
+    {
+        pthread_mutex_unlock(&s_dumpMutex);
+        return;
+    }
+
+    unsigned int active = 0;
+    unsigned long long totalHits = 0;
+    unsigned long long totalNs = 0;
+    for (callSite = UniLogger_GetCallSites(); callSite && active < count; callSite = callSite->next)
+    {
+        if (callSite->id > UL_MAX_CALL_SITE_STATS)
+        {
+            continue;
+        }
+
+        const CallSiteCost *cost = &s_costs[callSite->id - 1];
+        CallSiteCostEntry *entry = &entries[active];
+        entry->hits = atomic_load_explicit(&cost->hits, memory_order_relaxed);
+        if (0 == entry->hits)
+        {
+            continue;
+        }
+        entry->callSite = callSite;
+        entry->bytes = atomic_load_explicit(&cost->bytes, memory_order_relaxed);
+        entry->ns = atomic_load_explicit(&cost->ns, memory_order_relaxed);
+        totalHits += entry->hits;
+        totalNs += entry->ns;
+        active++;
+    }
+    qsort(entries, active, sizeof(CallSiteCostEntry), CompareCost);
+
+    if (topCount > active)
+    {
+        topCount = active;
+    }
+    UniLogger_CustomLogFn(LOG_LEVEL_INFO, "CallSites", __LINE__,
+                          "Top %u of %u call sites: hits %llu, total %llu us, untracked hits %llu",
+                          topCount,
+                          active,
+                          totalHits,
+                          totalNs / 1000,
+                          (unsigned long long)atomic_load_explicit(&s_untrackedHits, memory_order_relaxed));
+
+    unsigned int i;
+    for (i = 0; i < topCount; i++)
+    {
+        const CallSiteCostEntry *entry = &entries[i];
+        UniLogger_CustomLogFn(LOG_LEVEL_INFO, "CallSites", __LINE__,
+                              "#%u [%s] [%s] %s:%u: hits %llu, bytes %llu, total %llu us, mean %.1f ns, %.1f%% of time",
+                              i + 1,
+                              logLevelNames[(unsigned char)entry->callSite->level],
+                              entry->callSite->logTag,
+                              entry->callSite->fileName ? entry->callSite->fileName : "?",
+                              entry->callSite->lineNum,
+                              entry->hits,
+                              entry->bytes,
+                              entry->ns / 1000,
+                              (double)entry->ns / (double)entry->hits,
+                              totalNs ? 100.0 * (double)entry->ns / (double)totalNs : 0.0);
+    }
+
+    free(entries);
+    pthread_mutex_unlock(&s_dumpMutex);
+}
+
+/**
+ * @brief Handler of SIGUSR2, wakes the dump thread
+ */
+static void DumpSignalHandler(int signal)
+{
+    (void)signal;
+    int savedErrno = errno;
+    sem_post(&s_dumpSemaphore);
+    errno = savedErrno;
+}
+
+/**
+ * @brief Dump thread, writes the statistics when SIGUSR2 is received
+ */
+static void *CallSiteDumpThread(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&s_isDumpStopping))
+    {
+        if (0 != sem_wait(&s_dumpSemaphore))
+        {
+            continue;
+        }
+        if (!atomic_load(&s_isDumpStopping))
+        {
+            UniLogger_DumpCallSiteStats(0);
+        }
+    }
+    return NULL;
+}
+
+int CallSiteStats_StartSignalDump()
+{
+    if (atomic_load(&s_isDumpRunning))
+    {
+        return 0;
+    }
+
+    // Handler of the application is not replaced
+    struct sigaction currAction;
+    if (0 != sigaction(SIGUSR2, NULL, &currAction) ||
+        (SIG_DFL != currAction.sa_handler && SIG_IGN != currAction.sa_handler))
+    {
+        return -1;
+    }
+
+    if (0 != sem_init(&s_dumpSemaphore, 0, 0))
+    {
+        return -1;
+    }
+
+    atomic_store(&s_isDumpStopping, 0);
+    if (0 != pthread_create(&s_dumpThread, NULL, CallSiteDumpThread, NULL))
+    {
+        sem_destroy(&s_dumpSemaphore);
+        return -1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = DumpSignalHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (0 != sigaction(SIGUSR2, &action, &s_oldAction))
+    {
+        atomic_store(&s_isDumpStopping, 1);
+        sem_post(&s_dumpSemaphore);
+        pthread_join(s_dumpThread, NULL);
+        sem_destroy(&s_dumpSemaphore);
+        return -1;
+    }
+
+    atomic_store(&s_isDumpRunning, 1);
+    return 0;
+}
+
+void CallSiteStats_Stop()
+{
+    if (atomic_load(&s_isDumpRunning))
+    {
+        sigaction(SIGUSR2, &s_oldAction, NULL);
+        atomic_store(&s_isDumpStopping, 1);
+        sem_post(&s_dumpSemaphore);
+        pthread_join(s_dumpThread, NULL);
+        sem_destroy(&s_dumpSemaphore);
+        atomic_store(&s_isDumpRunning, 0);
+    }
+
+    atomic_store(&s_isRunning, 0);
+}
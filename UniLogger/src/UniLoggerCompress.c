@@ -0,0 +1,705 @@
+/**
+ * @file UniLoggerCompress.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Compressed log file sink for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Writes of the log file are copied into an open block, the callers never
+ * compress. A full block, or a partly filled one after the flush interval,
+ * is handed to a thread which compresses it into one complete frame (gzip
+ * member, LZ4 frame or zstd frame) and writes the frame to the file. The
+ * frames follow each other, so the file is read as one stream by zcat,
+ * lz4cat or zstdcat while it grows, and a crash loses only the open block.
+ * Writers wait only if the next block is full while the thread is still
+ * compressing the previous one. Records written by the signal handlers are
+ * written as uncompressed frames of the same format.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef UL_WITH_ZLIB
+#include <zlib.h>
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_LZ4
+#include <lz4frame.h>
+#endif // UL_WITH_LZ4
+#ifdef UL_WITH_ZSTD
+#include <zstd.h>
+#endif // UL_WITH_ZSTD
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Maximum parts of an uncompressed frame, longer records are written as more frames
+ */
+#define UL_COMPRESS_STORED_PARTS 16
+
+// Descriptor of the log file
+static int s_fd = -1;
+// Format of the frames
+static enum LogFileCompression s_compression = COMPRESSION_NONE;
+// Uncompressed size of a block
+static size_t s_blockSize = 0;
+// Time after which a partly filled block is compressed in ns
+static unsigned long long s_flushIntervalNs = 0;
+
+// Block filled by the callers
+static char *s_openBuffer = NULL;
+// Bytes in the open block
+static size_t s_openLength = 0;
+// Time of the first record in the open block
+static unsigned long long s_openTime = 0;
+// Block compressed by the thread
+static char *s_readyBuffer = NULL;
+// Bytes in the ready block, 0 while the thread has no block
+static size_t s_readyLength = 0;
+// Compressed frame of the ready block
+static char *s_frameBuffer = NULL;
+// Size of the frame buffer (bound of a compressed block)
+static size_t s_frameSize = 0;
+
+// Blocks handed to the thread
+static unsigned long long s_blocksQueued = 0;
+// Blocks written by the thread
+static unsigned long long s_blocksWritten = 0;
+
+// Mutex of the blocks
+static pthread_mutex_t s_compressMutex = PTHREAD_MUTEX_INITIALIZER;
+// Condition to wake the thread
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+// Condition signalled when the thread has written a block
+static pthread_cond_t s_doneCond = PTHREAD_COND_INITIALIZER;
+// Flag set while a record longer than a block is copied, other writers wait
+static unsigned char s_isSpanning = 0;
+// Flag to request the thread to stop
+static unsigned char s_isStopping = 0;
+// Compressor thread
+static pthread_t s_compressThread;
+
+// Flag to check sink is running
+static atomic_int s_isRunning;
+
+#ifdef UL_WITH_ZLIB
+// Deflate stream, reset for every block
+static z_stream s_zStream;
+// Flag to check deflate stream is initalized
+static unsigned char s_isZStreamInitalized = 0;
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_LZ4
+// Preferences of the LZ4 frames
+static LZ4F_preferences_t s_lz4Preferences;
+#endif // UL_WITH_LZ4
+#ifdef UL_WITH_ZSTD
+// Context of the zstd compression, reused for every block
+static ZSTD_CCtx *s_zstdContext = NULL;
+#endif // UL_WITH_ZSTD
+
+/**
+ * @brief Magic numbers at the start of the frames
+ */
+static const unsigned char s_gzipMagic[] = {0x1f, 0x8b};
+static const unsigned char s_lz4Magic[] = {0x04, 0x22, 0x4d, 0x18};
+static const unsigned char s_zstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+/**
+ * @brief Writes all the vectors without the statistics (async signal safe)
+ *
+ * @param vectors data to write (modified for partial writes)
+ * @param count number of vectors
+ */
+static void WriteAll(struct iovec *vectors, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = writev(s_fd, vectors, count);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return;
+        }
+        while (count > 0 && (size_t)written >= vectors->iov_len)
+        {
+            written -= (ssize_t)vectors->iov_len;
+            vectors++;
+            count--;
+        }
+        if (count > 0)
+        {
+            vectors->iov_base = (char *)vectors->iov_base + written;
+            vectors->iov_len -= (size_t)written;
+        }
+    }
+}
+
+/**
+ * @brief Writes the data as uncompressed frames of the current format (async signal safe)
+ * One writev() per frame, the frame is not split by the frames of the thread
+ *
+ * @param data data to write
+ * @param length length of the data
+ */
+static void WriteStoredFrame(const char *data, size_t length)
+{
+    // Deflate stored block, LZ4 uncompressed block (64 KB maximum), zstd raw block (128 KB window)
+    size_t partSize = (COMPRESSION_GZIP == s_compression)  ? 65535
+                      : (COMPRESSION_LZ4 == s_compression) ? 64 * 1024
+                                                           : 128 * 1024;
+    while (length)
+    {
+        unsigned char frameHeader[10];
+        unsigned char partHeaders[UL_COMPRESS_STORED_PARTS][5];
+        unsigned char frameTrailer[8];
+        struct iovec vectors[2 * UL_COMPRESS_STORED_PARTS + 2];
+        int count = 1;
+        size_t frameHeaderLength = 0;
+        size_t frameTrailerLength = 0;
+
+        switch (s_compression)
+        {
+        case COMPRESSION_GZIP:
+            // Deflate, no flags, no time, unknown OS
+            memcpy(frameHeader, s_gzipMagic, sizeof(s_gzipMagic));
+            memcpy(frameHeader + 2, "\x08\x00\x00\x00\x00\x00\x00\xff", 8);
+            frameHeaderLength = 10;
+            break;
+        case COMPRESSION_LZ4:
+            // Version 1, independent blocks, 64 KB blocks, checksum of the descriptor
+            memcpy(frameHeader, s_lz4Magic, sizeof(s_lz4Magic));
+            memcpy(frameHeader + 4, "\x60\x40\x82", 3);
+            frameHeaderLength = 7;
+            break;
+        case COMPRESSION_ZSTD:
+            // No content size, no checksum, window of 128 KB
+            memcpy(frameHeader, s_zstdMagic, sizeof(s_zstdMagic));
+            memcpy(frameHeader + 4, "\x00\x38", 2);
+            frameHeaderLength = 6;
+            break;
+        default:
+            return;
+        }
+        vectors[0].iov_base = frameHeader;
+        vectors[0].iov_len = frameHeaderLength;
+
+#ifdef UL_WITH_ZLIB
+        uLong crc = crc32(0L, Z_NULL, 0);
+#endif // UL_WITH_ZLIB
+        uint32_t frameLength = 0;
+        unsigned int part;
+        for (part = 0; part < UL_COMPRESS_STORED_PARTS && length; part++)
+        {
+            uint32_t size = (uint32_t)((length < partSize) ? length : partSize);
+            unsigned char isLast = (size == length) || (UL_COMPRESS_STORED_PARTS - 1 == part);
+            unsigned char *partHeader = partHeaders[part];
+            size_t partHeaderLength;
+            if (COMPRESSION_GZIP == s_compression)
+            {
+                partHeader[0] = isLast;
+                partHeader[1] = (unsigned char)size;
+                partHeader[2] = (unsigned char)(size >> 8);
+                partHeader[3] = (unsigned char)~size;
+                partHeader[4] = (unsigned char)(~size >> 8);
+                partHeaderLength = 5;
+#ifdef UL_WITH_ZLIB
+                crc = crc32(crc, (const Bytef *)data, (uInt)size);
+#endif // UL_WITH_ZLIB
+            }
+            else if (COMPRESSION_LZ4 == s_compression)
+            {
+                uint32_t blockSize = size | 0x80000000U;
+                partHeader[0] = (unsigned char)blockSize;
+                partHeader[1] = (unsigned char)(blockSize >> 8);
+                partHeader[2] = (unsigned char)(blockSize >> 16);
+                partHeader[3] = (unsigned char)(blockSize >> 24);
+                partHeaderLength = 4;
+            }
+            else
+            {
+                uint32_t blockHeader = (size << 3) | isLast;
+                partHeader[0] = (unsigned char)blockHeader;
+                partHeader[1] = (unsigned char)(blockHeader >> 8);
+                partHeader[2] = (unsigned char)(blockHeader >> 16);
+                partHeaderLength = 3;
+            }
+            vectors[count].iov_base = partHeader;
+            vectors[count].iov_len = partHeaderLength;
+            vectors[count + 1].iov_base = (void *)data;
+            vectors[count + 1].iov_len = size;
+            count += 2;
+
+            data += size;
+            length -= size;
+            frameLength += size;
+        }
+
+        if (COMPRESSION_GZIP == s_compression)
+        {
+#ifdef UL_WITH_ZLIB
+            uint32_t values[2] = {(uint32_t)crc, frameLength};
+#else
+            uint32_t values[2] = {0, frameLength};
+#endif // UL_WITH_ZLIB
+            unsigned int i;
+            for (i = 0; i < 8; i++)
+            {
+                frameTrailer[i] = (unsigned char)(values[i / 4] >> (8 * (i % 4)));
+            }
+            frameTrailerLength = 8;
+        }
+        else if (COMPRESSION_LZ4 == s_compression)
+        {
+            // End mark
+            memset(frameTrailer, 0, 4);
+            frameTrailerLength = 4;
+        }
+        if (frameTrailerLength)
+        {
+            vectors[count].iov_base = frameTrailer;
+            vectors[count].iov_len = frameTrailerLength;
+            count++;
+        }
+        WriteAll(vectors, count);
+    }
+}
+
+/**
+ * @brief Compresses the block into one complete frame
+ *
+ * @param data data of the block
+ * @param length length of the block
+ * @return size_t length of the frame in s_frameBuffer, 0 on failure
+ */
+static size_t CompressBlock(const char *data, size_t length)
+{
+    switch (s_compression)
+    {
+#ifdef UL_WITH_ZLIB
+    case COMPRESSION_GZIP:
+        if (Z_OK != deflateReset(&s_zStream))
+        {
+            return 0;
+        }
+        s_zStream.next_in = (Bytef *)data;
+        s_zStream.avail_in = (uInt)length;
+        s_zStream.next_out = (Bytef *)s_frameBuffer;
+        s_zStream.avail_out = (uInt)s_frameSize;
+        if (Z_STREAM_END != deflate(&s_zStream, Z_FINISH))
+        {
+            return 0;
+        }
+        return s_frameSize - s_zStream.avail_out;
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_LZ4
+    case COMPRESSION_LZ4:
+    {
+        size_t frameLength = LZ4F_compressFrame(s_frameBuffer, s_frameSize, data, length, &s_lz4Preferences);
+        return LZ4F_isError(frameLength) ? 0 : frameLength;
+    }
+#endif // UL_WITH_LZ4
+#ifdef UL_WITH_ZSTD
+    case COMPRESSION_ZSTD:
+    {
+        size_t frameLength = ZSTD_compressCCtx(s_zstdContext, s_frameBuffer, s_frameSize,
+                                               data, length, UL_COMPRESS_ZSTD_LEVEL);
+        return ZSTD_isError(frameLength) ? 0 : frameLength;
+    }
+#endif // UL_WITH_ZSTD
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Hands the open block to the thread, called with the mutex when the thread has no block
+ */
+static void SwapBlocks()
+{
+    char *buffer = s_readyBuffer;
+    s_readyBuffer = s_openBuffer;
+    s_readyLength = s_openLength;
+    s_openBuffer = buffer;
+    s_openLength = 0;
+    s_blocksQueued++;
+    pthread_cond_signal(&s_wakeCond);
+}
+
+/**
+ * @brief Compressor thread, writes the full blocks and the partly filled ones after the flush interval
+ */
+static void *CompressThread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_compressMutex);
+    for (;;)
+    {
+        if (0 == s_readyLength && s_openLength &&
+            (s_isStopping || Stats_Now() - s_openTime >= s_flushIntervalNs))
+        {
+            // Readers of the file stay behind by the flush interval at most
+            SwapBlocks();
+        }
+
+        if (s_readyLength)
+        {
+            pthread_mutex_unlock(&s_compressMutex);
+
+            // Ready block is used only by this thread, block which does not compress is kept readable
+            size_t frameLength = CompressBlock(s_readyBuffer, s_readyLength);
+            if (frameLength)
+            {
+                struct iovec vector = {s_frameBuffer, frameLength};
+                WriteVectors(s_fd, &vector, 1);
+            }
+            else
+            {
+                WriteStoredFrame(s_readyBuffer, s_readyLength);
+            }
+
+            pthread_mutex_lock(&s_compressMutex);
+            s_readyLength = 0;
+            s_blocksWritten++;
+            pthread_cond_broadcast(&s_doneCond);
+            continue;
+        }
+
+        if (s_isStopping)
+        {
+            break;
+        }
+
+        if (s_openLength)
+        {
+            // Wait till the open block is due
+            unsigned long long waitNs = s_openTime + s_flushIntervalNs - Stats_Now();
+            if (waitNs > s_flushIntervalNs)
+            {
+                continue;
+            }
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_sec += (time_t)(waitNs / 1000000000ULL);
+            timeout.tv_nsec += (long)(waitNs % 1000000000ULL);
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&s_wakeCond, &s_compressMutex, &timeout);
+        }
+        else
+        {
+            pthread_cond_wait(&s_wakeCond, &s_compressMutex);
+        }
+    }
+    pthread_mutex_unlock(&s_compressMutex);
+    return NULL;
+}
+
+/**
+ * @brief Checks the file can get the frames, empty or starting with a frame of the format
+ *
+ * @param fd descriptor of the log file
+ * @param filePath path of the log file
+ * @return int 0 if the frames can be appended, -1 otherwise
+ */
+static int CheckFile(int fd, const char *filePath)
+{
+    struct stat fileStat;
+    if (0 != fstat(fd, &fileStat))
+    {
+        return -1;
+    }
+    if (!S_ISREG(fileStat.st_mode) || 0 == fileStat.st_size)
+    {
+        return 0;
+    }
+
+    // Frames appended to a plain file would not be read
+    const unsigned char *magic = (COMPRESSION_GZIP == s_compression)  ? s_gzipMagic
+                                 : (COMPRESSION_LZ4 == s_compression) ? s_lz4Magic
+                                                                      : s_zstdMagic;
+    size_t magicLength = (COMPRESSION_GZIP == s_compression) ? sizeof(s_gzipMagic) : 4;
+    unsigned char fileMagic[4];
+    int readFd = open(filePath, O_RDONLY | O_CLOEXEC);
+    if (readFd < 0)
+    {
+        return -1;
+    }
+    ssize_t readLength = read(readFd, fileMagic, magicLength);
+    close(readFd);
+    return ((size_t)readLength == magicLength && 0 == memcmp(fileMagic, magic, magicLength)) ? 0 : -1;
+}
+
+unsigned char CompressSink_IsAvailable(enum LogFileCompression compression)
+{
+#ifdef UL_WITH_ZLIB
+    if (COMPRESSION_GZIP == compression)
+    {
+        return 1;
+    }
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_LZ4
+    if (COMPRESSION_LZ4 == compression)
+    {
+        return 1;
+    }
+#endif // UL_WITH_LZ4
+#ifdef UL_WITH_ZSTD
+    if (COMPRESSION_ZSTD == compression)
+    {
+        return 1;
+    }
+#endif // UL_WITH_ZSTD
+    (void)compression;
+    return 0;
+}
+
+int CompressSink_Start(FILE *stream,
+                       const char *filePath,
+                       enum LogFileCompression compression,
+                       size_t blockSize,
+                       unsigned int flushInterval)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+    if (!CompressSink_IsAvailable(compression))
+    {
+        return -1;
+    }
+
+    // Buffered logs of the stream are written before the frames
+    fflush(stream);
+    int fd = fileno(stream);
+    s_compression = compression;
+    if (fd < 0 || 0 != CheckFile(fd, filePath))
+    {
+        return -1;
+    }
+
+    switch (compression)
+    {
+#ifdef UL_WITH_ZLIB
+    case COMPRESSION_GZIP:
+        // Window of 32 KB with the gzip wrapper
+        memset(&s_zStream, 0, sizeof(s_zStream));
+        if (Z_OK != deflateInit2(&s_zStream, UL_COMPRESS_GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY))
+        {
+            return -1;
+        }
+        s_isZStreamInitalized = 1;
+        s_frameSize = deflateBound(&s_zStream, (uLong)blockSize);
+        break;
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_LZ4
+    case COMPRESSION_LZ4:
+        // Content checksum, so a damaged frame is detected by the reader
+        memset(&s_lz4Preferences, 0, sizeof(s_lz4Preferences));
+        s_lz4Preferences.frameInfo.blockSizeID = LZ4F_max256KB;
+        s_lz4Preferences.frameInfo.blockMode = LZ4F_blockLinked;
+        s_lz4Preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        s_lz4Preferences.frameInfo.contentSize = 0;
+        s_lz4Preferences.compressionLevel = UL_COMPRESS_LZ4_LEVEL;
+        s_frameSize = LZ4F_compressFrameBound(blockSize, &s_lz4Preferences);
+        break;
+#endif // UL_WITH_LZ4
+#ifdef UL_WITH_ZSTD
+    case COMPRESSION_ZSTD:
+        s_zstdContext = ZSTD_createCCtx();
+        if (NULL == s_zstdContext)
+        {
+            return -1;
+        }
+        s_frameSize = ZSTD_compressBound(blockSize);
+        break;
+#endif // UL_WITH_ZSTD
+    default:
+        return -1;
+    }
+
+    s_openBuffer = (char *)malloc(blockSize);
+    s_readyBuffer = (char *)malloc(blockSize);
+    s_frameBuffer = (char *)malloc(s_frameSize);
+    if (NULL == s_openBuffer || NULL == s_readyBuffer || NULL == s_frameBuffer)
+    {
+        CompressSink_Stop();
+        return -1;
+    }
+    s_fd = fd;
+    s_blockSize = blockSize;
+    s_flushIntervalNs = (unsigned long long)flushInterval * 1000000ULL;
+    s_openLength = 0;
+    s_readyLength = 0;
+    s_blocksQueued = 0;
+    s_blocksWritten = 0;
+    s_isSpanning = 0;
+    s_isStopping = 0;
+
+    if (0 != pthread_create(&s_compressThread, NULL, CompressThread, NULL))
+    {
+        CompressSink_Stop();
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char CompressSink_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void CompressSink_Write(const struct iovec *vectors, int count)
+{
+    size_t length = 0;
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        length += vectors[i].iov_len;
+    }
+
+    Stats_LockMutex(&s_compressMutex);
+
+    // Record is kept in one block, the block is handed early if the record does not fit
+    while (s_isSpanning || (s_openLength && s_openLength + length > s_blockSize))
+    {
+        if (!s_isSpanning && 0 == s_readyLength)
+        {
+            SwapBlocks();
+            continue;
+        }
+        // Writers wait only while the thread is compressing the previous block
+        pthread_cond_wait(&s_doneCond, &s_compressMutex);
+    }
+
+    // Record longer than a block holds the open block till it is copied
+    s_isSpanning = length > s_blockSize;
+    for (i = 0; i < count; i++)
+    {
+        const char *data = (const char *)vectors[i].iov_base;
+        size_t remaining = vectors[i].iov_len;
+        while (remaining)
+        {
+            if (s_openLength == s_blockSize)
+            {
+                if (s_readyLength)
+                {
+                    pthread_cond_wait(&s_doneCond, &s_compressMutex);
+                }
+                else
+                {
+                    SwapBlocks();
+                }
+                continue;
+            }
+
+            if (0 == s_openLength)
+            {
+                // Thread waits for the flush interval from the first record
+                s_openTime = Stats_Now();
+                pthread_cond_signal(&s_wakeCond);
+            }
+            size_t copied = s_blockSize - s_openLength;
+            if (copied > remaining)
+            {
+                copied = remaining;
+            }
+            memcpy(s_openBuffer + s_openLength, data, copied);
+            s_openLength += copied;
+            data += copied;
+            remaining -= copied;
+        }
+    }
+    if (s_isSpanning)
+    {
+        s_isSpanning = 0;
+        pthread_cond_broadcast(&s_doneCond);
+    }
+    pthread_mutex_unlock(&s_compressMutex);
+}
+
+void CompressSink_WriteFromSignal(const char *data, size_t length)
+{
+    // Open block can not be compressed from the signal handler, the record is written uncompressed
+    if (s_fd < 0 || 0 == length)
+    {
+        return;
+    }
+    WriteStoredFrame(data, length);
+}
+
+void CompressSink_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_compressMutex);
+    while (s_openLength)
+    {
+        if (s_readyLength)
+        {
+            pthread_cond_wait(&s_doneCond, &s_compressMutex);
+        }
+        else
+        {
+            SwapBlocks();
+        }
+    }
+
+    // Blocks handed till now are written, later records are not waited for
+    unsigned long long target = s_blocksQueued;
+    while (s_blocksWritten < target)
+    {
+        pthread_cond_wait(&s_doneCond, &s_compressMutex);
+    }
+    pthread_mutex_unlock(&s_compressMutex);
+}
+
+void CompressSink_Stop()
+{
+    if (atomic_load(&s_isRunning))
+    {
+        pthread_mutex_lock(&s_compressMutex);
+        s_isStopping = 1;
+        pthread_cond_signal(&s_wakeCond);
+        pthread_mutex_unlock(&s_compressMutex);
+        pthread_join(s_compressThread, NULL);
+        atomic_store(&s_isRunning, 0);
+    }
+
+#ifdef UL_WITH_ZLIB
+    if (s_isZStreamInitalized)
+    {
+        deflateEnd(&s_zStream);
+        s_isZStreamInitalized = 0;
+    }
+#endif // UL_WITH_ZLIB
+#ifdef UL_WITH_ZSTD
+    ZSTD_freeCCtx(s_zstdContext);
+    s_zstdContext = NULL;
+#endif // UL_WITH_ZSTD
+    free(s_openBuffer);
+    free(s_readyBuffer);
+    free(s_frameBuffer);
+    s_openBuffer = NULL;
+    s_readyBuffer = NULL;
+    s_frameBuffer = NULL;
+    s_frameSize = 0;
+    s_blockSize = 0;
+    s_fd = -1;
+}
@@ -0,0 +1,480 @@
+/**
+ * @file UniLoggerDuplicate.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Collapsing of the repeated logs for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every logging thread keeps a short window of its recent records, each
+ * one identified by its call site and the hash of its formatted message.
+ * A record matching an entry of the window is not written, only counted
+ * on the entry. The repeats are written as one "Message repeated N times"
+ * log of the call site when the entry leaves the window (run has ended),
+ * when the run is older than the flush interval (by the thread itself or
+ * by the flush thread, for the threads which stopped logging), and at
+ * UniLogger_Flush(), UniLogger_CloseLogger() and the exit of the thread.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Recent record of the thread
+ */
+typedef struct DuplicateEntry
+{
+    // Call site of the record, NULL if the entry is free
+    const UniLoggerCallSite *callSite;
+    // Copy of the call site without descriptor (UniLogger_CustomLogFn())
+    UniLoggerCallSite site;
+    // Copy of the tag of the call site without descriptor
+    char logTag[UL_DUPLICATE_TAG_SIZE];
+    // Hash of the call site and the formatted message
+    uint64_t hash;
+    // Length of the formatted message
+    size_t length;
+    // Repeats not written since the start of the run
+    unsigned long long repeated;
+    // Start of the run (written record or last summary)
+    unsigned long long runStartNs;
+    // Time of the last record of the entry
+    unsigned long long lastNs;
+    // Last use of the entry, the least recently used one leaves the window
+    unsigned long long lastUse;
+} DuplicateEntry;
+
+/**
+ * @brief Window of the recent records of one logging thread
+ */
+typedef struct DuplicateWindow
+{
+    // Mutex of the entries, taken by the owner and by the flush
+    pthread_mutex_t mutex;
+    // Recent records
+    DuplicateEntry entries[UL_DUPLICATE_MAX_WINDOW];
+    // Counter of the uses
+    unsigned long long uses;
+    // Flag to check window is owned by a thread
+    atomic_int isOwned;
+    // Next window in registry
+    struct DuplicateWindow *next;
+} DuplicateWindow;
+
+/**
+ * @brief Summary of a run, written after the mutex of the window is released
+ */
+typedef struct DuplicateSummary
+{
+    UniLoggerCallSite site;
+    char logTag[UL_DUPLICATE_TAG_SIZE];
+    const UniLoggerCallSite *callSite;
+    unsigned long long repeated;
+    unsigned long long spanNs;
+} DuplicateSummary;
+
+// Registry of the windows
+static DuplicateWindow *_Atomic s_windows = NULL;
+// Mutex for registering the windows
+static pthread_mutex_t s_registryMutex = PTHREAD_MUTEX_INITIALIZER;
+// Key to write the runs and release the window on thread exit
+static pthread_key_t s_windowKey;
+// Number of entries used in every window
+static unsigned int s_windowSize = 0;
+// Time after which a run is written in ns
+static unsigned long long s_flushIntervalNs = 0;
+// Generation of the windows, thread local windows of old generation are invalid
+static atomic_uint s_generation;
+
+// Window of the logging thread
+static __thread DuplicateWindow *t_window = NULL;
+// Generation of the thread local window
+static __thread unsigned int t_generation = 0;
+// Formatted message of the thread
+static __thread char t_messageBuffer[UL_STAGING_BUFFER_SIZE];
+
+// Flag to check collapsing is running
+static atomic_int s_isRunning;
+// Flag to request the flush thread to stop
+static atomic_int s_isStopping;
+// Flush thread
+static pthread_t s_flushThread;
+// Mutex and condition to wake the flush thread
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Takes the summary of the run and starts a new run of the entry
+ *
+ * @param entry entry with repeats
+ * @param summary summary to be written
+ */
+static void TakeSummary(DuplicateEntry *entry, DuplicateSummary *summary)
+{
+    if (entry->callSite == &entry->site)
+    {
+        // Copy of the copy, the entry may be reused before the summary is written
+        summary->site = entry->site;
+        memcpy(summary->logTag, entry->logTag, sizeof(summary->logTag));
+        summary->site.logTag = summary->logTag;
+        summary->callSite = &summary->site;
+    }
+    else
+    {
+        summary->callSite = entry->callSite;
+    }
+    summary->repeated = entry->repeated;
+    summary->spanNs = entry->lastNs - entry->runStartNs;
+
+    entry->repeated = 0;
+    entry->runStartNs = entry->lastNs;
+}
+
+/**
+ * @brief Writes the summaries of the runs
+ *
+ * @param summaries summaries taken from a window
+ * @param count number of the summaries
+ */
+static void WriteSummaries(DuplicateSummary *summaries, unsigned int count)
+{
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        LogRepeated(summaries[i].callSite, summaries[i].repeated, summaries[i].spanNs);
+    }
+}
+
+/**
+ * @brief Takes the summaries of the runs of the window
+ *
+ * @param window window of a thread
+ * @param minAgeNs minimum age of the runs to be taken
+ * @param isClearing 1 -> entries are freed (thread exit)
+ * @param summaries taken summaries (UL_DUPLICATE_MAX_WINDOW)
+ * @return unsigned int number of the summaries
+ */
+static unsigned int TakeWindowSummaries(DuplicateWindow *window,
+                                        unsigned long long minAgeNs,
+                                        unsigned char isClearing,
+                                        DuplicateSummary *summaries)
+{
+    unsigned long long now = Stats_Now();
+    unsigned int count = 0;
+    unsigned int i;
+    pthread_mutex_lock(&window->mutex);
+    for (i = 0; i < UL_DUPLICATE_MAX_WINDOW; i++)
+    {
+        DuplicateEntry *entry = &window->entries[i];
+        if (entry->callSite && entry->repeated && now - entry->runStartNs >= minAgeNs)
+        {
+            TakeSummary(entry, &summaries[count++]);
+        }
+        if (isClearing)
+        {
+            entry->callSite = NULL;
+        }
+    }
+    pthread_mutex_unlock(&window->mutex);
+    return count;
+}
+
+/**
+ * @brief Writes the runs and releases the window of the exiting thread for reuse
+ *
+ * @param window window of the thread
+ */
+static void ReleaseWindow(void *window)
+{
+    DuplicateSummary summaries[UL_DUPLICATE_MAX_WINDOW];
+    WriteSummaries(summaries, TakeWindowSummaries((DuplicateWindow *)window, 0, 1, summaries));
+    atomic_store_explicit(&((DuplicateWindow *)window)->isOwned, 0, memory_order_release);
+}
+
+/**
+ * @brief Gets the window of the calling thread, reuses windows of exited threads
+ *
+ * @return DuplicateWindow* window of the thread, NULL on allocation failure
+ */
+static DuplicateWindow *GetWindow()
+{
+    unsigned int generation = atomic_load_explicit(&s_generation, memory_order_acquire);
+    if (t_window && t_generation == generation)
+    {
+        return t_window;
+    }
+
+    DuplicateWindow *window;
+    for (window = atomic_load_explicit(&s_windows, memory_order_acquire); window; window = window->next)
+    {
+        int isOwned = 0;
+        if (atomic_compare_exchange_strong_explicit(&window->isOwned, &isOwned, 1,
+                                                    memory_order_acquire, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (NULL == window)
+    {
+        window = (DuplicateWindow *)calloc(1, sizeof(DuplicateWindow));
+        if (NULL == window)
+        {
+            return NULL;
+        }
+        pthread_mutex_init(&window->mutex, NULL);
+        atomic_init(&window->isOwned, 1);
+
+        pthread_mutex_lock(&s_registryMutex);
+        window->next = atomic_load_explicit(&s_windows, memory_order_relaxed);
+        atomic_store_explicit(&s_windows, window, memory_order_release);
+        pthread_mutex_unlock(&s_registryMutex);
+    }
+
+    pthread_setspecific(s_windowKey, window);
+    t_window = window;
+    t_generation = generation;
+    return window;
+}
+
+/**
+ * @brief Hash of the call site and the message (FNV-1a)
+ *
+ * @param callSite call site of the record
+ * @param message formatted message
+ * @param length length of the message
+ * @return uint64_t hash
+ */
+static uint64_t HashRecord(const UniLoggerCallSite *callSite, const char *message, size_t length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char)message[i]) * 1099511628211ULL;
+    }
+
+    // Call sites without descriptor are identified by level, tag and line
+    hash = (hash ^ (uint64_t)callSite->level) * 1099511628211ULL;
+    hash = (hash ^ (uint64_t)callSite->lineNum) * 1099511628211ULL;
+    if (callSite->id)
+    {
+        hash = (hash ^ (uint64_t)(uintptr_t)callSite) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Checks the entry is of the call site
+ */
+static inline unsigned char IsSameCallSite(const DuplicateEntry *entry, const UniLoggerCallSite *callSite)
+{
+    if (callSite->id)
+    {
+        return entry->callSite == callSite;
+    }
+    return entry->callSite == &entry->site && entry->site.level == callSite->level &&
+           entry->site.lineNum == callSite->lineNum && 0 == strcmp(entry->logTag, callSite->logTag);
+}
+
+/**
+ * @brief Flush thread, writes the runs of the threads which stopped logging
+ */
+static void *DuplicateFlushThread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_wakeMutex);
+    while (!atomic_load(&s_isStopping))
+    {
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += (time_t)(s_flushIntervalNs / 1000000000ULL);
+        timeout.tv_nsec += (long)(s_flushIntervalNs % 1000000000ULL);
+        if (timeout.tv_nsec >= 1000000000L)
+        {
+            timeout.tv_sec++;
+            timeout.tv_nsec -= 1000000000L;
+        }
+
+        if (ETIMEDOUT == pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout) &&
+            !atomic_load(&s_isStopping))
+        {
+            pthread_mutex_unlock(&s_wakeMutex);
+            DuplicateWindow *window;
+            for (window = atomic_load_explicit(&s_windows, memory_order_acquire); window; window = window->next)
+            {
+                DuplicateSummary summaries[UL_DUPLICATE_MAX_WINDOW];
+                WriteSummaries(summaries, TakeWindowSummaries(window, s_flushIntervalNs, 0, summaries));
+            }
+            pthread_mutex_lock(&s_wakeMutex);
+        }
+    }
+    pthread_mutex_unlock(&s_wakeMutex);
+    return NULL;
+}
+
+int Duplicate_Start(unsigned int windowSize, unsigned int flushInterval)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    if (0 != pthread_key_create(&s_windowKey, ReleaseWindow))
+    {
+        return -1;
+    }
+
+    s_windowSize = (windowSize > UL_DUPLICATE_MAX_WINDOW) ? UL_DUPLICATE_MAX_WINDOW : windowSize;
+    s_flushIntervalNs = (unsigned long long)flushInterval * 1000000ULL;
+    atomic_store(&s_windows, NULL);
+    atomic_store(&s_isStopping, 0);
+    atomic_fetch_add(&s_generation, 1);
+
+    if (0 != pthread_create(&s_flushThread, NULL, DuplicateFlushThread, NULL))
+    {
+        pthread_key_delete(s_windowKey);
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char Duplicate_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+unsigned char Duplicate_IsRepeated(const UniLoggerCallSite *callSite, va_list args, const char *format)
+{
+    DuplicateWindow *window = GetWindow();
+    if (NULL == window)
+    {
+        return 0;
+    }
+
+    // Longer messages are not compared, written as they are
+    int written = vsnprintf(t_messageBuffer, sizeof(t_messageBuffer), format, args);
+    if (written < 0 || (size_t)written >= sizeof(t_messageBuffer))
+    {
+        return 0;
+    }
+    size_t length = (size_t)written;
+    uint64_t hash = HashRecord(callSite, t_messageBuffer, length);
+    unsigned long long now = Stats_Now();
+
+    DuplicateSummary summaries[UL_DUPLICATE_MAX_WINDOW];
+    unsigned int count = 0;
+    DuplicateEntry *victim = NULL;
+    unsigned int i;
+
+    pthread_mutex_lock(&window->mutex);
+    window->uses++;
+    for (i = 0; i < s_windowSize; i++)
+    {
+        DuplicateEntry *entry = &window->entries[i];
+        if (entry->callSite && entry->hash == hash && entry->length == length && IsSameCallSite(entry, callSite))
+        {
+            // Repeat, written with the summary of the run
+            entry->repeated++;
+            entry->lastNs = now;
+            entry->lastUse = window->uses;
+            if (now - entry->runStartNs >= s_flushIntervalNs)
+            {
+                TakeSummary(entry, &summaries[count++]);
+            }
+            pthread_mutex_unlock(&window->mutex);
+            WriteSummaries(summaries, count);
+            return 1;
+        }
+
+        if (NULL == victim || NULL == entry->callSite ||
+            (victim->callSite && entry->lastUse < victim->lastUse))
+        {
+            victim = entry;
+        }
+    }
+
+    // Run of the least recently used record has ended
+    if (victim->callSite && victim->repeated)
+    {
+        TakeSummary(victim, &summaries[count++]);
+    }
+    if (__atomic_load_n(&callSite->id, __ATOMIC_ACQUIRE))
+    {
+        victim->callSite = callSite;
+    }
+    else
+    {
+        // Descriptor of UniLogger_CustomLogFn() is on the stack of the caller
+        victim->site = *callSite;
+        victim->site.prefix = NULL;
+        victim->site.prefixLength = 0;
+        victim->site.next = NULL;
+        snprintf(victim->logTag, sizeof(victim->logTag), "%s", callSite->logTag ? callSite->logTag : "");
+        victim->site.logTag = victim->logTag;
+        victim->callSite = &victim->site;
+    }
+    victim->hash = hash;
+    victim->length = length;
+    victim->repeated = 0;
+    victim->runStartNs = now;
+    victim->lastNs = now;
+    victim->lastUse = window->uses;
+    pthread_mutex_unlock(&window->mutex);
+
+    // Summary of the ended run is written before the new record
+    WriteSummaries(summaries, count);
+    return 0;
+}
+
+void Duplicate_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    DuplicateWindow *window;
+    for (window = atomic_load_explicit(&s_windows, memory_order_acquire); window; window = window->next)
+    {
+        DuplicateSummary summaries[UL_DUPLICATE_MAX_WINDOW];
+        WriteSummaries(summaries, TakeWindowSummaries(window, 0, 0, summaries));
+    }
+}
+
+void Duplicate_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    atomic_store(&s_isStopping, 1);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+    pthread_join(s_flushThread, NULL);
+
+    // Remaining runs are written before the windows are freed
+    Duplicate_Flush();
+    atomic_store(&s_isRunning, 0);
+
+    // Windows of the live threads are invalidated by the generation
+    pthread_key_delete(s_windowKey);
+    DuplicateWindow *window = atomic_load(&s_windows);
+    atomic_store(&s_windows, NULL);
+    while (window)
+    {
+        DuplicateWindow *next = window->next;
+        pthread_mutex_destroy(&window->mutex);
+        free(window);
+        window = next;
+    }
+}
@@ -0,0 +1,318 @@
+/**
+ * @file UniLoggerFlightRecorder.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Flight recorder of UniLogger, in-memory ring of the recent logs
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Logs of the recorder level are formatted into a fixed size ring shared by
+ * all the threads, the oldest record is overwritten. Nothing is written to
+ * the stream till the ring is dumped (LOG_FATAL(), explicit dump or crash
+ * signal). Every slot is a sequence lock: a writer claims the slot by
+ * changing the sequence of an older record to UL_RECORDER_WRITING and
+ * sets it to position + 1 when the record is complete. A slot still written
+ * by a slower writer or holding a newer record is not claimed, the record
+ * is skipped. The dump skips
+ * the records changed while copying them. Dumping only copies memory and
+ * writes, so it can run in a signal handler.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Sequence of the slot while its record is written
+ */
+#define UL_RECORDER_WRITING ((size_t)-1)
+
+/**
+ * @brief Record slot of the ring
+ */
+typedef struct RecorderSlot
+{
+    // Position + 1 of the complete record, UL_RECORDER_WRITING while the record is written
+    atomic_size_t sequence;
+    // Length of the formatted record
+    size_t length;
+    // Formatted record
+    char data[UL_MAX_RECORD_SIZE];
+} RecorderSlot;
+
+// Level mask of the flight recorder, 0 if not running
+unsigned int gRecorderLevelMask = 0;
+
+// Slots of the ring
+static RecorderSlot *s_slots = NULL;
+// Mask for the position in ring (capacity - 1)
+static size_t s_mask = 0;
+// Position of the next record
+static atomic_size_t s_head;
+// Position till which the records are dumped
+static size_t s_dumpedPos = 0;
+
+// Flag to check recorder is running
+static atomic_int s_isRunning;
+// Number of the pushes and dumps using the slots
+static atomic_int s_activeUsers;
+// Flag to check a dump is in progress
+static atomic_int s_isDumping;
+// Copy of the record being dumped
+static char s_dumpBuffer[UL_MAX_RECORD_SIZE];
+
+// Crash signals dumping the ring
+static const int s_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+#define UL_RECORDER_SIGNAL_COUNT (sizeof(s_signals) / sizeof(s_signals[0]))
+// Handlers of the signals before the recorder
+static struct sigaction s_oldActions[UL_RECORDER_SIGNAL_COUNT];
+
+/**
+ * @brief Markers around the dumped records
+ */
+static const char s_beginMarker[] = "===== Flight Recorder begin =====\n";
+static const char s_endMarker[] = "===== Flight Recorder end =====\n";
+
+/**
+ * @brief Writes the record from the signal handler (only async-signal-safe calls)
+ *
+ * @param data formatted record
+ * @param length length of the record
+ */
+static void WriteFromSignal(const char *data, size_t length)
+{
+    if (MmapSink_IsRunning())
+    {
+        MmapSink_Write(data, length);
+        return;
+    }
+
+    if (SocketSink_IsRunning())
+    {
+        SocketSink_WriteFromSignal(data, length);
+        return;
+    }
+
+    if (CompressSink_IsRunning())
+    {
+        CompressSink_WriteFromSignal(data, length);
+        return;
+    }
+
+    // Buffered logs of the stream can not be flushed from the signal handler
+    int fd = fileno(gCurrLogStream ? gCurrLogStream : stdout);
+    while (length)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Handler of the crash signals, dumps the ring and raises the signal again
+ */
+static void SignalHandler(int signum)
+{
+    int savedErrno = errno;
+    FlightRecorder_Dump(WriteFromSignal);
+
+    // Previous handler (or the default action) handles the signal
+    size_t i;
+    for (i = 0; i < UL_RECORDER_SIGNAL_COUNT; i++)
+    {
+        if (s_signals[i] == signum)
+        {
+            sigaction(signum, &s_oldActions[i], NULL);
+        }
+    }
+    errno = savedErrno;
+    raise(signum);
+}
+
+int FlightRecorder_Start(unsigned int size)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    // Capacity must be power of 2
+    size_t capacity = 2;
+    while (capacity < size)
+    {
+        capacity <<= 1;
+    }
+
+    s_slots = (RecorderSlot *)calloc(capacity, sizeof(RecorderSlot));
+    if (NULL == s_slots)
+    {
+        return -1;
+    }
+    s_mask = capacity - 1;
+    s_dumpedPos = 0;
+    atomic_store(&s_head, 0);
+    atomic_store(&s_isDumping, 0);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SignalHandler;
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    size_t i;
+    for (i = 0; i < UL_RECORDER_SIGNAL_COUNT; i++)
+    {
+        sigaction(s_signals[i], &action, &s_oldActions[i]);
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char FlightRecorder_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+/**
+ * @brief Marks the slots used till the matching ReleaseSlots()
+ *
+ * @return unsigned char 1 -> slots can be used, 0 -> recorder is stopped
+ */
+static unsigned char AcquireSlots()
+{
+    // Seen by FlightRecorder_Stop() before it checks the users
+    atomic_fetch_add(&s_activeUsers, 1);
+    if (!atomic_load(&s_isRunning))
+    {
+        atomic_fetch_sub(&s_activeUsers, 1);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Ends the use of the slots started by AcquireSlots()
+ */
+static void ReleaseSlots()
+{
+    atomic_fetch_sub_explicit(&s_activeUsers, 1, memory_order_release);
+}
+
+void FlightRecorder_Push(const UniLoggerCallSite *callSite, va_list args, const char *format)
+{
+    if (!AcquireSlots())
+    {
+        return;
+    }
+
+    size_t pos = atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed);
+    RecorderSlot *slot = &s_slots[pos & s_mask];
+
+    // Any complete record of an older lap is overwritten, a slot being written or holding a newer record is not
+    size_t expected = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    if (UL_RECORDER_WRITING == expected || expected >= pos + 1 ||
+        !atomic_compare_exchange_strong_explicit(&slot->sequence, &expected, UL_RECORDER_WRITING,
+                                                 memory_order_relaxed, memory_order_relaxed))
+    {
+        ReleaseSlots();
+        return;
+    }
+    // Invalidate the slot before overwriting the old record
+    atomic_thread_fence(memory_order_release);
+
+    slot->length = FormatTextRecord(slot->data, sizeof(slot->data), callSite, args, format);
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    ReleaseSlots();
+}
+
+void FlightRecorder_Dump(void (*writeFn)(const char *data, size_t length))
+{
+    if (!AcquireSlots())
+    {
+        return;
+    }
+    if (atomic_exchange(&s_isDumping, 1))
+    {
+        ReleaseSlots();
+        return;
+    }
+
+    // Records after the last dump, which are still in the ring
+    size_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    size_t capacity = s_mask + 1;
+    size_t pos = head > capacity ? head - capacity : 0;
+    if (pos < s_dumpedPos)
+    {
+        pos = s_dumpedPos;
+    }
+
+    writeFn(s_beginMarker, sizeof(s_beginMarker) - 1);
+    for (; pos < head; pos++)
+    {
+        RecorderSlot *slot = &s_slots[pos & s_mask];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1)
+        {
+            // Overwritten or still being written
+            continue;
+        }
+
+        size_t length = slot->length;
+        if (length > sizeof(s_dumpBuffer))
+        {
+            continue;
+        }
+        memcpy(s_dumpBuffer, slot->data, length);
+
+        // Record is valid only if it is not changed while copying
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != pos + 1)
+        {
+            continue;
+        }
+        writeFn(s_dumpBuffer, length);
+    }
+    writeFn(s_endMarker, sizeof(s_endMarker) - 1);
+
+    s_dumpedPos = head;
+    atomic_store(&s_isDumping, 0);
+    ReleaseSlots();
+}
+
+void FlightRecorder_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < UL_RECORDER_SIGNAL_COUNT; i++)
+    {
+        sigaction(s_signals[i], &s_oldActions[i], NULL);
+    }
+
+    // No new push uses the slots, the pushes in progress are waited before freeing
+    atomic_store(&s_isRunning, 0);
+    while (atomic_load(&s_activeUsers))
+    {
+        sched_yield();
+    }
+    free(s_slots);
+    s_slots = NULL;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file UniLoggerGroupCommit.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Group commit of the log writes for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every writer pushes its formatted record to a lock-free pending list and
+ * takes s_logMutex. The first writer in the critical section takes all the
+ * pending records and writes them with writev(), writers whose record is
+ * already written only release the mutex. Under contention N records are
+ * written with a single system call. Records of the index are carried with
+ * the pending record and added by the leader with the bytes of the record.
+ */
+// System Include
+#include <stdatomic.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Maximum number of records in a single writev
+ */
+#if defined(IOV_MAX) && IOV_MAX < 1024
+#define UL_GROUP_COMMIT_MAX_IOV IOV_MAX
+#else
+#define UL_GROUP_COMMIT_MAX_IOV 1024
+#endif // IOV_MAX
+
+/**
+ * @brief Record waiting to be written
+ */
+typedef struct PendingWrite
+{
+    // Next record (pushed before this record)
+    struct PendingWrite *next;
+    // Parts of the formatted record
+    const struct iovec *vectors;
+    // Number of parts
+    int count;
+    // Length of the record
+    size_t length;
+    // Records of the index written with this record
+    IndexEntry indexRecords;
+    // Flag to check the record is written, accessed under s_logMutex
+    unsigned char isWritten;
+} PendingWrite;
+
+// Records waiting to be written, latest first
+static _Atomic(PendingWrite *) s_pendingWrites = NULL;
+
+void WriteVectors(int fd, struct iovec *vectors, int count)
+{
+    while (count > 0)
+    {
+        unsigned long long start = Stats_Now();
+        ssize_t written = writev(fd, vectors, count);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            Stats_AddWrite(0, Stats_Now() - start, 1);
+            return;
+        }
+        Stats_AddWrite((size_t)written, Stats_Now() - start, 0);
+
+        // Skip the written vectors
+        while (count > 0 && (size_t)written >= vectors->iov_len)
+        {
+            written -= (ssize_t)vectors->iov_len;
+            vectors++;
+            count--;
+        }
+        if (count > 0)
+        {
+            vectors->iov_base = (char *)vectors->iov_base + written;
+            vectors->iov_len -= (size_t)written;
+        }
+    }
+}
+
+/**
+ * @brief Writes the pending records in the order they are pushed
+ *
+ * @param stream stream to write
+ * @param pending pending records, latest first
+ * @return size_t number of bytes written
+ */
+static size_t WritePending(FILE *stream, PendingWrite *pending)
+{
+    // Reverse the list to the order of the logs
+    PendingWrite *ordered = NULL;
+    while (pending)
+    {
+        PendingWrite *next = pending->next;
+        pending->next = ordered;
+        ordered = pending;
+        pending = next;
+    }
+
+    // Output of the stream is written before the records
+    fflush(stream);
+    int fd = fileno(stream);
+
+    struct iovec vectors[UL_GROUP_COMMIT_MAX_IOV];
+    size_t total = 0;
+    while (ordered)
+    {
+        PendingWrite *first = ordered;
+        int count = 0;
+        while (ordered && count + ordered->count <= UL_GROUP_COMMIT_MAX_IOV)
+        {
+            int i;
+            for (i = 0; i < ordered->count; i++)
+            {
+                vectors[count++] = ordered->vectors[i];
+                total += ordered->vectors[i].iov_len;
+            }
+            ordered->isWritten = 1;
+            ordered = ordered->next;
+        }
+        WriteVectors(fd, vectors, count);
+
+        // Offsets of the records are in the order they are written
+        if (Index_IsRunning())
+        {
+            for (; first != ordered; first = first->next)
+            {
+                Index_AddWritten(&first->indexRecords, first->length);
+            }
+        }
+    }
+    return total;
+}
+
+size_t GroupCommit_WritePending(FILE *stream)
+{
+    PendingWrite *pending = atomic_exchange_explicit(&s_pendingWrites, NULL, memory_order_acquire);
+    return WritePending(stream, pending);
+}
+
+size_t GroupCommit_Write(FILE *stream, const struct iovec *vectors, int count)
+{
+    PendingWrite record = {NULL, vectors, count, 0, {0}, 0};
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        record.length += vectors[i].iov_len;
+    }
+    if (Index_IsRunning())
+    {
+        Index_TakeRecords(&record.indexRecords);
+    }
+
+    // Publish the record for the writer holding the mutex
+    record.next = atomic_load_explicit(&s_pendingWrites, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&s_pendingWrites, &record.next, &record,
+                                                  memory_order_release, memory_order_relaxed))
+    {
+    }
+
+    size_t total = 0;
+    Stats_LockMutex(&s_logMutex);
+    if (!record.isWritten)
+    {
+        // Leader of the group, writes every pending record
+        total = GroupCommit_WritePending(stream);
+    }
+    pthread_mutex_unlock(&s_logMutex);
+    return total;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file UniLoggerIndex.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Sidecar time / level index of the log file for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Records written to the log file are grouped into blocks of K records or
+ * M bytes. For every block one fixed size entry (offset range of the file,
+ * time of the first and the last record, bitmap of the levels) is appended
+ * to "<file>.idx" when the block is closed. unilogger-query reads the
+ * entries and seeks to the blocks overlapping the time range and levels,
+ * instead of scanning the whole file.
+ *
+ * Records are added by the thread writing them (Index_AddRecord(), the
+ * writer thread for the queued records) and are put into the open block
+ * together with the bytes of their write (Index_AddBytes()), so the offset
+ * range of the block covers its records. Records written by the leader of
+ * a group commit are taken from their thread (Index_TakeRecords()) and
+ * added by the leader (Index_AddWritten()).
+ */
+// System Include
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "UniLoggerInternal.h"
+
+// Descriptor of the index file
+static int s_fd = -1;
+// Offset of the log file (bytes written)
+static atomic_ullong s_fileOffset;
+// Records in a block (0 -> no limit)
+static unsigned int s_blockRecords = 0;
+// Bytes of the log file in a block (0 -> no limit)
+static unsigned long long s_blockBytes = 0;
+// Open block
+static IndexEntry s_block;
+// Records of the thread added to the open block with the bytes of its next write
+static __thread IndexEntry t_records;
+// Mutex of the open block
+static pthread_mutex_t s_indexMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Flag to check index is running
+static atomic_int s_isRunning;
+
+/**
+ * @brief Appends the data to the index file
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int WriteIndex(const void *data, size_t length)
+{
+    const char *bytes = (const char *)data;
+    while (length)
+    {
+        ssize_t written = write(s_fd, bytes, length);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return -1;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes the entry of the open block and opens the next block
+ * Called with s_indexMutex locked
+ *
+ * @param fileOffset current offset of the log file
+ */
+static void CloseBlock(unsigned long long fileOffset)
+{
+    s_block.endOffset = fileOffset;
+    WriteIndex(&s_block, sizeof(s_block));
+
+    memset(&s_block, 0, sizeof(s_block));
+    s_block.startOffset = fileOffset;
+}
+
+int Index_Start(const char *filePath,
+                unsigned long long fileOffset,
+                unsigned int blockRecords,
+                unsigned long long blockBytes)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    char indexPath[4096 + sizeof(UL_INDEX_SUFFIX)];
+    int written = snprintf(indexPath, sizeof(indexPath), "%s" UL_INDEX_SUFFIX, filePath);
+    if (written < 0 || (size_t)written >= sizeof(indexPath))
+    {
+        return -1;
+    }
+
+    s_fd = open(indexPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (s_fd < 0)
+    {
+        return -1;
+    }
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, UL_INDEX_MAGIC, sizeof(UL_INDEX_MAGIC));
+    header.version = UL_INDEX_VERSION;
+    header.byteOrder = UL_INDEX_BYTE_ORDER;
+    if (0 != WriteIndex(&header, sizeof(header)))
+    {
+        close(s_fd);
+        s_fd = -1;
+        return -1;
+    }
+
+    s_blockRecords = blockRecords;
+    s_blockBytes = blockBytes;
+    atomic_store(&s_fileOffset, fileOffset);
+    memset(&s_block, 0, sizeof(s_block));
+    s_block.startOffset = fileOffset;
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char Index_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void Index_AddRecord(enum LogLevel level, const struct timespec *time)
+{
+    struct timespec now;
+    if (NULL == time)
+    {
+        Timestamp_Now(&now);
+        time = &now;
+    }
+    uint64_t timeNs = (uint64_t)time->tv_sec * 1000000000ULL + (uint64_t)time->tv_nsec;
+
+    // Queued records can be written out of order of their time
+    if (0 == t_records.records || timeNs < t_records.firstTime)
+    {
+        t_records.firstTime = timeNs;
+    }
+    if (timeNs > t_records.lastTime)
+    {
+        t_records.lastTime = timeNs;
+    }
+    t_records.records++;
+    t_records.levelMask |= 1u << level;
+}
+
+void Index_AddWritten(const IndexEntry *records, size_t length)
+{
+    if (0 == records->records)
+    {
+        atomic_fetch_add_explicit(&s_fileOffset, length, memory_order_relaxed);
+        return;
+    }
+
+    pthread_mutex_lock(&s_indexMutex);
+    unsigned long long fileOffset = atomic_fetch_add_explicit(&s_fileOffset, length, memory_order_relaxed) + length;
+    if (!atomic_load_explicit(&s_isRunning, memory_order_relaxed))
+    {
+        pthread_mutex_unlock(&s_indexMutex);
+        return;
+    }
+
+    if (0 == s_block.records || records->firstTime < s_block.firstTime)
+    {
+        s_block.firstTime = records->firstTime;
+    }
+    if (records->lastTime > s_block.lastTime)
+    {
+        s_block.lastTime = records->lastTime;
+    }
+    s_block.records += records->records;
+    s_block.levelMask |= records->levelMask;
+
+    if ((s_blockRecords && s_block.records >= s_blockRecords) ||
+        (s_blockBytes && fileOffset - s_block.startOffset >= s_blockBytes))
+    {
+        CloseBlock(fileOffset);
+    }
+    pthread_mutex_unlock(&s_indexMutex);
+}
+
+void Index_AddBytes(size_t length)
+{
+    Index_AddWritten(&t_records, length);
+    memset(&t_records, 0, sizeof(t_records));
+}
+
+void Index_TakeRecords(IndexEntry *records)
+{
+    *records = t_records;
+    memset(&t_records, 0, sizeof(t_records));
+}
+
+void Index_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_indexMutex);
+    if (s_block.records)
+    {
+        CloseBlock(atomic_load(&s_fileOffset));
+    }
+    atomic_store(&s_isRunning, 0);
+    close(s_fd);
+    s_fd = -1;
+    pthread_mutex_unlock(&s_indexMutex);
+}
@@ -0,0 +1,1477 @@
+/**
+ * @file UniLoggerInternal.h
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Internal declarations shared between the UniLogger sources
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __UNI_LOGGER_INTERNAL_H__
+#define __UNI_LOGGER_INTERNAL_H__
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#include <UniLogger.h>
+
+/**
+ * @brief Size of a record slot of the queues, the shared ring and the flight recorder (including newline)
+ * Longer records of the queues are formatted in an allocated buffer, the shared
+ * ring splits them in contiguous slots, longer records of the flight recorder are truncated
+ */
+#ifndef UL_MAX_RECORD_SIZE
+#define UL_MAX_RECORD_SIZE 512
+#endif // UL_MAX_RECORD_SIZE
+
+/**
+ * @brief Size of the thread local buffer for formatting the logs
+ * Longer logs are formatted in an allocated buffer
+ */
+#ifndef UL_STAGING_BUFFER_SIZE
+#define UL_STAGING_BUFFER_SIZE 4096
+#endif // UL_STAGING_BUFFER_SIZE
+
+/**
+ * @brief Size of the batch written with a single write by the asynchronous writer
+ */
+#ifndef UL_ASYNC_BATCH_SIZE
+#define UL_ASYNC_BATCH_SIZE (64 * 1024)
+#endif // UL_ASYNC_BATCH_SIZE
+
+/**
+ * @brief Address space mapped for the memory mapped log file
+ * Records after the mapping are written with pwrite
+ */
+#ifndef UL_MMAP_MAP_SIZE
+#define UL_MMAP_MAP_SIZE ((size_t)1 << (sizeof(void *) == 8 ? 32 : 28))
+#endif // UL_MMAP_MAP_SIZE
+
+/**
+ * @brief Size by which the memory mapped log file is preallocated
+ */
+#ifndef UL_MMAP_CHUNK_SIZE
+#define UL_MMAP_CHUNK_SIZE (8 * 1024 * 1024)
+#endif // UL_MMAP_CHUNK_SIZE
+
+/**
+ * @brief Interval of the memory mapped sink thread (preallocation) and of msync in milliseconds
+ */
+#define UL_MMAP_TICK_MS 10
+#define UL_MMAP_SYNC_INTERVAL_MS 1000
+
+/**
+ * @brief Maximum number of log tags with their own log level
+ */
+#ifndef UL_MAX_TAG_LEVELS
+#define UL_MAX_TAG_LEVELS 256
+#endif // UL_MAX_TAG_LEVELS
+
+/**
+ * @brief Number of the tags cached by every thread for the logs without call site descriptor
+ */
+#ifndef UL_TAG_CACHE_SIZE
+#define UL_TAG_CACHE_SIZE 16
+#endif // UL_TAG_CACHE_SIZE
+
+/**
+ * @brief Maximum number of sinks added with UniLogger_Add*Sink()
+ */
+#ifndef UL_MAX_SINKS
+#define UL_MAX_SINKS 8
+#endif // UL_MAX_SINKS
+
+/**
+ * @brief Maximum number of profile scopes (LOG_PROFILE_SCOPE())
+ */
+#ifndef UL_MAX_PROFILE_SCOPES
+#define UL_MAX_PROFILE_SCOPES 256
+#endif // UL_MAX_PROFILE_SCOPES
+
+/**
+ * @brief Maximum number of call sites with cost counters, later call sites are counted as untracked
+ */
+#ifndef UL_MAX_CALL_SITE_STATS
+#define UL_MAX_CALL_SITE_STATS 4096
+#endif // UL_MAX_CALL_SITE_STATS
+
+/**
+ * @brief Default number of call sites written by UniLogger_DumpCallSiteStats()
+ */
+#ifndef UL_CALL_SITE_STATS_DEFAULT_TOP
+#define UL_CALL_SITE_STATS_DEFAULT_TOP 20
+#endif // UL_CALL_SITE_STATS_DEFAULT_TOP
+
+/**
+ * @brief Sub buckets per power of 2 in the profile histograms (2^bits, ~3% precision for 5)
+ */
+#define UL_PROFILE_SUB_BUCKET_BITS 5
+#define UL_PROFILE_SUB_BUCKETS (1u << UL_PROFILE_SUB_BUCKET_BITS)
+#define UL_PROFILE_BUCKETS ((64 - UL_PROFILE_SUB_BUCKET_BITS + 1) * UL_PROFILE_SUB_BUCKETS)
+
+/**
+ * @brief Default number of records in the flight recorder ring
+ */
+#ifndef UL_FLIGHT_RECORDER_DEFAULT_SIZE
+#define UL_FLIGHT_RECORDER_DEFAULT_SIZE 1024
+#endif // UL_FLIGHT_RECORDER_DEFAULT_SIZE
+
+/**
+ * @brief Shift of the stream levels in the published level masks
+ * Published masks (gCurrLogLevelMask, masks of the tags) enable the levels
+ * written to the stream and the levels kept by the flight recorder. Levels
+ * written to the stream are repeated above this shift.
+ */
+#define UL_STREAM_MASK_SHIFT 16
+
+/**
+ * @brief Maximum number of bytes added by the color codes to a record
+ */
+#define UL_MAX_COLOR_SIZE 16
+
+/**
+ * @brief Number of shards of the statistics counters
+ */
+#ifndef UL_STATS_SHARDS
+#define UL_STATS_SHARDS 16
+#endif // UL_STATS_SHARDS
+
+/**
+ * @brief Default number of records in the asynchronous queue
+ */
+#ifndef UL_ASYNC_DEFAULT_QUEUE_SIZE
+#define UL_ASYNC_DEFAULT_QUEUE_SIZE 1024
+#endif // UL_ASYNC_DEFAULT_QUEUE_SIZE
+
+/**
+ * @brief Default number of records in each per-thread buffer
+ */
+#ifndef UL_THREAD_BUFFER_DEFAULT_SIZE
+#define UL_THREAD_BUFFER_DEFAULT_SIZE 256
+#endif // UL_THREAD_BUFFER_DEFAULT_SIZE
+
+/**
+ * @brief Size of the buffer for formatted timestamp
+ */
+#define UL_TIMESTAMP_SIZE 32
+
+/**
+ * @brief Binary records
+ * Every record starts with UL_BINARY_MARKER and the record type,
+ * values are in the byte order of the writer
+ *
+ * Header : marker, type, UL_BINARY_MAGIC, u8 version, u32 UL_BINARY_BYTE_ORDER
+ * String : marker, type, u64 id, u16 length, characters
+ * Log    : marker, type, u8 level, u16 argLength, u32 line, u64 time (ns),
+ *          u64 format id, u64 tag id, arguments
+ *
+ * Arguments are in the order of the format, i64 for integers, f64 for
+ * floating point, u64 for pointers, u16 length and characters for strings,
+ * i32 for '*' width and precision.
+ */
+#define UL_BINARY_MARKER 0x1E
+#define UL_BINARY_MAGIC "ULOGBIN"
+#define UL_BINARY_VERSION 1
+#define UL_BINARY_BYTE_ORDER 0x01020304
+#define UL_BINARY_HEADER 0
+#define UL_BINARY_STRING 1
+#define UL_BINARY_LOG 2
+
+/**
+ * @brief Sidecar index of the log file ("<file>.idx")
+ * Values are in the byte order of the writer
+ *
+ * Header : UL_INDEX_MAGIC, u32 version, u32 UL_INDEX_BYTE_ORDER
+ * Entries: IndexEntry of every closed block of records
+ */
+#define UL_INDEX_MAGIC "ULOGIDX"
+#define UL_INDEX_VERSION 1
+#define UL_INDEX_BYTE_ORDER 0x01020304
+#define UL_INDEX_SUFFIX ".idx"
+
+/**
+ * @brief Header of the index file
+ */
+typedef struct IndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+} IndexHeader;
+
+/**
+ * @brief Block of records in the index file
+ * Records of the block are written between startOffset and endOffset. With
+ * the memory mapped sink, records written concurrently can end after endOffset.
+ */
+typedef struct IndexEntry
+{
+    // Offset of the log file when the block is opened
+    uint64_t startOffset;
+    // Offset of the log file when the block is closed
+    uint64_t endOffset;
+    // Time of the first and the last record in ns since epoch
+    uint64_t firstTime;
+    uint64_t lastTime;
+    // Number of records
+    uint32_t records;
+    // Levels of the records (bit per LogLevel)
+    uint32_t levelMask;
+} IndexEntry;
+
+/**
+ * @brief Shared memory ring of the processes (shm_open, drained by unilogger-collector)
+ * Header is followed by the slots, values are in the byte order of the host
+ */
+#define UL_SHARED_MAGIC "ULOGSHM"
+#define UL_SHARED_VERSION 2
+
+/**
+ * @brief Default number of records in the shared memory ring
+ */
+#ifndef UL_SHARED_DEFAULT_SIZE
+#define UL_SHARED_DEFAULT_SIZE 4096
+#endif // UL_SHARED_DEFAULT_SIZE
+
+/**
+ * @brief Time a process waits for a free slot before dropping the record (collector is down)
+ */
+#ifndef UL_SHARED_WAIT_MS
+#define UL_SHARED_WAIT_MS 10
+#endif // UL_SHARED_WAIT_MS
+
+/**
+ * @brief Time after which a claimed slot is skipped by the collector (process died while writing it)
+ */
+#ifndef UL_SHARED_STALL_MS
+#define UL_SHARED_STALL_MS 1000
+#endif // UL_SHARED_STALL_MS
+
+/**
+ * @brief Default address of the socket Log Stream
+ */
+#ifndef UL_SOCKET_DEFAULT_ADDRESS
+#define UL_SOCKET_DEFAULT_ADDRESS "unix:/tmp/unilogger.sock"
+#endif // UL_SOCKET_DEFAULT_ADDRESS
+
+/**
+ * @brief Default size of the pending buffer of the socket (bytes), records beyond it are dropped
+ */
+#ifndef UL_SOCKET_DEFAULT_BUFFER_SIZE
+#define UL_SOCKET_DEFAULT_BUFFER_SIZE (1024 * 1024)
+#endif // UL_SOCKET_DEFAULT_BUFFER_SIZE
+
+/**
+ * @brief Maximum number of datagrams sent with one sendmmsg()
+ */
+#ifndef UL_SOCKET_BATCH_SIZE
+#define UL_SOCKET_BATCH_SIZE 64
+#endif // UL_SOCKET_BATCH_SIZE
+
+/**
+ * @brief Maximum number of binary strings kept by the socket, sent again at every connection
+ */
+#ifndef UL_SOCKET_MAX_STRINGS
+#define UL_SOCKET_MAX_STRINGS 4096
+#endif // UL_SOCKET_MAX_STRINGS
+
+/**
+ * @brief Delays of the reconnect, doubled after every failure
+ */
+#define UL_SOCKET_RETRY_MIN_MS 100
+#define UL_SOCKET_RETRY_MAX_MS 5000
+
+/**
+ * @brief Time a send may block on a collector which stopped reading
+ */
+#define UL_SOCKET_SEND_TIMEOUT_MS 1000
+
+/**
+ * @brief Maximum time UniLogger_Flush() waits for the records to be sent
+ */
+#define UL_SOCKET_FLUSH_MS 1000
+
+/**
+ * @brief Default uncompressed size of a block of the compressed log file (bytes)
+ */
+#ifndef UL_COMPRESS_DEFAULT_BLOCK_SIZE
+#define UL_COMPRESS_DEFAULT_BLOCK_SIZE (256 * 1024)
+#endif // UL_COMPRESS_DEFAULT_BLOCK_SIZE
+
+/**
+ * @brief Maximum uncompressed size of a block of the compressed log file (bytes)
+ */
+#define UL_COMPRESS_MAX_BLOCK_SIZE (64 * 1024 * 1024)
+
+/**
+ * @brief Default time after which a partly filled block is compressed (milliseconds)
+ */
+#ifndef UL_COMPRESS_DEFAULT_FLUSH_MS
+#define UL_COMPRESS_DEFAULT_FLUSH_MS 1000
+#endif // UL_COMPRESS_DEFAULT_FLUSH_MS
+
+/**
+ * @brief Compression levels of the log file blocks
+ */
+#ifndef UL_COMPRESS_GZIP_LEVEL
+#define UL_COMPRESS_GZIP_LEVEL 6
+#endif // UL_COMPRESS_GZIP_LEVEL
+#ifndef UL_COMPRESS_LZ4_LEVEL
+#define UL_COMPRESS_LZ4_LEVEL 0
+#endif // UL_COMPRESS_LZ4_LEVEL
+#ifndef UL_COMPRESS_ZSTD_LEVEL
+#define UL_COMPRESS_ZSTD_LEVEL 3
+#endif // UL_COMPRESS_ZSTD_LEVEL
+
+/**
+ * @brief Default and maximum number of recent records compared per thread for the repeats
+ */
+#define UL_DUPLICATE_DEFAULT_WINDOW 4
+#define UL_DUPLICATE_MAX_WINDOW 16
+
+/**
+ * @brief Default time after which the repeats of a record are written (milliseconds)
+ */
+#ifndef UL_DUPLICATE_DEFAULT_FLUSH_MS
+#define UL_DUPLICATE_DEFAULT_FLUSH_MS 1000
+#endif // UL_DUPLICATE_DEFAULT_FLUSH_MS
+
+/**
+ * @brief Time after which the logs suppressed by a rate limit are reported without a written log (milliseconds)
+ */
+#ifndef UL_RATE_LIMIT_REPORT_MS
+#define UL_RATE_LIMIT_REPORT_MS 10000
+#endif // UL_RATE_LIMIT_REPORT_MS
+
+/**
+ * @brief Size of the copied tag of the records without call site descriptor
+ */
+#define UL_DUPLICATE_TAG_SIZE 64
+
+/**
+ * @brief Header of the shared memory ring
+ * Positions are updated with the __atomic builtins by all the processes
+ */
+typedef struct SharedRingHeader
+{
+    // UL_SHARED_MAGIC
+    char magic[8];
+    uint32_t version;
+    // Number of slots (power of 2)
+    uint32_t slotCount;
+    // Size of a slot (sizeof(SharedRingSlot) of the creator)
+    uint32_t slotSize;
+    // 0 -> being initalized by the creator, 1 -> ready
+    uint32_t state;
+    // Records dropped by the processes (ring full or slot skipped by the collector)
+    uint64_t dropped;
+    // Dropped records already reported by the collectors
+    uint64_t droppedReported;
+    // Set by the collector before waiting on wakeSequence
+    uint32_t isCollectorIdle;
+    // Futex word to wake the collector
+    uint32_t wakeSequence;
+    // Position of the next slot claimed by the processes
+    uint64_t enqueuePos __attribute__((aligned(64)));
+    // Position of the next slot taken by the collector
+    uint64_t dequeuePos __attribute__((aligned(64)));
+} __attribute__((aligned(64))) SharedRingHeader;
+
+/**
+ * @brief Record slot of the shared memory ring
+ */
+typedef struct SharedRingSlot
+{
+    // Sequence number of the slot, (pos) -> free, (pos + 1) -> ready
+    uint64_t sequence;
+    // Time of the record in ns since epoch (order of the collector)
+    uint64_t time;
+    // Length of the formatted record
+    uint32_t length;
+    // Process of the record
+    uint32_t pid;
+    // Part of the record in the slot, records longer than a slot are split in contiguous slots
+    uint16_t partIndex;
+    uint16_t partCount;
+    // Formatted record (part)
+    char data[UL_MAX_RECORD_SIZE];
+} SharedRingSlot;
+
+/**
+ * @brief Type of argument for a conversion in format
+ */
+typedef enum BinaryArgType
+{
+    BINARY_ARG_NONE,
+    BINARY_ARG_INT,
+    BINARY_ARG_DOUBLE,
+    BINARY_ARG_STRING,
+    BINARY_ARG_POINTER,
+    BINARY_ARG_COUNT
+} BinaryArgType;
+
+/**
+ * @brief Length modifier of a conversion in format
+ */
+typedef enum BinaryModifier
+{
+    BINARY_MODIFIER_NONE,
+    BINARY_MODIFIER_CHAR,
+    BINARY_MODIFIER_SHORT,
+    BINARY_MODIFIER_LONG,
+    BINARY_MODIFIER_LONG_LONG,
+    BINARY_MODIFIER_INTMAX,
+    BINARY_MODIFIER_SIZE,
+    BINARY_MODIFIER_PTRDIFF,
+    BINARY_MODIFIER_LONG_DOUBLE
+} BinaryModifier;
+
+/**
+ * @brief Conversion specification in format
+ */
+typedef struct BinarySpec
+{
+    // Start of the conversion ('%')
+    const char *start;
+    // Length of the conversion
+    size_t length;
+    // Number of '*' width / precision arguments
+    unsigned int starCount;
+    // Precision, -1 if not given, -2 if given by the argument ('*')
+    int precision;
+    // Length modifier
+    BinaryModifier modifier;
+    // Type of the argument
+    BinaryArgType type;
+    // Conversion character, '\0' for invalid conversion
+    char conversion;
+} BinarySpec;
+
+// Current Log Encoding
+extern enum LogEncoding gCurrLogEncoding;
+
+// Current Log Stream
+extern FILE *gCurrLogStream;
+
+// Flag to Check is Log File Initalized
+extern unsigned char gIsLogFileInitalized;
+
+// Flag to Check is Socket Log Stream Initalized
+extern unsigned char gIsLogSocketInitalized;
+
+/**
+ * @brief Checks if the Log Stream is written without color codes (log file or socket)
+ */
+static inline unsigned char IsLogStreamPlain()
+{
+    return gIsLogFileInitalized || gIsLogSocketInitalized;
+}
+
+// Mutex for log handler
+extern pthread_mutex_t s_logMutex;
+
+// Flag to check mutex initalized
+extern unsigned char gIsMutexInitalized;
+
+/**
+ * @brief Log level names
+ */
+extern const char logLevelNames[LOG_MAX_LEVEL][10];
+
+/**
+ * @brief Color Codes for Different Log Levels
+ */
+extern const char colorCodes[LOG_MAX_LEVEL][10];
+
+/**
+ * @brief Formats a complete log line (prefix, message and newline) into buffer
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param isSavingToFile flag to remove the color codes
+ * @param args args of the print
+ * @param format format of the print
+ * @return size_t number of bytes written (always ends with a newline)
+ */
+size_t FormatLogRecord(char *buffer,
+                       size_t bufferSize,
+                       const UniLoggerCallSite *callSite,
+                       unsigned char isSavingToFile,
+                       va_list args,
+                       const char *format);
+
+/**
+ * @brief Formats a complete text log line without color codes, for any encoding
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ * @return size_t number of bytes written (always ends with a newline)
+ */
+size_t FormatTextRecord(char *buffer,
+                        size_t bufferSize,
+                        const UniLoggerCallSite *callSite,
+                        va_list args,
+                        const char *format);
+
+/**
+ * @brief Formats a log line without color codes into the slot of a queue
+ * Records longer than the slot are formatted into an allocated buffer
+ *
+ * @param buffer buffer of the slot
+ * @param bufferSize size of the buffer of the slot
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ * @param encoding encoding of the log
+ * @param overflow allocated record (freed by the caller), NULL if the record is in the slot
+ * @return size_t number of bytes written
+ */
+size_t FormatQueuedRecord(char *buffer,
+                          size_t bufferSize,
+                          const UniLoggerCallSite *callSite,
+                          va_list args,
+                          const char *format,
+                          enum LogEncoding encoding,
+                          char **overflow);
+
+/**
+ * @brief Writes the formatted logs to the stream
+ * Logs of the current stream are group committed (GroupCommit_Write()),
+ * memory mapped log file is written without any system call
+ *
+ * @param stream stream to write
+ * @param data formatted logs
+ * @param length length of the logs
+ */
+void WriteLogData(FILE *stream, const char *data, size_t length);
+
+/**
+ * @brief Writes the formatted log in parts (color codes and record) to the stream
+ *
+ * @param stream stream to write
+ * @param vectors parts of the log
+ * @param count number of parts
+ */
+void WriteLogVectors(FILE *stream, const struct iovec *vectors, int count);
+
+/**
+ * @brief Writes the record together with the records pending from other threads
+ * First thread holding s_logMutex writes all the pending records with writev,
+ * the records of the index are added with the bytes of every record
+ *
+ * @param stream stream to write
+ * @param vectors parts of the record (must be valid till the function returns)
+ * @param count number of parts
+ * @return size_t number of bytes written by this thread (0 if written by other thread)
+ */
+size_t GroupCommit_Write(FILE *stream, const struct iovec *vectors, int count);
+
+/**
+ * @brief Writes the records pushed by the threads waiting for s_logMutex
+ * Must be called with s_logMutex
+ *
+ * @param stream stream to write
+ * @return size_t number of bytes written
+ */
+size_t GroupCommit_WritePending(FILE *stream);
+
+/**
+ * @brief Writes all the vectors, continuing after partial writes
+ *
+ * @param fd descriptor to write
+ * @param vectors data to write (modified for partial writes)
+ * @param count number of vectors
+ */
+void WriteVectors(int fd, struct iovec *vectors, int count);
+
+/**
+ * @brief Text record formatted once for the stream and all the sinks
+ * The record is formatted without color codes, the color codes of the
+ * level are written around it by the colored sinks.
+ */
+typedef struct LogRecord
+{
+    // Formatted record without color codes, ends with a newline
+    const char *data;
+    // Length of the record
+    size_t length;
+    // Log level of the record, LOG_LEVEL_OFF for binary and structured records
+    enum LogLevel level;
+} LogRecord;
+
+/**
+ * @brief Gets the parts of the colored record (color, record, reset and newline)
+ *
+ * @param record formatted record
+ * @param vectors parts of the colored record
+ * @return int number of parts
+ */
+int LogRecord_ColoredVectors(const LogRecord *record, struct iovec vectors[3]);
+
+/**
+ * @brief Copies the record (with color codes if colored) to the buffer
+ *
+ * @param buffer destination buffer of record length + UL_MAX_COLOR_SIZE bytes
+ * @param record formatted record
+ * @param isColored flag to add the color codes
+ * @return size_t number of bytes copied
+ */
+size_t LogRecord_Copy(char *buffer, const LogRecord *record, unsigned char isColored);
+
+/**
+ * @brief Writes the record (with color codes if colored) to the stream with a single write
+ * Used for the queued records longer than the batch of the writer
+ *
+ * @param stream stream to write
+ * @param record formatted record
+ * @param isColored flag to add the color codes
+ */
+void LogRecord_Write(FILE *stream, const LogRecord *record, unsigned char isColored);
+
+/**
+ * @brief Checks if any sink is added
+ */
+unsigned char Sinks_IsActive();
+
+/**
+ * @brief Adds a sink writing to the descriptor
+ *
+ * @param fd descriptor of the sink
+ * @param stream stream flushed before the writes (NULL if none)
+ * @param isOwningFd flag to close the descriptor with the sink
+ * @param isColored flag to write the color codes
+ * @param levelMask level mask of the sink (LevelMask())
+ * @return int 0 -> Success, -1 -> no free sink
+ */
+int Sinks_AddFd(int fd, FILE *stream, unsigned char isOwningFd, unsigned char isColored, unsigned int levelMask);
+
+/**
+ * @brief Adds a sink calling the function
+ *
+ * @param sinkFn function of the sink
+ * @param context context of the function
+ * @param levelMask level mask of the sink (LevelMask())
+ * @return int 0 -> Success, -1 -> no free sink
+ */
+int Sinks_AddFn(UniLoggerSinkFn sinkFn, void *context, unsigned int levelMask);
+
+/**
+ * @brief Writes the record to every sink of its level
+ *
+ * @param record formatted record
+ */
+void Sinks_Write(const LogRecord *record);
+
+/**
+ * @brief Removes all the sinks, closing their descriptors
+ */
+void Sinks_Close();
+
+/**
+ * @brief Returns the mask of the enabled levels for the log level
+ *
+ * @param level log level
+ * @return unsigned int bit (1 << level) is set for every enabled level
+ */
+static inline unsigned int LevelMask(enum LogLevel level)
+{
+    if (LOG_LEVEL_PROFILE == level)
+    {
+        // print only profile logs
+        return 1u << LOG_LEVEL_PROFILE;
+    }
+    // all the levels till the enabled level (except off)
+    return ((1u << ((unsigned int)level + 1)) - 1) & ~1u;
+}
+
+// Level mask of the flight recorder (LevelMask()), 0 if not running
+extern unsigned int gRecorderLevelMask;
+
+/**
+ * @brief Gets the published level mask for the level mask of the stream
+ *
+ * @param streamMask level mask of the stream (LevelMask())
+ * @return unsigned int levels of the stream and of the flight recorder
+ */
+static inline unsigned int PublishedMask(unsigned int streamMask)
+{
+    return streamMask | (streamMask << UL_STREAM_MASK_SHIFT) |
+           __atomic_load_n(&gRecorderLevelMask, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sets the level mask of the tags without their own level
+ *
+ * @param levelMask level mask of the stream (LevelMask())
+ */
+void TagLevel_SetDefault(unsigned int levelMask);
+
+/**
+ * @brief Sets the level of the tag
+ *
+ * @param logTag log tag
+ * @param levelMask level mask of the stream (LevelMask())
+ * @param isFromEnv flag to check the level is from the Environment variable
+ * @return int 0 -> set, 1 -> kept the level of the Environment variable, -1 -> no free slot
+ */
+int TagLevel_Set(const char *logTag, unsigned int levelMask, unsigned char isFromEnv);
+
+/**
+ * @brief Resolves the call site to the level mask of its tag
+ *
+ * @param callSite descriptor of the call site
+ */
+void TagLevel_Resolve(UniLoggerCallSite *callSite);
+
+/**
+ * @brief Gets the level mask of the tag, for the logs without call site descriptor
+ * Cached by the thread, the tag is searched without the mutex if not cached
+ *
+ * @param logTag log tag
+ * @return const unsigned int* level mask of the tag
+ */
+const unsigned int *TagLevel_Lookup(const char *logTag);
+
+/**
+ * @brief Removes the levels of all the tags
+ */
+void TagLevel_Reset();
+
+/**
+ * @brief Publishes the level masks of the tags again, after the flight recorder changed
+ */
+void TagLevel_Republish();
+
+/**
+ * @brief Registers the call site and renders its prefix
+ *
+ * @param callSite descriptor of the call site
+ * @param format format of the first log
+ */
+void CallSite_Register(UniLoggerCallSite *callSite, const char *format);
+
+/**
+ * @brief Encodes the structured log as JSON line or logfmt line
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param encoding encoding of the record (ENCODING_JSON or ENCODING_LOGFMT)
+ * @param message message of the log
+ * @param fields fields of the log
+ * @param count number of fields
+ * @return size_t number of bytes written (always ends with a newline)
+ */
+size_t Structured_EncodeRecord(char *buffer,
+                               size_t bufferSize,
+                               const UniLoggerCallSite *callSite,
+                               enum LogEncoding encoding,
+                               const char *message,
+                               const UniLoggerField *fields,
+                               unsigned int count);
+
+/**
+ * @brief Encodes the printf log as JSON line or logfmt line (message without fields)
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param encoding encoding of the record (ENCODING_JSON or ENCODING_LOGFMT)
+ * @param args args of the print
+ * @param format format of the print
+ * @return size_t number of bytes written (always ends with a newline)
+ */
+size_t Structured_EncodeArgs(char *buffer,
+                             size_t bufferSize,
+                             const UniLoggerCallSite *callSite,
+                             enum LogEncoding encoding,
+                             va_list args,
+                             const char *format);
+
+/**
+ * @brief Formats the message and the fields as text ("message key=value ...")
+ *
+ * @param message message of the log
+ * @param fields fields of the log
+ * @param count number of fields
+ * @return const char* thread local text, valid till the next log of the thread
+ */
+const char *Structured_Text(const char *message, const UniLoggerField *fields, unsigned int count);
+
+/**
+ * @brief Type of the record counters
+ */
+typedef enum StatsRecord
+{
+    // Records written to the Log Stream
+    STATS_EMITTED,
+    // Records not written because of the log level
+    STATS_FILTERED,
+    // Records dropped by a full queue or buffer
+    STATS_DROPPED,
+    // Repeated records written as a summary
+    STATS_COLLAPSED,
+    STATS_RECORD_COUNT
+} StatsRecord;
+
+/**
+ * @brief Gets the monotonic time for the statistics
+ *
+ * @return unsigned long long time in ns
+ */
+unsigned long long Stats_Now();
+
+/**
+ * @brief Counts the record
+ *
+ * @param type type of the counter
+ * @param level log level of the record (LOG_LEVEL_OFF if not known)
+ */
+void Stats_AddRecord(StatsRecord type, enum LogLevel level);
+
+/**
+ * @brief Counts the record counted as emitted as dropped instead
+ *
+ * @param level log level of the record
+ */
+void Stats_DropRecord(enum LogLevel level);
+
+/**
+ * @brief Counts the write system call
+ *
+ * @param bytes number of bytes written
+ * @param ioNs time of the system call in ns
+ * @param isFailed flag to count the write as failed
+ */
+void Stats_AddWrite(size_t bytes, unsigned long long ioNs, unsigned char isFailed);
+
+/**
+ * @brief Counts the bytes written without system call (memory mapped log file)
+ *
+ * @param bytes number of bytes written
+ */
+void Stats_AddBytes(size_t bytes);
+
+/**
+ * @brief Locks the mutex, counting the time waited if it is contended
+ *
+ * @param mutex mutex to lock
+ */
+void Stats_LockMutex(pthread_mutex_t *mutex);
+
+/**
+ * @brief Starts the thread writing the statistics every interval
+ *
+ * @param interval interval in seconds
+ * @return int 0 -> Success, -1 -> Failure
+ */
+int Stats_StartReport(unsigned int interval);
+
+/**
+ * @brief Stops the report thread
+ */
+void Stats_StopReport();
+
+/**
+ * @brief Sets the format of the timestamps
+ *
+ * @param format time format (LogTimeFormat)
+ */
+void Timestamp_SetFormat(enum LogTimeFormat format);
+
+/**
+ * @brief Gets the current time for the log
+ *
+ * @param now current time
+ */
+void Timestamp_Now(struct timespec *now);
+
+/**
+ * @brief Gets the last time read by the thread with Timestamp_Now() (time of the last formatted record)
+ *
+ * @param time last time
+ */
+void Timestamp_Last(struct timespec *time);
+
+/**
+ * @brief Formats the time with the current time format
+ *
+ * @param time time to be formatted
+ * @param buffer destination buffer of UL_TIMESTAMP_SIZE bytes
+ * @return size_t length of the formatted time
+ */
+size_t Timestamp_Format(const struct timespec *time, char *buffer);
+
+/**
+ * @brief Parses the next conversion in the format
+ *
+ * @param format format to be parsed
+ * @param spec parsed conversion
+ * @return const char* format after the conversion, NULL if no conversion left
+ */
+const char *BinaryFormat_NextSpec(const char *format, BinarySpec *spec);
+
+/**
+ * @brief Encodes the log as binary record (with string records of new strings)
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ * @return size_t number of bytes written
+ */
+size_t EncodeBinaryRecord(char *buffer,
+                          size_t bufferSize,
+                          const UniLoggerCallSite *callSite,
+                          va_list args,
+                          const char *format);
+
+/**
+ * @brief Encodes the header of the binary logs
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @return size_t number of bytes written
+ */
+size_t EncodeBinaryHeader(char *buffer, size_t bufferSize);
+
+/**
+ * @brief Gets the length of the binary record (or text line) at the start of the data
+ *
+ * @param data binary records
+ * @param length length of the data
+ * @return size_t length of the record, 0 if the record is not complete or invalid
+ */
+size_t BinaryFormat_RecordLength(const char *data, size_t length);
+
+/**
+ * @brief Checks if the binary record carries the text of its format or tag
+ *
+ * @param data binary record
+ * @param length length of the record
+ * @return unsigned char 1 -> string records are written with the record, 0 -> none
+ */
+unsigned char BinaryFormat_HasStrings(const char *data, size_t length);
+
+/**
+ * @brief Forgets the written formats and tags, so they are written again
+ * Used when the logs continue in a new file, or a record carrying strings is dropped
+ */
+void BinaryFormat_ResetStrings();
+
+/**
+ * @brief Starts the asynchronous writer thread
+ *
+ * @param mode overflow policy of the queue
+ * @param queueSize number of records in the queue (rounded to power of 2)
+ * @return int 0 -> Success, -1 -> Failure
+ */
+int AsyncWriter_Start(enum LogAsyncMode mode, unsigned int queueSize);
+
+/**
+ * @brief Checks if the asynchronous writer is running
+ *
+ * @return unsigned char 1 -> running, 0 -> not running
+ */
+unsigned char AsyncWriter_IsRunning();
+
+/**
+ * @brief Formats the record into the asynchronous queue
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+void AsyncWriter_Push(const UniLoggerCallSite *callSite,
+                      va_list args,
+                      const char *format);
+
+/**
+ * @brief Waits till all the queued records are written
+ */
+void AsyncWriter_Flush();
+
+/**
+ * @brief Drains the queue and stops the writer thread
+ */
+void AsyncWriter_Stop();
+
+/**
+ * @brief Starts the merger thread for the per-thread buffers
+ *
+ * @param bufferSize number of records in each thread buffer
+ * @return int 0 -> Success, -1 -> Failure
+ */
+int MergeWriter_Start(unsigned int bufferSize);
+
+/**
+ * @brief Checks if the merger thread is running
+ *
+ * @return unsigned char 1 -> running, 0 -> not running
+ */
+unsigned char MergeWriter_IsRunning();
+
+/**
+ * @brief Formats the record into the buffer of the calling thread
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+void MergeWriter_Push(const UniLoggerCallSite *callSite,
+                      va_list args,
+                      const char *format);
+
+/**
+ * @brief Waits till all the numbered records are written
+ */
+void MergeWriter_Flush();
+
+/**
+ * @brief Writes the remaining records and stops the merger thread
+ */
+void MergeWriter_Stop();
+
+/**
+ * @brief Starts rotating the log file
+ *
+ * @param stream stream of the log file (opened with O_APPEND)
+ * @param filePath path of the log file
+ * @param maxSize maximum size of the file in bytes (0 -> no limit)
+ * @param rotateInterval rotation interval in seconds (0 -> no interval)
+ * @param keepFiles number of rotated files kept
+ * @return int 0 on success, -1 on failure
+ */
+int Rotation_Start(FILE *stream,
+                   const char *filePath,
+                   unsigned long long maxSize,
+                   unsigned int rotateInterval,
+                   unsigned int keepFiles);
+
+/**
+ * @brief Checks if the log file is rotated
+ */
+unsigned char Rotation_IsRunning();
+
+/**
+ * @brief Accounts the bytes written to the log file, rotates when the file is full
+ *
+ * @param length number of bytes written
+ */
+void Rotation_AddBytes(size_t length);
+
+/**
+ * @brief Stops the rotation of the log file
+ */
+void Rotation_Stop();
+
+/**
+ * @brief Starts the sidecar index of the log file ("<file>.idx")
+ *
+ * @param filePath path of the log file
+ * @param fileOffset current size of the log file
+ * @param blockRecords records in a block (0 -> no limit)
+ * @param blockBytes bytes of the log file in a block (0 -> no limit)
+ * @return int 0 on success, -1 on failure
+ */
+int Index_Start(const char *filePath,
+                unsigned long long fileOffset,
+                unsigned int blockRecords,
+                unsigned long long blockBytes);
+
+/**
+ * @brief Checks if the log file is indexed
+ */
+unsigned char Index_IsRunning();
+
+/**
+ * @brief Adds the record to the records of the thread, called by the thread writing it
+ * The records are added to the open block with the bytes of the next write of the thread
+ *
+ * @param level level of the record
+ * @param time time of the record, NULL for the current time
+ */
+void Index_AddRecord(enum LogLevel level, const struct timespec *time);
+
+/**
+ * @brief Accounts the bytes written to the log file, with the records of the thread
+ *
+ * @param length number of bytes written
+ */
+void Index_AddBytes(size_t length);
+
+/**
+ * @brief Moves the records of the thread, to be added by the thread writing them
+ *
+ * @param records destination of the records
+ */
+void Index_TakeRecords(IndexEntry *records);
+
+/**
+ * @brief Accounts the bytes written to the log file, with the records taken from another thread
+ *
+ * @param records records taken by Index_TakeRecords()
+ * @param length number of bytes written
+ */
+void Index_AddWritten(const IndexEntry *records, size_t length);
+
+/**
+ * @brief Writes the open block and closes the index file
+ */
+void Index_Stop();
+
+/**
+ * @brief Creates or opens the shared memory ring
+ *
+ * @param name name of the shared memory object ("/" is prefixed if missing)
+ * @param slotCount number of slots, used if the ring is created
+ * @param mapSize size of the mapping (for munmap)
+ * @param fd descriptor of the shared memory object
+ * @return SharedRingHeader* mapped ring, NULL on failure
+ */
+SharedRingHeader *SharedRing_Map(const char *name, unsigned int slotCount, size_t *mapSize, int *fd);
+
+/**
+ * @brief Gets the slot of the position
+ */
+static inline SharedRingSlot *SharedRing_Slot(SharedRingHeader *header, uint64_t pos)
+{
+    return (SharedRingSlot *)((char *)(header + 1) +
+                              (size_t)(pos & (header->slotCount - 1)) * header->slotSize);
+}
+
+/**
+ * @brief Wakes the collector if it is waiting for records
+ */
+void SharedRing_WakeCollector(SharedRingHeader *header);
+
+/**
+ * @brief Starts writing the logs of the process to the shared memory ring
+ *
+ * @param name name of the shared memory object
+ * @param slotCount number of slots, used if the ring is created
+ * @return int 0 on success, -1 on failure
+ */
+int SharedRing_Start(const char *name, unsigned int slotCount);
+
+/**
+ * @brief Checks if the logs are written to the shared memory ring
+ */
+unsigned char SharedRing_IsRunning();
+
+/**
+ * @brief Formats the log into a slot of the shared memory ring
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+void SharedRing_Push(const UniLoggerCallSite *callSite, va_list args, const char *format);
+
+/**
+ * @brief Waits till the collector has taken the records of the ring (bounded wait)
+ */
+void SharedRing_Flush();
+
+/**
+ * @brief Unmaps the shared memory ring (the ring is kept for the collector)
+ */
+void SharedRing_Stop();
+
+/**
+ * @brief Starts the sender thread of the socket Log Stream, connected in the background
+ *
+ * @param address address of the collector ("unix:", "unix-stream:", "udp:" or "tcp:")
+ * @param bufferSize size of the pending buffer in bytes
+ * @return int 0 on success, -1 on invalid address or failure
+ */
+int SocketSink_Start(const char *address, size_t bufferSize);
+
+/**
+ * @brief Checks if the socket Log Stream is running
+ *
+ * @return unsigned char 1 -> running, 0 -> not running
+ */
+unsigned char SocketSink_IsRunning();
+
+/**
+ * @brief Checks if the socket sends datagrams (one record per datagram)
+ *
+ * @return unsigned char 1 -> datagram socket, 0 -> stream socket
+ */
+unsigned char SocketSink_IsDatagram();
+
+/**
+ * @brief Gets the placeholder stream of the socket, used as the current Log Stream
+ *
+ * @return FILE* placeholder stream (never written)
+ */
+FILE *SocketSink_GetStream();
+
+/**
+ * @brief Copies the records into the pending buffer, dropped if the buffer is full
+ *
+ * @param vectors parts of the records
+ * @param count number of the parts
+ */
+void SocketSink_Write(const struct iovec *vectors, int count);
+
+/**
+ * @brief Sends the record directly, used by the signal handlers
+ *
+ * @param data formatted record
+ * @param length length of the record
+ */
+void SocketSink_WriteFromSignal(const char *data, size_t length);
+
+/**
+ * @brief Waits (bounded) till the pending records are sent, only while connected
+ */
+void SocketSink_Flush();
+
+/**
+ * @brief Sends the pending records (bounded), stops the sender thread and closes the socket
+ */
+void SocketSink_Stop();
+
+/**
+ * @brief Starts collapsing the repeated records and the thread writing the old runs
+ *
+ * @param windowSize recent records compared per thread
+ * @param flushInterval milliseconds after which the repeats of a record are written
+ * @return int 0 on success, -1 on failure
+ */
+int Duplicate_Start(unsigned int windowSize, unsigned int flushInterval);
+
+/**
+ * @brief Checks if the repeated records are collapsed
+ *
+ * @return unsigned char 1 -> running, 0 -> not running
+ */
+unsigned char Duplicate_IsRunning();
+
+/**
+ * @brief Checks the record against the recent records of the thread
+ * Summaries of the ended runs are written before returning
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ * @return unsigned char 1 -> repeat (not to be written), 0 -> new record
+ */
+unsigned char Duplicate_IsRepeated(const UniLoggerCallSite *callSite, va_list args, const char *format);
+
+/**
+ * @brief Writes the repeats of all the threads
+ */
+void Duplicate_Flush();
+
+/**
+ * @brief Writes the repeats, stops the thread and frees the windows
+ */
+void Duplicate_Stop();
+
+/**
+ * @brief Writes the logs suppressed by the rate limits since their last report
+ */
+void RateLimit_Flush();
+
+/**
+ * @brief Writes the summary of the repeats of a record (never collapsed)
+ *
+ * @param callSite descriptor of the call site
+ * @param repeated number of the repeats
+ * @param spanNs time from the written record to the last repeat
+ */
+void LogRepeated(const UniLoggerCallSite *callSite, unsigned long long repeated, unsigned long long spanNs);
+
+/**
+ * @brief Checks if the compression is built in
+ *
+ * @param compression log file compression
+ * @return unsigned char 1 -> available, 0 -> not built in
+ */
+unsigned char CompressSink_IsAvailable(enum LogFileCompression compression);
+
+/**
+ * @brief Starts the thread compressing the blocks of the log file
+ *
+ * @param stream stream of the log file (empty or compressed with the same format)
+ * @param filePath path of the log file
+ * @param compression log file compression
+ * @param blockSize uncompressed bytes of a block
+ * @param flushInterval milliseconds after which a partly filled block is compressed
+ * @return int 0 on success, -1 on failure
+ */
+int CompressSink_Start(FILE *stream,
+                       const char *filePath,
+                       enum LogFileCompression compression,
+                       size_t blockSize,
+                       unsigned int flushInterval);
+
+/**
+ * @brief Checks if the log file is compressed
+ *
+ * @return unsigned char 1 -> running, 0 -> not running
+ */
+unsigned char CompressSink_IsRunning();
+
+/**
+ * @brief Copies the records into the open block, full blocks are compressed by the thread
+ *
+ * @param vectors parts of the records
+ * @param count number of the parts
+ */
+void CompressSink_Write(const struct iovec *vectors, int count);
+
+/**
+ * @brief Writes the record as an uncompressed frame, used by the signal handlers
+ *
+ * @param data formatted record
+ * @param length length of the record
+ */
+void CompressSink_WriteFromSignal(const char *data, size_t length);
+
+/**
+ * @brief Compresses the open block and waits till the blocks are written
+ */
+void CompressSink_Flush();
+
+/**
+ * @brief Compresses the open block and stops the thread
+ */
+void CompressSink_Stop();
+
+/**
+ * @brief Starts writing the log file through a memory mapping
+ *
+ * @param stream stream of the log file
+ * @param filePath path of the log file
+ * @return int 0 on success, -1 on failure
+ */
+int MmapSink_Start(FILE *stream, const char *filePath);
+
+/**
+ * @brief Checks if the log file is written through the memory mapping
+ */
+unsigned char MmapSink_IsRunning();
+
+/**
+ * @brief Copies the formatted logs to the memory mapping
+ *
+ * @param data formatted logs
+ * @param length length of the logs
+ */
+void MmapSink_Write(const char *data, size_t length);
+
+/**
+ * @brief Gets the offset of the next record in the memory mapped file
+ */
+size_t MmapSink_GetOffset();
+
+/**
+ * @brief Starts writing back the logs copied to the memory mapping
+ */
+void MmapSink_Flush();
+
+/**
+ * @brief Stops the memory mapping and truncates the preallocated space
+ */
+void MmapSink_Stop();
+
+/**
+ * @brief Starts the thread writing the profile statistics every interval
+ *
+ * @param interval dump interval in seconds
+ * @return int 0 on success, -1 on failure
+ */
+int Profile_StartDump(unsigned int interval);
+
+/**
+ * @brief Stops the thread writing the profile statistics
+ */
+void Profile_StopDump();
+
+/**
+ * @brief Starts counting the cost of the call sites
+ *
+ * @param topCount number of call sites written by the dump (0 -> UL_CALL_SITE_STATS_DEFAULT_TOP)
+ * @return int 0 on success, -1 on failure
+ */
+int CallSiteStats_Start(unsigned int topCount);
+
+/**
+ * @brief Checks if the cost of the call sites is counted
+ *
+ * @return unsigned char 1 -> counting, 0 -> not counting
+ */
+unsigned char CallSiteStats_IsRunning();
+
+/**
+ * @brief Adds the cost of an emitted log to its call site
+ *
+ * @param callSite descriptor of the call site (not counted if not registered)
+ * @param bytes number of bytes formatted for the log
+ * @param ns time spent formatting and writing the log in ns
+ */
+void CallSiteStats_Add(const UniLoggerCallSite *callSite, size_t bytes, unsigned long long ns);
+
+/**
+ * @brief Installs the SIGUSR2 handler and starts the thread writing the dump on the signal
+ *
+ * @return int 0 on success, -1 on failure or if the application has a SIGUSR2 handler
+ */
+int CallSiteStats_StartSignalDump();
+
+/**
+ * @brief Restores the SIGUSR2 handler, stops the dump thread and the counting
+ */
+void CallSiteStats_Stop();
+
+/**
+ * @brief Starts the flight recorder ring and the crash signal handlers
+ *
+ * @param size number of records in the ring
+ * @return int 0 on success, -1 on failure
+ */
+int FlightRecorder_Start(unsigned int size);
+
+/**
+ * @brief Checks if the flight recorder is running
+ */
+unsigned char FlightRecorder_IsRunning();
+
+/**
+ * @brief Formats the log into the ring, overwriting the oldest record
+ *
+ * @param callSite descriptor of the call site
+ * @param args args of the print
+ * @param format format of the print
+ */
+void FlightRecorder_Push(const UniLoggerCallSite *callSite, va_list args, const char *format);
+
+/**
+ * @brief Writes the records of the ring, oldest first
+ * Async-signal-safe if the write function is async-signal-safe
+ *
+ * @param writeFn function writing a record
+ */
+void FlightRecorder_Dump(void (*writeFn)(const char *data, size_t length));
+
+/**
+ * @brief Stops the flight recorder and restores the signal handlers
+ */
+void FlightRecorder_Stop();
+
+#endif // __UNI_LOGGER_INTERNAL_H__
@@ -0,0 +1,430 @@
+/**
+ * @file UniLoggerMerge.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Per-thread log buffers merged by sequence number for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Each thread formats into its own single-producer ring, the only shared
+ * state on the logging path is the global sequence counter. The merger
+ * thread emits the records in sequence order, one write per batch. Records
+ * longer than a slot are formatted into an allocated buffer.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <time.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Size of the merged batch written at once
+ */
+#ifndef UL_MERGE_BATCH_SIZE
+#define UL_MERGE_BATCH_SIZE (64 * 1024)
+#endif // UL_MERGE_BATCH_SIZE
+
+/**
+ * @brief Single record slot of the thread buffer
+ */
+typedef struct MergeSlot
+{
+    // Global sequence number of the record
+    uint64_t sequence;
+    // Length of the formatted record
+    size_t length;
+    // Log level of the record, LOG_LEVEL_OFF for binary and structured records
+    enum LogLevel level;
+    // Level and time of the log, for the index of the log file
+    enum LogLevel logLevel;
+    struct timespec time;
+    // Formatted record
+    char data[UL_MAX_RECORD_SIZE];
+    // Allocated record longer than data, NULL if the record is in data
+    char *overflow;
+} MergeSlot;
+
+/**
+ * @brief Buffer owned by one logging thread
+ */
+typedef struct ThreadBuffer
+{
+    // Position of the next record to be merged
+    atomic_size_t head;
+    // Position of the next record to be written by the owner
+    atomic_size_t tail;
+    // Flag to check buffer is owned by a thread
+    atomic_int isOwned;
+    // Next buffer in registry
+    struct ThreadBuffer *next;
+    // Slots of the buffer
+    MergeSlot *slots;
+} ThreadBuffer;
+
+// Registry of the thread buffers
+static ThreadBuffer *_Atomic s_buffers = NULL;
+// Mutex for registering the thread buffers
+static pthread_mutex_t s_registryMutex = PTHREAD_MUTEX_INITIALIZER;
+// Key to release the buffer on thread exit
+static pthread_key_t s_bufferKey;
+// Number of slots in each thread buffer
+static size_t s_slotCount = 0;
+// Generation of the buffers, thread local buffers of old generation are invalid
+static atomic_uint s_generation;
+
+// Thread local buffer of the logging thread
+static __thread ThreadBuffer *t_buffer = NULL;
+// Generation of the thread local buffer
+static __thread unsigned int t_generation = 0;
+
+// Next sequence number to be given to a record
+static atomic_uint_least64_t s_nextSequence;
+// Next sequence number to be written by the merger
+static atomic_uint_least64_t s_mergedSequence;
+
+// Flag to check merger is running
+static atomic_int s_isRunning;
+// Flag to request the merger to stop
+static atomic_int s_isStopping;
+// Flag to check merger is waiting for records
+static atomic_int s_isMergerIdle;
+
+// Merger thread
+static pthread_t s_mergerThread;
+// Mutex and condition to wake the merger
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Wakes the merger thread
+ */
+static inline void WakeMerger()
+{
+    pthread_mutex_lock(&s_wakeMutex);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+}
+
+/**
+ * @brief Releases the buffer of the exiting thread for reuse
+ *
+ * @param buffer thread buffer
+ */
+static void ReleaseThreadBuffer(void *buffer)
+{
+    atomic_store_explicit(&((ThreadBuffer *)buffer)->isOwned, 0, memory_order_release);
+}
+
+/**
+ * @brief Gets the buffer of the calling thread, reuses buffers of exited threads
+ *
+ * @return ThreadBuffer* thread buffer, NULL on allocation failure
+ */
+static ThreadBuffer *GetThreadBuffer()
+{
+    unsigned int generation = atomic_load_explicit(&s_generation, memory_order_acquire);
+    if (t_buffer && t_generation == generation)
+    {
+        return t_buffer;
+    }
+
+    ThreadBuffer *buffer;
+    for (buffer = atomic_load_explicit(&s_buffers, memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        int isOwned = 0;
+        if (atomic_compare_exchange_strong_explicit(&buffer->isOwned, &isOwned, 1,
+                                                    memory_order_acquire, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (NULL == buffer)
+    {
+        buffer = (ThreadBuffer *)calloc(1, sizeof(ThreadBuffer));
+        if (NULL == buffer)
+        {
+            return NULL;
+        }
+        buffer->slots = (MergeSlot *)calloc(s_slotCount, sizeof(MergeSlot));
+        if (NULL == buffer->slots)
+        {
+            free(buffer);
+            return NULL;
+        }
+        atomic_init(&buffer->head, 0);
+        atomic_init(&buffer->tail, 0);
+        atomic_init(&buffer->isOwned, 1);
+
+        pthread_mutex_lock(&s_registryMutex);
+        buffer->next = atomic_load_explicit(&s_buffers, memory_order_relaxed);
+        atomic_store_explicit(&s_buffers, buffer, memory_order_release);
+        pthread_mutex_unlock(&s_registryMutex);
+    }
+
+    pthread_setspecific(s_bufferKey, buffer);
+    t_buffer = buffer;
+    t_generation = generation;
+    return buffer;
+}
+
+/**
+ * @brief Checks if the record with the given sequence is at the head of buffer
+ *
+ * @param buffer thread buffer
+ * @param sequence sequence number of the record
+ */
+static inline unsigned char HasRecord(ThreadBuffer *buffer, uint64_t sequence)
+{
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    return head != atomic_load_explicit(&buffer->tail, memory_order_acquire) &&
+           buffer->slots[head % s_slotCount].sequence == sequence;
+}
+
+/**
+ * @brief Finds the buffer holding the record with the given sequence
+ *
+ * @param hint buffer to be checked first (last merged buffer)
+ * @param sequence sequence number of the record
+ * @return ThreadBuffer* buffer with the record at head, NULL if not ready
+ */
+static ThreadBuffer *FindRecord(ThreadBuffer *hint, uint64_t sequence)
+{
+    if (hint && HasRecord(hint, sequence))
+    {
+        return hint;
+    }
+
+    ThreadBuffer *buffer;
+    for (buffer = atomic_load_explicit(&s_buffers, memory_order_acquire); buffer; buffer = buffer->next)
+    {
+        if (buffer != hint && HasRecord(buffer, sequence))
+        {
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Merger thread, writes the records of all threads in sequence order
+ */
+static void *MergerThread(void *arg)
+{
+    (void)arg;
+    static char batch[UL_MERGE_BATCH_SIZE];
+    ThreadBuffer *hint = NULL;
+
+    for (;;)
+    {
+        size_t batchLength = 0;
+        uint64_t firstSequence = atomic_load_explicit(&s_mergedSequence, memory_order_relaxed);
+        uint64_t sequence = firstSequence;
+
+        // Collect the consecutive records into the batch
+        while (batchLength + UL_MAX_RECORD_SIZE + UL_MAX_COLOR_SIZE <= sizeof(batch))
+        {
+            ThreadBuffer *buffer = FindRecord(hint, sequence);
+            if (NULL == buffer)
+            {
+                break;
+            }
+
+            size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+            MergeSlot *slot = &buffer->slots[head % s_slotCount];
+            LogRecord record = {slot->overflow ? slot->overflow : slot->data, slot->length, slot->level};
+            if (batchLength && record.length + UL_MAX_COLOR_SIZE > sizeof(batch) - batchLength)
+            {
+                // Records of the batch are written before the long record
+                WriteLogData(gCurrLogStream, batch, batchLength);
+                batchLength = 0;
+            }
+            // Indexed with the bytes of the write of the batch or of the long record
+            if (Index_IsRunning())
+            {
+                Index_AddRecord(slot->logLevel, &slot->time);
+            }
+            if (record.length + UL_MAX_COLOR_SIZE > sizeof(batch))
+            {
+                LogRecord_Write(gCurrLogStream, &record, !IsLogStreamPlain());
+            }
+            else
+            {
+                batchLength += LogRecord_Copy(batch + batchLength, &record, !IsLogStreamPlain());
+            }
+            Sinks_Write(&record);
+            if (slot->overflow)
+            {
+                free(slot->overflow);
+                slot->overflow = NULL;
+            }
+            atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+
+            hint = buffer;
+            sequence++;
+        }
+
+        if (sequence != firstSequence)
+        {
+            if (batchLength)
+            {
+                WriteLogData(gCurrLogStream, batch, batchLength);
+            }
+            fflush(gCurrLogStream);
+            atomic_store_explicit(&s_mergedSequence, sequence, memory_order_release);
+            continue;
+        }
+
+        if (atomic_load(&s_isStopping) &&
+            sequence == atomic_load(&s_nextSequence))
+        {
+            break;
+        }
+
+        // Wait till producers push new records
+        pthread_mutex_lock(&s_wakeMutex);
+        atomic_store(&s_isMergerIdle, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (NULL == FindRecord(hint, sequence) && !atomic_load(&s_isStopping))
+        {
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += 10 * 1000 * 1000;
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec += 1;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout);
+        }
+        atomic_store(&s_isMergerIdle, 0);
+        pthread_mutex_unlock(&s_wakeMutex);
+    }
+    return NULL;
+}
+
+int MergeWriter_Start(unsigned int bufferSize)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    if (0 != pthread_key_create(&s_bufferKey, ReleaseThreadBuffer))
+    {
+        return -1;
+    }
+
+    s_slotCount = bufferSize < 2 ? 2 : bufferSize;
+    atomic_store(&s_buffers, NULL);
+    atomic_store(&s_nextSequence, 0);
+    atomic_store(&s_mergedSequence, 0);
+    atomic_store(&s_isStopping, 0);
+    atomic_store(&s_isMergerIdle, 0);
+    atomic_fetch_add(&s_generation, 1);
+
+    if (0 != pthread_create(&s_mergerThread, NULL, MergerThread, NULL))
+    {
+        pthread_key_delete(s_bufferKey);
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char MergeWriter_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void MergeWriter_Push(const UniLoggerCallSite *callSite,
+                      va_list args,
+                      const char *format)
+{
+    ThreadBuffer *buffer = GetThreadBuffer();
+    if (NULL == buffer)
+    {
+        Stats_DropRecord(callSite->level);
+        return;
+    }
+
+    // Wait for the merger to make space in the thread buffer
+    size_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&buffer->head, memory_order_acquire) >= s_slotCount)
+    {
+        WakeMerger();
+        sched_yield();
+    }
+
+    MergeSlot *slot = &buffer->slots[tail % s_slotCount];
+    slot->sequence = atomic_fetch_add_explicit(&s_nextSequence, 1, memory_order_relaxed);
+    // Records longer than the slot are allocated, freed by the merger
+    slot->length = FormatQueuedRecord(slot->data,
+                                      sizeof(slot->data),
+                                      callSite,
+                                      args,
+                                      format,
+                                      gCurrLogEncoding,
+                                      &slot->overflow);
+    slot->level = (ENCODING_TEXT == gCurrLogEncoding) ? callSite->level : LOG_LEVEL_OFF;
+    slot->logLevel = callSite->level;
+    Timestamp_Last(&slot->time);
+    atomic_store_explicit(&buffer->tail, tail + 1, memory_order_release);
+
+    // Wake the merger only if it is waiting
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s_isMergerIdle, memory_order_relaxed))
+    {
+        WakeMerger();
+    }
+}
+
+void MergeWriter_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    // Wait till all the records numbered till now are written
+    uint64_t target = atomic_load(&s_nextSequence);
+    while (atomic_load_explicit(&s_mergedSequence, memory_order_acquire) < target)
+    {
+        struct timespec delay = {0, 100 * 1000};
+        WakeMerger();
+        nanosleep(&delay, NULL);
+    }
+    fflush(gCurrLogStream);
+}
+
+void MergeWriter_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    // Merger writes the remaining records before exiting
+    atomic_store(&s_isStopping, 1);
+    WakeMerger();
+    pthread_join(s_mergerThread, NULL);
+    atomic_store(&s_isRunning, 0);
+
+    // Buffers of the live threads are invalidated by the generation
+    pthread_key_delete(s_bufferKey);
+    ThreadBuffer *buffer = atomic_load(&s_buffers);
+    atomic_store(&s_buffers, NULL);
+    while (buffer)
+    {
+        ThreadBuffer *next = buffer->next;
+        free(buffer->slots);
+        free(buffer);
+        buffer = next;
+    }
+}
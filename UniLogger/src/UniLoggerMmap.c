@@ -0,0 +1,261 @@
+/**
+ * @file UniLoggerMmap.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Memory mapped log file sink for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * The log file is mapped once (UL_MMAP_MAP_SIZE of address space) and
+ * every log claims its range with an atomic offset and copies the record
+ * into the mapping, without any system call. A background thread keeps the
+ * file preallocated ahead of the offset and starts the write back with
+ * msync(). Records written to the mapping are in the page cache, they reach
+ * the file even if the process crashes, followed by the preallocated zero
+ * bytes (up to two chunks) which are truncated only at the stop.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "UniLoggerInternal.h"
+
+// Descriptor of the log file
+static int s_fd = -1;
+// Mapping of the log file
+static char *s_mapping = NULL;
+// Size of the mapping
+static size_t s_mapSize = 0;
+// Offset of the next record
+static atomic_size_t s_offset;
+// Size of the file which can be written through the mapping
+static atomic_size_t s_fileSize;
+// Offset till which msync() is started
+static size_t s_syncedOffset = 0;
+
+// Flag to check sink is running
+static atomic_int s_isRunning;
+// Flag to request the sink thread to stop
+static atomic_int s_isStopping;
+
+// Sink thread
+static pthread_t s_sinkThread;
+// Mutex and condition to wake the sink thread
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Extends the file, so that the mapping can be written till size
+ *
+ * @param size required size of the file
+ */
+static void ExtendFile(size_t size)
+{
+    size_t fileSize = atomic_load(&s_fileSize);
+    if (size <= fileSize)
+    {
+        return;
+    }
+
+    // Space is allocated now, instead of at the page faults of the writers
+    // Without space the mapping would fault (SIGBUS), records beyond the file size are written with pwrite()
+    if (0 != posix_fallocate(s_fd, (off_t)fileSize, (off_t)(size - fileSize)))
+    {
+        return;
+    }
+    atomic_store(&s_fileSize, size);
+}
+
+/**
+ * @brief Starts writing back the records written after the last sync
+ */
+static void SyncMapping()
+{
+    // Only the records written through the mapping
+    size_t offset = atomic_load(&s_offset);
+    size_t fileSize = atomic_load(&s_fileSize);
+    if (offset > fileSize)
+    {
+        offset = fileSize;
+    }
+    if (offset <= s_syncedOffset)
+    {
+        return;
+    }
+
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = s_syncedOffset & ~(pageSize - 1);
+    msync(s_mapping + start, offset - start, MS_ASYNC);
+    s_syncedOffset = offset;
+}
+
+/**
+ * @brief Sink thread, preallocates the file and syncs the mapping
+ */
+static void *MmapSinkThread(void *arg)
+{
+    (void)arg;
+    unsigned int ticks = 0;
+
+    pthread_mutex_lock(&s_wakeMutex);
+    while (!atomic_load(&s_isStopping))
+    {
+        // Keep two chunks ahead of the writers
+        size_t target = atomic_load(&s_offset) + 2 * UL_MMAP_CHUNK_SIZE;
+        ExtendFile(target < s_mapSize ? target : s_mapSize);
+
+        if (++ticks * UL_MMAP_TICK_MS >= UL_MMAP_SYNC_INTERVAL_MS)
+        {
+            SyncMapping();
+            ticks = 0;
+        }
+
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_nsec += UL_MMAP_TICK_MS * 1000 * 1000;
+        if (timeout.tv_nsec >= 1000000000L)
+        {
+            timeout.tv_sec += 1;
+            timeout.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout);
+    }
+    pthread_mutex_unlock(&s_wakeMutex);
+    return NULL;
+}
+
+int MmapSink_Start(FILE *stream, const char *filePath)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    // Records buffered in the stream are written before the mapped records
+    fflush(stream);
+
+    // Shared writable mapping needs the file opened for reading and writing
+    s_fd = open(filePath, O_RDWR | O_CLOEXEC);
+    if (s_fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat fileStat;
+    if (0 != fstat(s_fd, &fileStat) || !S_ISREG(fileStat.st_mode))
+    {
+        close(s_fd);
+        s_fd = -1;
+        return -1;
+    }
+
+    s_mapSize = UL_MMAP_MAP_SIZE;
+    s_mapping = (char *)mmap(NULL, s_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, s_fd, 0);
+    if (MAP_FAILED == s_mapping)
+    {
+        s_mapping = NULL;
+        close(s_fd);
+        s_fd = -1;
+        return -1;
+    }
+
+    atomic_store(&s_offset, (size_t)fileStat.st_size);
+    atomic_store(&s_fileSize, (size_t)fileStat.st_size);
+    s_syncedOffset = (size_t)fileStat.st_size;
+    ExtendFile((size_t)fileStat.st_size + 2 * UL_MMAP_CHUNK_SIZE);
+    atomic_store(&s_isStopping, 0);
+
+    if (0 != pthread_create(&s_sinkThread, NULL, MmapSinkThread, NULL))
+    {
+        munmap(s_mapping, s_mapSize);
+        s_mapping = NULL;
+        close(s_fd);
+        s_fd = -1;
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char MmapSink_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void MmapSink_Write(const char *data, size_t length)
+{
+    size_t offset = atomic_fetch_add_explicit(&s_offset, length, memory_order_relaxed);
+    if (offset + length <= atomic_load_explicit(&s_fileSize, memory_order_acquire))
+    {
+        memcpy(s_mapping + offset, data, length);
+        return;
+    }
+
+    // Preallocation is behind or the mapping is full, write the range directly
+    while (length)
+    {
+        ssize_t written = pwrite(s_fd, data, length, (off_t)offset);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        offset += (size_t)written;
+        length -= (size_t)written;
+    }
+}
+
+size_t MmapSink_GetOffset()
+{
+    return atomic_load(&s_offset);
+}
+
+void MmapSink_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    SyncMapping();
+    pthread_mutex_unlock(&s_wakeMutex);
+}
+
+void MmapSink_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    atomic_store(&s_isStopping, 1);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+    pthread_join(s_sinkThread, NULL);
+
+    SyncMapping();
+    munmap(s_mapping, s_mapSize);
+    s_mapping = NULL;
+
+    // Remove the preallocated space after the last record
+    (void)ftruncate(s_fd, (off_t)atomic_load(&s_offset));
+    close(s_fd);
+    s_fd = -1;
+    atomic_store(&s_isRunning, 0);
+}
@@ -0,0 +1,389 @@
+/**
+ * @file UniLoggerProfile.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Profile scopes with aggregated histograms for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Duration of every profile scope is added to a histogram owned by the
+ * calling thread, nothing is written per scope. Histograms are log-linear
+ * (HDR style, UL_PROFILE_SUB_BUCKETS per power of 2). Only the owner thread
+ * writes its histograms, with relaxed atomic stores, so recording needs no
+ * lock and no read-modify-write. UniLogger_DumpProfile() merges the
+ * histograms of all the threads and writes one line per scope.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Histogram of a profile scope in one thread
+ */
+typedef struct ProfileHistogram
+{
+    // Number of the durations
+    atomic_ullong count;
+    // Sum of the durations in ns
+    atomic_ullong sum;
+    // Minimum duration in ns
+    atomic_ullong min;
+    // Maximum duration in ns
+    atomic_ullong max;
+    // Number of the durations in every bucket
+    atomic_ullong buckets[UL_PROFILE_BUCKETS];
+} ProfileHistogram;
+
+/**
+ * @brief Histograms of one thread
+ */
+typedef struct ProfileThread
+{
+    // Next thread in registry
+    struct ProfileThread *next;
+    // Histograms of the scopes, allocated at the first duration of the scope
+    _Atomic(ProfileHistogram *) histograms[UL_MAX_PROFILE_SCOPES];
+} ProfileThread;
+
+// Id of the scopes which can not be registered
+#define UL_PROFILE_SCOPE_INVALID UINT_MAX
+
+// Registered scopes, index is id - 1
+static UniLoggerProfileSite *s_profileSites[UL_MAX_PROFILE_SCOPES];
+// Number of the registered scopes
+static atomic_uint s_profileSiteCount;
+// Mutex for registering the scopes and for the dump
+static pthread_mutex_t s_profileMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Histograms of all the threads (kept after the thread exits)
+static _Atomic(ProfileThread *) s_profileThreads = NULL;
+// Histograms of the calling thread
+static __thread ProfileThread *t_profileThread = NULL;
+
+// Flag to check dump thread is running
+static atomic_int s_isDumpRunning;
+// Flag to request the dump thread to stop
+static atomic_int s_isDumpStopping;
+// Dump interval in seconds
+static unsigned int s_dumpInterval = 0;
+// Dump thread
+static pthread_t s_dumpThread;
+// Mutex and condition to wake the dump thread
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Gets the bucket of the duration
+ */
+static inline unsigned int BucketIndex(uint64_t value)
+{
+    if (value < UL_PROFILE_SUB_BUCKETS)
+    {
+        return (unsigned int)value;
+    }
+
+    // Top UL_PROFILE_SUB_BUCKET_BITS + 1 bits select the bucket
+    unsigned int msb = 63u - (unsigned int)__builtin_clzll(value);
+    unsigned int shift = msb - UL_PROFILE_SUB_BUCKET_BITS;
+    return (shift + 1) * UL_PROFILE_SUB_BUCKETS + (unsigned int)((value >> shift) - UL_PROFILE_SUB_BUCKETS);
+}
+
+/**
+ * @brief Gets the middle value of the bucket
+ */
+static inline uint64_t BucketValue(unsigned int index)
+{
+    if (index < UL_PROFILE_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    unsigned int shift = index / UL_PROFILE_SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(index % UL_PROFILE_SUB_BUCKETS + UL_PROFILE_SUB_BUCKETS) << shift;
+    return lower + ((1ULL << shift) >> 1);
+}
+
+/**
+ * @brief Registers the scope at its first duration
+ *
+ * @param site descriptor of the scope
+ * @return unsigned int id of the scope, UL_PROFILE_SCOPE_INVALID if no id is free
+ */
+static unsigned int RegisterSite(UniLoggerProfileSite *site)
+{
+    pthread_mutex_lock(&s_profileMutex);
+    unsigned int id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (0 == id)
+    {
+        unsigned int count = atomic_load_explicit(&s_profileSiteCount, memory_order_relaxed);
+        if (count < UL_MAX_PROFILE_SCOPES)
+        {
+            s_profileSites[count] = site;
+            id = count + 1;
+            atomic_store_explicit(&s_profileSiteCount, id, memory_order_release);
+        }
+        else
+        {
+            id = UL_PROFILE_SCOPE_INVALID;
+        }
+        __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&s_profileMutex);
+    return id;
+}
+
+/**
+ * @brief Gets the histogram of the scope in the calling thread
+ *
+ * @param index index of the scope (id - 1)
+ * @return ProfileHistogram* histogram, NULL on allocation failure
+ */
+static ProfileHistogram *GetHistogram(unsigned int index)
+{
+    ProfileThread *profileThread = t_profileThread;
+    if (NULL == profileThread)
+    {
+        profileThread = (ProfileThread *)calloc(1, sizeof(ProfileThread));
+        if (NULL == profileThread)
+        {
+            return NULL;
+        }
+
+        // Publish the histograms of the thread for the dump
+        profileThread->next = atomic_load_explicit(&s_profileThreads, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&s_profileThreads, &profileThread->next, profileThread,
+                                                      memory_order_release, memory_order_relaxed))
+        {
+        }
+        t_profileThread = profileThread;
+    }
+
+    ProfileHistogram *histogram = atomic_load_explicit(&profileThread->histograms[index], memory_order_relaxed);
+    if (NULL == histogram)
+    {
+        histogram = (ProfileHistogram *)calloc(1, sizeof(ProfileHistogram));
+        if (NULL == histogram)
+        {
+            return NULL;
+        }
+        atomic_init(&histogram->min, ULLONG_MAX);
+        atomic_store_explicit(&profileThread->histograms[index], histogram, memory_order_release);
+    }
+    return histogram;
+}
+
+/**
+ * @brief Increments the counter, only the owner thread writes it
+ */
+static inline void AddRelaxed(atomic_ullong *counter, unsigned long long value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+unsigned long long UniLogger_ProfileNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+void UniLogger_EndProfileScope(UniLoggerProfileScope *scope)
+{
+    // Profile level was disabled at the start of the scope
+    if (0 == scope->startNs)
+    {
+        return;
+    }
+    unsigned long long duration = UniLogger_ProfileNow() - scope->startNs;
+
+    unsigned int id = __atomic_load_n(&scope->site->id, __ATOMIC_ACQUIRE);
+    if (0 == id)
+    {
+        id = RegisterSite(scope->site);
+    }
+    if (UL_PROFILE_SCOPE_INVALID == id)
+    {
+        return;
+    }
+
+    ProfileHistogram *histogram = GetHistogram(id - 1);
+    if (NULL == histogram)
+    {
+        return;
+    }
+
+    AddRelaxed(&histogram->count, 1);
+    AddRelaxed(&histogram->sum, duration);
+    AddRelaxed(&histogram->buckets[BucketIndex(duration)], 1);
+    if (duration < atomic_load_explicit(&histogram->min, memory_order_relaxed))
+    {
+        atomic_store_explicit(&histogram->min, duration, memory_order_relaxed);
+    }
+    if (duration > atomic_load_explicit(&histogram->max, memory_order_relaxed))
+    {
+        atomic_store_explicit(&histogram->max, duration, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Gets the percentile from the merged buckets
+ *
+ * @param buckets merged buckets
+ * @param total number of the durations in the buckets
+ * @param percentile percentile (0 to 1)
+ * @return uint64_t middle value of the bucket of the percentile
+ */
+static uint64_t Percentile(const uint64_t *buckets, uint64_t total, double percentile)
+{
+    uint64_t rank = (uint64_t)(percentile * (double)total + 0.5);
+    if (0 == rank)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    unsigned int i;
+    for (i = 0; i < UL_PROFILE_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return BucketValue(i);
+        }
+    }
+    return BucketValue(UL_PROFILE_BUCKETS - 1);
+}
+
+/**
+ * @brief Clamps the value of the bucket to the measured range
+ */
+static inline uint64_t Clamp(uint64_t value, uint64_t min, uint64_t max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+void UniLogger_DumpProfile()
+{
+    // Merged buckets of a scope, used under s_profileMutex
+    static uint64_t buckets[UL_PROFILE_BUCKETS];
+
+    pthread_mutex_lock(&s_profileMutex);
+    unsigned int count = atomic_load_explicit(&s_profileSiteCount, memory_order_acquire);
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        uint64_t total = 0;
+        uint64_t sum = 0;
+        uint64_t min = UINT64_MAX;
+        uint64_t max = 0;
+        memset(buckets, 0, sizeof(buckets));
+
+        ProfileThread *profileThread;
+        for (profileThread = atomic_load_explicit(&s_profileThreads, memory_order_acquire);
+             profileThread;
+             profileThread = profileThread->next)
+        {
+            ProfileHistogram *histogram = atomic_load_explicit(&profileThread->histograms[i], memory_order_acquire);
+            if (NULL == histogram)
+            {
+                continue;
+            }
+
+            unsigned int j;
+            for (j = 0; j < UL_PROFILE_BUCKETS; j++)
+            {
+                uint64_t bucket = atomic_load_explicit(&histogram->buckets[j], memory_order_relaxed);
+                buckets[j] += bucket;
+                total += bucket;
+            }
+            sum += atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+            uint64_t threadMin = atomic_load_explicit(&histogram->min, memory_order_relaxed);
+            uint64_t threadMax = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+            min = threadMin < min ? threadMin : min;
+            max = threadMax > max ? threadMax : max;
+        }
+
+        if (0 == total)
+        {
+            continue;
+        }
+
+        // Buckets and counters are read while the threads record, count is taken from the buckets
+        UniLogger_CustomLogFn(LOG_LEVEL_PROFILE, "Profile", __LINE__,
+                              "%s: count %llu, min %llu ns, mean %.1f ns, p50 %llu ns, p99 %llu ns, max %llu ns",
+                              s_profileSites[i]->name,
+                              (unsigned long long)total,
+                              (unsigned long long)min,
+                              (double)sum / (double)total,
+                              (unsigned long long)Clamp(Percentile(buckets, total, 0.50), min, max),
+                              (unsigned long long)Clamp(Percentile(buckets, total, 0.99), min, max),
+                              (unsigned long long)max);
+    }
+    pthread_mutex_unlock(&s_profileMutex);
+}
+
+/**
+ * @brief Dump thread, writes the statistics every interval
+ */
+static void *ProfileDumpThread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_wakeMutex);
+    while (!atomic_load(&s_isDumpStopping))
+    {
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += s_dumpInterval;
+
+        if (ETIMEDOUT == pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout) &&
+            !atomic_load(&s_isDumpStopping))
+        {
+            pthread_mutex_unlock(&s_wakeMutex);
+            UniLogger_DumpProfile();
+            pthread_mutex_lock(&s_wakeMutex);
+        }
+    }
+    pthread_mutex_unlock(&s_wakeMutex);
+    return NULL;
+}
+
+int Profile_StartDump(unsigned int interval)
+{
+    if (atomic_load(&s_isDumpRunning) || 0 == interval)
+    {
+        return 0;
+    }
+
+    s_dumpInterval = interval;
+    atomic_store(&s_isDumpStopping, 0);
+    if (0 != pthread_create(&s_dumpThread, NULL, ProfileDumpThread, NULL))
+    {
+        return -1;
+    }
+
+    atomic_store(&s_isDumpRunning, 1);
+    return 0;
+}
+
+void Profile_StopDump()
+{
+    if (!atomic_load(&s_isDumpRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    atomic_store(&s_isDumpStopping, 1);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+    pthread_join(s_dumpThread, NULL);
+
+    atomic_store(&s_isDumpRunning, 0);
+}
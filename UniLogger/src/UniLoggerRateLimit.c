@@ -0,0 +1,175 @@
+/**
+ * @file UniLoggerRateLimit.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Rate limiting of the log call sites for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every rate limited call site has a static UniLoggerRateLimit, updated
+ * with atomic operations only. The token bucket is implemented as generic
+ * cell rate algorithm, the whole state is a single theoretical arrival time.
+ *
+ * The suppressed logs are reported before the next written log of the call
+ * site. A rate limit suppressing logs is registered in a list (never
+ * removed, the rate limits are static), its count is also reported by a
+ * suppressed log once UL_RATE_LIMIT_REPORT_MS passed since the last report,
+ * and by UniLogger_Flush() / UniLogger_CloseLogger(), so the logs of a
+ * call site which is not written again are not lost.
+ */
+// System Include
+#include <time.h>
+
+#include "UniLoggerInternal.h"
+
+// Rate limits which have suppressed logs
+static UniLoggerRateLimit *s_rateLimits = NULL;
+
+/**
+ * @brief Reads the monotonic clock in nanoseconds
+ */
+static inline unsigned long long MonotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+/**
+ * @brief Checks the time based rate limits
+ *
+ * @return int 1 -> write the log, 0 -> suppress the log
+ */
+static int TimeLimitAllows(UniLoggerRateLimit *rateLimit,
+                           enum LogRateLimit kind,
+                           unsigned int value,
+                           unsigned int burst)
+{
+    unsigned long long now = MonotonicNs();
+    unsigned long long current = __atomic_load_n(&rateLimit->timeNs, __ATOMIC_RELAXED);
+
+    if (RATE_LIMIT_EVERY_MS == kind)
+    {
+        unsigned long long interval = (unsigned long long)value * 1000000ULL;
+        do
+        {
+            if (0 != current && now - current < interval)
+            {
+                return 0;
+            }
+        } while (!__atomic_compare_exchange_n(&rateLimit->timeNs, &current, now, 0,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return 1;
+    }
+
+    // Token bucket, one log every interval and burst logs ahead of time
+    unsigned long long interval = 1000000000ULL / (value ? value : 1);
+    unsigned long long tolerance = (burst > 1 ? burst - 1 : 0) * interval;
+    unsigned long long arrival;
+    do
+    {
+        arrival = current > now ? current : now;
+        if (arrival - now > tolerance)
+        {
+            return 0;
+        }
+    } while (!__atomic_compare_exchange_n(&rateLimit->timeNs, &current, arrival + interval, 0,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return 1;
+}
+
+/**
+ * @brief Counts the suppressed log, reports the count if the last report is old
+ */
+static void Suppress(UniLoggerRateLimit *rateLimit)
+{
+    __atomic_fetch_add(&rateLimit->suppressed, 1, __ATOMIC_RELAXED);
+    unsigned long long now = MonotonicNs();
+
+    // Registered once, reported from now on
+    int isRegistered = 0;
+    if (!__atomic_load_n(&rateLimit->isRegistered, __ATOMIC_ACQUIRE) &&
+        __atomic_compare_exchange_n(&rateLimit->isRegistered, &isRegistered, 1, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&rateLimit->reportNs, now, __ATOMIC_RELAXED);
+        UniLoggerRateLimit *head = __atomic_load_n(&s_rateLimits, __ATOMIC_RELAXED);
+        do
+        {
+            rateLimit->next = head;
+        } while (!__atomic_compare_exchange_n(&s_rateLimits, &head, rateLimit, 1,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        return;
+    }
+
+    // Only one of the suppressed logs reports
+    unsigned long long reportNs = __atomic_load_n(&rateLimit->reportNs, __ATOMIC_RELAXED);
+    if (now - reportNs < UL_RATE_LIMIT_REPORT_MS * 1000000ULL ||
+        !__atomic_compare_exchange_n(&rateLimit->reportNs, &reportNs, now, 0,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+    unsigned long long suppressed = __atomic_exchange_n(&rateLimit->suppressed, 0, __ATOMIC_RELAXED);
+    if (suppressed && rateLimit->callSite)
+    {
+        UniLogger_LogSuppressed(rateLimit->callSite, suppressed);
+    }
+}
+
+int UniLogger_RateLimitAllows(UniLoggerRateLimit *rateLimit,
+                              enum LogRateLimit kind,
+                              unsigned int value,
+                              unsigned int burst,
+                              unsigned long long *suppressed)
+{
+    int isAllowed;
+    switch (kind)
+    {
+    case RATE_LIMIT_EVERY_N:
+        isAllowed = 0 == __atomic_fetch_add(&rateLimit->count, 1, __ATOMIC_RELAXED) % (value ? value : 1);
+        break;
+    case RATE_LIMIT_FIRST_N:
+        isAllowed = __atomic_fetch_add(&rateLimit->count, 1, __ATOMIC_RELAXED) < value;
+        break;
+    default:
+        isAllowed = TimeLimitAllows(rateLimit, kind, value, burst);
+        break;
+    }
+
+    if (!isAllowed)
+    {
+        // EVERY_N suppresses N - 1 logs between the written ones, not reported
+        if (RATE_LIMIT_EVERY_N != kind)
+        {
+            Suppress(rateLimit);
+        }
+        return 0;
+    }
+
+    // Suppressed logs are reported with the written log
+    *suppressed = __atomic_load_n(&rateLimit->suppressed, __ATOMIC_RELAXED)
+                      ? __atomic_exchange_n(&rateLimit->suppressed, 0, __ATOMIC_RELAXED)
+                      : 0;
+    return 1;
+}
+
+void RateLimit_Flush()
+{
+    UniLoggerRateLimit *rateLimit;
+    for (rateLimit = __atomic_load_n(&s_rateLimits, __ATOMIC_ACQUIRE); rateLimit; rateLimit = rateLimit->next)
+    {
+        if (0 == __atomic_load_n(&rateLimit->suppressed, __ATOMIC_RELAXED))
+        {
+            continue;
+        }
+        unsigned long long suppressed = __atomic_exchange_n(&rateLimit->suppressed, 0, __ATOMIC_RELAXED);
+        if (suppressed && rateLimit->callSite)
+        {
+            __atomic_store_n(&rateLimit->reportNs, MonotonicNs(), __ATOMIC_RELAXED);
+            UniLogger_LogSuppressed(rateLimit->callSite, suppressed);
+        }
+    }
+}
@@ -0,0 +1,408 @@
+/**
+ * @file UniLoggerRotate.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Log file rotation for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * A background thread keeps the next segment ("<file>.next") opened and
+ * preallocated. The logging thread which crosses the size limit only
+ * replaces the descriptor of the log stream with dup2(), the writes after
+ * it go to the new segment. The swap and the reset of the binary strings
+ * are done under s_logMutex, so no record is written between them. Releasing the preallocated space, renaming
+ * ("<file>" -> "<file>.1" -> ... -> "<file>.N") and removing the old segments
+ * is done by the background thread.
+ */
+// Required for fallocate
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "UniLoggerInternal.h"
+
+// Path of the log file
+static char *s_filePath = NULL;
+// Maximum size of a segment in bytes (0 -> no limit)
+static unsigned long long s_maxSize = 0;
+// Rotation interval in seconds (0 -> no interval)
+static unsigned int s_rotateInterval = 0;
+// Number of rotated segments kept
+static unsigned int s_keepFiles = 0;
+
+// Log stream, its descriptor is replaced at rotation
+static FILE *s_stream = NULL;
+// Descriptor of the log stream
+static int s_streamFd = -1;
+// Duplicate of the active segment, used to release the preallocated space
+static int s_activeFd = -1;
+// Prepared next segment, -1 if not ready
+static atomic_int s_nextFd;
+// Segment activated by a logging thread, -1 if none
+static atomic_int s_swappedFd;
+// Bytes written in the active segment
+static atomic_ullong s_segmentBytes;
+// Flag to check rotation is in progress
+static atomic_int s_isRotating;
+
+// Flag to check rotation thread is running
+static atomic_int s_isRunning;
+// Flag to request the rotation thread to stop
+static atomic_int s_isStopping;
+
+// Rotation thread
+static pthread_t s_rotateThread;
+// Mutex and condition to wake the rotation thread
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Formats the path of the segment
+ *
+ * @param buffer destination buffer
+ * @param bufferSize size of the destination buffer
+ * @param index index of the rotated segment (0 -> active file)
+ */
+static void SegmentPath(char *buffer, size_t bufferSize, unsigned int index)
+{
+    if (0 == index)
+    {
+        snprintf(buffer, bufferSize, "%s", s_filePath);
+    }
+    else
+    {
+        snprintf(buffer, bufferSize, "%s.%u", s_filePath, index);
+    }
+}
+
+/**
+ * @brief Preallocates the space of a segment without changing its size
+ *
+ * @param fd descriptor of the segment
+ */
+static void PreallocateSegment(int fd)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (s_maxSize)
+    {
+        // Failure only means the blocks are allocated while writing
+        (void)fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)s_maxSize);
+    }
+#else
+    (void)fd;
+#endif // FALLOC_FL_KEEP_SIZE
+}
+
+/**
+ * @brief Releases the preallocated space after the end of the segment
+ *
+ * @param fd descriptor of the segment
+ */
+static void ReleaseSegment(int fd)
+{
+    struct stat fileStat;
+    if (s_maxSize && 0 == fstat(fd, &fileStat))
+    {
+        (void)ftruncate(fd, fileStat.st_size);
+    }
+    close(fd);
+}
+
+/**
+ * @brief Opens and preallocates the next segment
+ *
+ * @return int descriptor of the segment, -1 on failure
+ */
+static int PrepareSegment()
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s.next", s_filePath);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    PreallocateSegment(fd);
+
+    // Every segment can be decoded on its own
+    if (ENCODING_BINARY == gCurrLogEncoding)
+    {
+        char header[32];
+        size_t length = EncodeBinaryHeader(header, sizeof(header));
+        if (write(fd, header, length) != (ssize_t)length)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+/**
+ * @brief Makes the prepared segment the active one
+ *
+ * @return unsigned char 1 -> activated, 0 -> no prepared segment or already rotating
+ */
+static unsigned char SwapSegment()
+{
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&s_isRotating, &expected, 1))
+    {
+        return 0;
+    }
+
+    int nextFd = atomic_exchange(&s_nextFd, -1);
+    if (nextFd < 0)
+    {
+        atomic_store(&s_nextFd, nextFd);
+        atomic_store(&s_isRotating, 0);
+        return 0;
+    }
+
+    // No record is written between the swap and the reset of the strings
+    if (gIsMutexInitalized)
+    {
+        pthread_mutex_lock(&s_logMutex);
+        // Pending records are encoded for the old segment
+        GroupCommit_WritePending(s_stream);
+    }
+    int status = dup2(nextFd, s_streamFd);
+    if (status >= 0 && ENCODING_BINARY == gCurrLogEncoding)
+    {
+        // Text of the formats and tags are written again in the new segment
+        BinaryFormat_ResetStrings();
+    }
+    if (gIsMutexInitalized)
+    {
+        pthread_mutex_unlock(&s_logMutex);
+    }
+
+    if (status < 0)
+    {
+        atomic_store(&s_nextFd, nextFd);
+        atomic_store(&s_isRotating, 0);
+        return 0;
+    }
+
+    // Writes from now on go to the new segment
+    atomic_store(&s_segmentBytes, 0);
+    atomic_store(&s_swappedFd, nextFd);
+    return 1;
+}
+
+/**
+ * @brief Renames the segments and removes the segments more than s_keepFiles
+ */
+static void RetainSegments()
+{
+    char fromPath[4096];
+    char toPath[4096];
+
+    // Remove the oldest segment
+    SegmentPath(toPath, sizeof(toPath), s_keepFiles);
+    unlink(toPath);
+
+    // Shift the segments, "<file>" -> "<file>.1" -> ... -> "<file>.N"
+    unsigned int index;
+    for (index = s_keepFiles; index > 0; index--)
+    {
+        SegmentPath(fromPath, sizeof(fromPath), index - 1);
+        SegmentPath(toPath, sizeof(toPath), index);
+        rename(fromPath, toPath);
+    }
+
+    // Activated segment takes the name of the log file
+    snprintf(fromPath, sizeof(fromPath), "%s.next", s_filePath);
+    SegmentPath(toPath, sizeof(toPath), 0);
+    rename(fromPath, toPath);
+}
+
+/**
+ * @brief Finishes the rotation started by SwapSegment()
+ */
+static void CompleteRotation()
+{
+    int swappedFd = atomic_exchange(&s_swappedFd, -1);
+    if (swappedFd < 0)
+    {
+        return;
+    }
+
+    ReleaseSegment(s_activeFd);
+    s_activeFd = swappedFd;
+    RetainSegments();
+    atomic_store(&s_isRotating, 0);
+}
+
+/**
+ * @brief Rotation thread, prepares the segments and removes the old ones
+ */
+static void *RotationThread(void *arg)
+{
+    (void)arg;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    time_t deadline = now.tv_sec + s_rotateInterval;
+
+    pthread_mutex_lock(&s_wakeMutex);
+    while (!atomic_load(&s_isStopping))
+    {
+        pthread_mutex_unlock(&s_wakeMutex);
+
+        CompleteRotation();
+
+        if (atomic_load(&s_nextFd) < 0 && !atomic_load(&s_isRotating))
+        {
+            atomic_store(&s_nextFd, PrepareSegment());
+        }
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        if ((s_rotateInterval && now.tv_sec >= deadline) ||
+            (s_maxSize && atomic_load(&s_segmentBytes) >= s_maxSize))
+        {
+            // Rotate when the interval is over or the logging thread could not
+            if (SwapSegment())
+            {
+                CompleteRotation();
+                atomic_store(&s_nextFd, PrepareSegment());
+            }
+        }
+        if (s_rotateInterval && now.tv_sec >= deadline)
+        {
+            deadline = now.tv_sec + s_rotateInterval;
+        }
+
+        // Wait till the next interval or a rotation by a logging thread
+        struct timespec timeout = {now.tv_sec + 1, now.tv_nsec};
+        if (s_rotateInterval && deadline < timeout.tv_sec)
+        {
+            timeout.tv_sec = deadline;
+            timeout.tv_nsec = 0;
+        }
+
+        pthread_mutex_lock(&s_wakeMutex);
+        if (!atomic_load(&s_isStopping) && atomic_load(&s_swappedFd) < 0)
+        {
+            pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout);
+        }
+    }
+    pthread_mutex_unlock(&s_wakeMutex);
+
+    CompleteRotation();
+    return NULL;
+}
+
+int Rotation_Start(FILE *stream,
+                   const char *filePath,
+                   unsigned long long maxSize,
+                   unsigned int rotateInterval,
+                   unsigned int keepFiles)
+{
+    if (atomic_load(&s_isRunning) || (0 == maxSize && 0 == rotateInterval))
+    {
+        return 0;
+    }
+
+    s_filePath = strdup(filePath);
+    if (NULL == s_filePath)
+    {
+        return -1;
+    }
+    s_maxSize = maxSize;
+    s_rotateInterval = rotateInterval;
+    s_keepFiles = keepFiles;
+    s_stream = stream;
+    s_streamFd = fileno(stream);
+    s_activeFd = dup(s_streamFd);
+    if (s_activeFd < 0)
+    {
+        free(s_filePath);
+        s_filePath = NULL;
+        return -1;
+    }
+    PreallocateSegment(s_activeFd);
+
+    struct stat fileStat;
+    atomic_store(&s_segmentBytes, 0 == fstat(s_activeFd, &fileStat) ? (unsigned long long)fileStat.st_size : 0);
+    atomic_store(&s_nextFd, -1);
+    atomic_store(&s_swappedFd, -1);
+    atomic_store(&s_isRotating, 0);
+    atomic_store(&s_isStopping, 0);
+
+    if (0 != pthread_create(&s_rotateThread, NULL, RotationThread, NULL))
+    {
+        close(s_activeFd);
+        s_activeFd = -1;
+        free(s_filePath);
+        s_filePath = NULL;
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char Rotation_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+void Rotation_AddBytes(size_t length)
+{
+    unsigned long long written = atomic_fetch_add_explicit(&s_segmentBytes, length, memory_order_relaxed) + length;
+    if (0 == s_maxSize || written < s_maxSize ||
+        atomic_load_explicit(&s_isRotating, memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Only the descriptor is replaced, remaining work is done by the rotation thread
+    if (SwapSegment())
+    {
+        pthread_mutex_lock(&s_wakeMutex);
+        pthread_cond_signal(&s_wakeCond);
+        pthread_mutex_unlock(&s_wakeMutex);
+    }
+}
+
+void Rotation_Stop()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    atomic_store(&s_isStopping, 1);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+    pthread_join(s_rotateThread, NULL);
+
+    // Remove the unused next segment
+    int nextFd = atomic_exchange(&s_nextFd, -1);
+    if (nextFd >= 0)
+    {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s.next", s_filePath);
+        close(nextFd);
+        unlink(path);
+    }
+
+    ReleaseSegment(s_activeFd);
+    s_activeFd = -1;
+    s_stream = NULL;
+    s_streamFd = -1;
+    free(s_filePath);
+    s_filePath = NULL;
+    atomic_store(&s_isRunning, 0);
+}
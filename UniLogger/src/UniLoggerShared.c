@@ -0,0 +1,387 @@
+/**
+ * @file UniLoggerShared.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Shared memory ring of the processes for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Processes (pre-forked workers) format their records directly into the
+ * slots of a ring in a POSIX shared memory object, claimed with the same
+ * sequence numbered scheme as the asynchronous queue. unilogger-collector
+ * drains the ring to one file in timestamp order, the processes never
+ * write the file. A record is published with a compare and swap of the
+ * sequence, so a slot skipped by the collector (process died after
+ * claiming it) is never published late. If the ring stays full (collector
+ * is down) the records are dropped after UL_SHARED_WAIT_MS. A record longer
+ * than a slot is formatted in an allocated buffer and split into parts in
+ * contiguous slots, the first claimed slot is published empty. Records
+ * longer than half the ring are dropped.
+ */
+// System Include
+#include <stdint.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "UniLoggerInternal.h"
+
+// Mapped ring
+static SharedRingHeader *s_header = NULL;
+// Size of the mapping
+static size_t s_mapSize = 0;
+// Descriptor of the shared memory object
+static int s_fd = -1;
+// Flag set when the ring stayed full for UL_SHARED_WAIT_MS, records are dropped without waiting
+static unsigned char s_isRingStalled = 0;
+
+SharedRingHeader *SharedRing_Map(const char *name, unsigned int slotCount, size_t *mapSize, int *fd)
+{
+    char shmName[256];
+    int written = snprintf(shmName, sizeof(shmName), "%s%s", ('/' == name[0]) ? "" : "/", name);
+    if (written < 0 || (size_t)written >= sizeof(shmName))
+    {
+        return NULL;
+    }
+
+    // Capacity must be power of 2
+    uint32_t capacity = 2;
+    while (capacity < slotCount)
+    {
+        capacity <<= 1;
+    }
+
+    SharedRingHeader *header = NULL;
+    size_t size = sizeof(SharedRingHeader) + (size_t)capacity * sizeof(SharedRingSlot);
+    int shmFd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0660);
+    if (shmFd >= 0)
+    {
+        // Created, initalized before it is marked ready
+        header = (0 == ftruncate(shmFd, (off_t)size))
+                     ? (SharedRingHeader *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0)
+                     : (SharedRingHeader *)MAP_FAILED;
+        if (MAP_FAILED == header)
+        {
+            close(shmFd);
+            shm_unlink(shmName);
+            return NULL;
+        }
+
+        memcpy(header->magic, UL_SHARED_MAGIC, sizeof(UL_SHARED_MAGIC));
+        header->version = UL_SHARED_VERSION;
+        header->slotCount = capacity;
+        header->slotSize = sizeof(SharedRingSlot);
+        uint64_t pos;
+        for (pos = 0; pos < capacity; pos++)
+        {
+            SharedRing_Slot(header, pos)->sequence = pos;
+        }
+        __atomic_store_n(&header->state, 1, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        if (EEXIST != errno || (shmFd = shm_open(shmName, O_RDWR | O_CLOEXEC, 0)) < 0)
+        {
+            return NULL;
+        }
+
+        // Wait till the creator has initalized the ring
+        unsigned int retry;
+        struct stat shmStat;
+        for (retry = 0; retry < 1000; retry++)
+        {
+            if (0 == fstat(shmFd, &shmStat) && (size_t)shmStat.st_size >= sizeof(SharedRingHeader))
+            {
+                break;
+            }
+            struct timespec delay = {0, 1000 * 1000};
+            nanosleep(&delay, NULL);
+        }
+        header = (retry < 1000)
+                     ? (SharedRingHeader *)mmap(NULL, sizeof(SharedRingHeader), PROT_READ | PROT_WRITE,
+                                                MAP_SHARED, shmFd, 0)
+                     : (SharedRingHeader *)MAP_FAILED;
+        for (retry = 0; MAP_FAILED != header && retry < 1000; retry++)
+        {
+            if (__atomic_load_n(&header->state, __ATOMIC_ACQUIRE))
+            {
+                break;
+            }
+            struct timespec delay = {0, 1000 * 1000};
+            nanosleep(&delay, NULL);
+        }
+        if (MAP_FAILED == header)
+        {
+            close(shmFd);
+            return NULL;
+        }
+
+        // Ring of another version or record size can not be shared
+        capacity = header->slotCount;
+        size = sizeof(SharedRingHeader) + (size_t)capacity * sizeof(SharedRingSlot);
+        unsigned char isValid = retry < 1000 &&
+                                0 == memcmp(header->magic, UL_SHARED_MAGIC, sizeof(UL_SHARED_MAGIC)) &&
+                                UL_SHARED_VERSION == header->version &&
+                                sizeof(SharedRingSlot) == header->slotSize &&
+                                0 != capacity && 0 == (capacity & (capacity - 1)) &&
+                                0 == fstat(shmFd, &shmStat) && (size_t)shmStat.st_size >= size;
+        munmap(header, sizeof(SharedRingHeader));
+        header = isValid ? (SharedRingHeader *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0)
+                         : (SharedRingHeader *)MAP_FAILED;
+        if (MAP_FAILED == header)
+        {
+            close(shmFd);
+            return NULL;
+        }
+    }
+
+    *mapSize = size;
+    *fd = shmFd;
+    return header;
+}
+
+void SharedRing_WakeCollector(SharedRingHeader *header)
+{
+    // Futex of the shared mapping (not private), the collector waits on the sequence
+    __atomic_fetch_add(&header->wakeSequence, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &header->wakeSequence, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+int SharedRing_Start(const char *name, unsigned int slotCount)
+{
+    if (s_header)
+    {
+        return 0;
+    }
+
+    SharedRingHeader *header = SharedRing_Map(name, slotCount, &s_mapSize, &s_fd);
+    if (NULL == header)
+    {
+        return -1;
+    }
+    __atomic_store_n(&s_header, header, __ATOMIC_RELEASE);
+    return 0;
+}
+
+unsigned char SharedRing_IsRunning()
+{
+    return NULL != __atomic_load_n(&s_header, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Claims contiguous free slots for writing
+ * Slots are released in order by the collector, the last slot is free only if all of them are free
+ *
+ * @param header mapped ring
+ * @param count number of slots
+ * @param pos position of the first claimed slot
+ * @return SharedRingSlot* first claimed slot, NULL if ring is full
+ */
+static SharedRingSlot *ClaimSlots(SharedRingHeader *header, uint32_t count, uint64_t *pos)
+{
+    uint64_t currPos = __atomic_load_n(&header->enqueuePos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        SharedRingSlot *slot = SharedRing_Slot(header, currPos + count - 1);
+        uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - (currPos + count - 1));
+        if (0 == diff)
+        {
+            if (__atomic_compare_exchange_n(&header->enqueuePos, &currPos, currPos + count, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *pos = currPos;
+                return SharedRing_Slot(header, currPos);
+            }
+        }
+        else if (diff < 0)
+        {
+            // Ring is full
+            return NULL;
+        }
+        else
+        {
+            currPos = __atomic_load_n(&header->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Claims contiguous free slots, waits for the collector if the ring is full
+ *
+ * @param header mapped ring
+ * @param count number of slots
+ * @param pos position of the first claimed slot
+ * @return SharedRingSlot* first claimed slot, NULL if the ring stays full
+ */
+static SharedRingSlot *WaitSlots(SharedRingHeader *header, uint32_t count, uint64_t *pos)
+{
+    SharedRingSlot *slot;
+    unsigned long long start = 0;
+    while (NULL == (slot = ClaimSlots(header, count, pos)))
+    {
+        // Wait for the collector, records are dropped if it is down
+        unsigned long long now = Stats_Now();
+        if (0 == start)
+        {
+            start = now;
+        }
+        if (__atomic_load_n(&s_isRingStalled, __ATOMIC_RELAXED) || now - start >= UL_SHARED_WAIT_MS * 1000000ULL)
+        {
+            __atomic_store_n(&s_isRingStalled, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+        SharedRing_WakeCollector(header);
+        sched_yield();
+    }
+    if (__atomic_load_n(&s_isRingStalled, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&s_isRingStalled, 0, __ATOMIC_RELAXED);
+    }
+    return slot;
+}
+
+/**
+ * @brief Publishes the filled slot to the collector
+ *
+ * @return int 0 -> Success, -1 -> the collector has skipped the slot
+ */
+static int PublishSlot(SharedRingSlot *slot, uint64_t pos, uint64_t time)
+{
+    slot->time = time;
+    slot->pid = (uint32_t)getpid();
+    uint64_t expected = pos;
+    return __atomic_compare_exchange_n(&slot->sequence, &expected, pos + 1, 0,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED) ? 0 : -1;
+}
+
+/**
+ * @brief Writes the record longer than a slot in parts to contiguous slots
+ *
+ * @param header mapped ring
+ * @param record formatted record
+ * @param length length of the record
+ * @param time time of the record
+ * @return int 0 -> Success, -1 -> the record is dropped
+ */
+static int PushParts(SharedRingHeader *header, const char *record, size_t length, uint64_t time)
+{
+    SharedRingSlot *slot;
+    size_t count = (length + sizeof(slot->data) - 1) / sizeof(slot->data);
+    uint64_t pos;
+    if (count > header->slotCount / 2 || NULL == (slot = WaitSlots(header, (uint32_t)count, &pos)))
+    {
+        return -1;
+    }
+
+    int status = 0;
+    size_t offset = 0;
+    uint32_t i;
+    for (i = 0; i < count; i++)
+    {
+        slot = SharedRing_Slot(header, pos + i);
+        slot->length = (uint32_t)((length - offset < sizeof(slot->data)) ? length - offset : sizeof(slot->data));
+        slot->partIndex = (uint16_t)i;
+        slot->partCount = (uint16_t)count;
+        memcpy(slot->data, record + offset, slot->length);
+        offset += slot->length;
+        status |= PublishSlot(slot, pos + i, time);
+    }
+    return status;
+}
+
+void SharedRing_Push(const UniLoggerCallSite *callSite, va_list args, const char *format)
+{
+    SharedRingHeader *header = s_header;
+    uint64_t pos;
+    SharedRingSlot *slot = WaitSlots(header, 1, &pos);
+    if (NULL == slot)
+    {
+        __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+        Stats_DropRecord(callSite->level);
+        return;
+    }
+
+    // String ids of the binary records are addresses of the process, written as text
+    char *overflow;
+    size_t length = FormatQueuedRecord(slot->data, sizeof(slot->data), callSite, args, format,
+                                       (ENCODING_BINARY == gCurrLogEncoding) ? ENCODING_TEXT : gCurrLogEncoding,
+                                       &overflow);
+
+    // Time of the formatted record, the collector writes the records in this order
+    struct timespec recordTime;
+    Timestamp_Last(&recordTime);
+    uint64_t time = (uint64_t)recordTime.tv_sec * 1000000000ULL + (uint64_t)recordTime.tv_nsec;
+
+    // Longer record follows in parts, the claimed slot is published empty
+    slot->length = overflow ? 0 : (uint32_t)length;
+    slot->partIndex = 0;
+    slot->partCount = 1;
+    int status = PublishSlot(slot, pos, time);
+    if (overflow)
+    {
+        status |= PushParts(header, overflow, length, time);
+        free(overflow);
+    }
+
+    // Fails if the collector has skipped a slot, or the parts do not fit in the ring
+    if (0 != status)
+    {
+        __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+        Stats_DropRecord(callSite->level);
+        return;
+    }
+
+    // Wake the collector only if it is waiting
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->isCollectorIdle, __ATOMIC_RELAXED))
+    {
+        SharedRing_WakeCollector(header);
+    }
+}
+
+void SharedRing_Flush()
+{
+    SharedRingHeader *header = s_header;
+    if (NULL == header)
+    {
+        return;
+    }
+
+    // Wait till the records claimed till now are taken, bounded if the collector is down
+    uint64_t target = __atomic_load_n(&header->enqueuePos, __ATOMIC_ACQUIRE);
+    unsigned int retry;
+    for (retry = 0; retry < UL_SHARED_STALL_MS * 10; retry++)
+    {
+        if ((int64_t)(__atomic_load_n(&header->dequeuePos, __ATOMIC_ACQUIRE) - target) >= 0)
+        {
+            break;
+        }
+        struct timespec delay = {0, 100 * 1000};
+        SharedRing_WakeCollector(header);
+        nanosleep(&delay, NULL);
+    }
+}
+
+void SharedRing_Stop()
+{
+    SharedRingHeader *header = s_header;
+    if (NULL == header)
+    {
+        return;
+    }
+
+    __atomic_store_n(&s_header, NULL, __ATOMIC_RELEASE);
+    munmap(header, s_mapSize);
+    close(s_fd);
+    s_fd = -1;
+    s_mapSize = 0;
+}
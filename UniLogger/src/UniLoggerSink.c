@@ -0,0 +1,199 @@
+/**
+ * @file UniLoggerSink.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Sinks of UniLogger (console, file and custom)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every record is formatted once without color codes. The color codes of a
+ * level are stored apart from the record, colored sinks write them around
+ * the record with writev(), plain sinks write the record as it is. Every
+ * sink has its own level mask, checked before the write.
+ */
+// System Include
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Reset of the color codes, written before the newline
+ */
+static const char s_colorReset[] = "\033[1;0m\n";
+
+/**
+ * @brief Sink of the logs
+ */
+typedef struct Sink
+{
+    // Descriptor of the sink, -1 for the function sinks
+    int fd;
+    // Stream flushed before the writes, so that its output is written first
+    FILE *stream;
+    // Flag to close the descriptor with the sink
+    unsigned char isOwningFd;
+    // Flag to write the color codes
+    unsigned char isColored;
+    // Function of the sink
+    UniLoggerSinkFn sinkFn;
+    // Context of the function
+    void *context;
+    // Level mask of the sink
+    unsigned int levelMask;
+} Sink;
+
+// Sinks, added only till UniLogger_CloseLogger()
+static Sink s_sinks[UL_MAX_SINKS];
+// Number of the sinks, published after the sink is filled
+static atomic_uint s_sinkCount;
+// Mutex for adding the sinks
+static pthread_mutex_t s_sinkMutex = PTHREAD_MUTEX_INITIALIZER;
+
+int LogRecord_ColoredVectors(const LogRecord *record, struct iovec vectors[3])
+{
+    vectors[0].iov_base = (void *)colorCodes[record->level];
+    vectors[0].iov_len = strlen(colorCodes[record->level]);
+    // Record without its newline, the reset ends the line
+    vectors[1].iov_base = (void *)record->data;
+    vectors[1].iov_len = record->length - 1;
+    vectors[2].iov_base = (void *)s_colorReset;
+    vectors[2].iov_len = sizeof(s_colorReset) - 1;
+    return 3;
+}
+
+size_t LogRecord_Copy(char *buffer, const LogRecord *record, unsigned char isColored)
+{
+    // Binary records and empty records are copied as they are
+    if (!isColored || LOG_LEVEL_OFF == record->level || 0 == record->length)
+    {
+        memcpy(buffer, record->data, record->length);
+        return record->length;
+    }
+
+    struct iovec vectors[3];
+    int count = LogRecord_ColoredVectors(record, vectors);
+    size_t length = 0;
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        memcpy(buffer + length, vectors[i].iov_base, vectors[i].iov_len);
+        length += vectors[i].iov_len;
+    }
+    return length;
+}
+
+void LogRecord_Write(FILE *stream, const LogRecord *record, unsigned char isColored)
+{
+    if (!isColored || LOG_LEVEL_OFF == record->level || 0 == record->length)
+    {
+        WriteLogData(stream, record->data, record->length);
+        return;
+    }
+
+    struct iovec vectors[3];
+    int count = LogRecord_ColoredVectors(record, vectors);
+    WriteLogVectors(stream, vectors, count);
+}
+
+unsigned char Sinks_IsActive()
+{
+    return 0 != atomic_load_explicit(&s_sinkCount, memory_order_relaxed);
+}
+
+/**
+ * @brief Adds the sink to the registry
+ *
+ * @param sink sink to be added
+ * @return int 0 -> Success, -1 -> no free sink
+ */
+static int AddSink(const Sink *sink)
+{
+    int status = -1;
+    pthread_mutex_lock(&s_sinkMutex);
+    unsigned int count = atomic_load_explicit(&s_sinkCount, memory_order_relaxed);
+    if (count < UL_MAX_SINKS)
+    {
+        s_sinks[count] = *sink;
+        // Writers see the sink only after it is filled
+        atomic_store_explicit(&s_sinkCount, count + 1, memory_order_release);
+        status = 0;
+    }
+    pthread_mutex_unlock(&s_sinkMutex);
+    return status;
+}
+
+int Sinks_AddFd(int fd, FILE *stream, unsigned char isOwningFd, unsigned char isColored, unsigned int levelMask)
+{
+    Sink sink = {fd, stream, isOwningFd, isColored, NULL, NULL, levelMask};
+    return AddSink(&sink);
+}
+
+int Sinks_AddFn(UniLoggerSinkFn sinkFn, void *context, unsigned int levelMask)
+{
+    Sink sink = {-1, NULL, 0, 0, sinkFn, context, levelMask};
+    return AddSink(&sink);
+}
+
+void Sinks_Write(const LogRecord *record)
+{
+    // Binary records are written only to the Log Stream
+    if (LOG_LEVEL_OFF == record->level || 0 == record->length)
+    {
+        return;
+    }
+
+    unsigned int count = atomic_load_explicit(&s_sinkCount, memory_order_acquire);
+    unsigned int bit = 1u << record->level;
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        const Sink *sink = &s_sinks[i];
+        if (!(sink->levelMask & bit))
+        {
+            continue;
+        }
+
+        if (sink->sinkFn)
+        {
+            sink->sinkFn(sink->context, record->level, record->data, record->length);
+            continue;
+        }
+
+        if (sink->stream)
+        {
+            fflush(sink->stream);
+        }
+
+        // Single writev per record, logs of other threads are not interleaved
+        struct iovec vectors[3];
+        int vectorCount = 1;
+        if (sink->isColored)
+        {
+            vectorCount = LogRecord_ColoredVectors(record, vectors);
+        }
+        else
+        {
+            vectors[0].iov_base = (void *)record->data;
+            vectors[0].iov_len = record->length;
+        }
+        WriteVectors(sink->fd, vectors, vectorCount);
+    }
+}
+
+void Sinks_Close()
+{
+    pthread_mutex_lock(&s_sinkMutex);
+    unsigned int count = atomic_exchange(&s_sinkCount, 0);
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        if (s_sinks[i].isOwningFd)
+        {
+            close(s_sinks[i].fd);
+        }
+    }
+    pthread_mutex_unlock(&s_sinkMutex);
+}
@@ -0,0 +1,917 @@
+/**
+ * @file UniLoggerSocket.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Socket Log Stream (Unix / UDP / TCP) for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Writes of the Log Stream are copied into a bounded pending buffer, the
+ * callers never touch the socket. A sender thread swaps the pending buffer
+ * with its own and sends the records: one datagram per record, many
+ * datagrams per sendmmsg() for the datagram sockets, the bytes as they are
+ * for the stream sockets. While the collector is down the records stay in
+ * the buffers and the sender reconnects with a growing delay, records
+ * which do not fit into the pending buffer are dropped and reported after
+ * the next successful send. With binary encoding every connection starts
+ * with the binary header and the string records taken by the sender so far,
+ * so the records buffered across a reconnect still find their formats and
+ * tags. Later records write their formats and tags again.
+ */
+// sendmmsg()
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+// System Include
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "UniLoggerInternal.h"
+
+// Address of the collector
+static struct sockaddr_storage s_address;
+// Length of the address
+static socklen_t s_addressLength = 0;
+// Type of the socket (SOCK_DGRAM or SOCK_STREAM)
+static int s_socketType = SOCK_DGRAM;
+// Descriptor of the connected socket, -1 while disconnected
+static int s_fd = -1;
+// Placeholder of the Log Stream, its writes are sent by the sender
+static FILE *s_stream = NULL;
+
+// Buffer filled by the callers
+static char *s_pendingBuffer = NULL;
+// Bytes in the pending buffer
+static size_t s_pendingLength = 0;
+// Buffer sent by the sender thread
+static char *s_sendBuffer = NULL;
+// Bytes in the send buffer
+static size_t s_sendLength = 0;
+// Bytes of the send buffer already sent
+static size_t s_sendOffset = 0;
+// Size of every buffer
+static size_t s_bufferSize = 0;
+
+// String records of the binary encoding taken by the sender, sent at every connection
+static char *s_strings = NULL;
+// Bytes of the string records
+static size_t s_stringsLength = 0;
+// Size of the string records buffer
+static size_t s_stringsCapacity = 0;
+// Ids of the kept strings (open addressing, 0 -> free)
+static uint64_t *s_stringIds = NULL;
+
+// Records dropped because the pending buffer was full, or not accepted by the collector
+static unsigned long long s_dropped = 0;
+// Dropped records already reported
+static unsigned long long s_droppedReported = 0;
+
+// Mutex of the buffers
+static pthread_mutex_t s_socketMutex = PTHREAD_MUTEX_INITIALIZER;
+// Condition to wake the sender thread
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+// Condition signalled when the sender has nothing to send
+static pthread_cond_t s_drainCond = PTHREAD_COND_INITIALIZER;
+// Flag set while the sender waits for records
+static unsigned char s_isSenderIdle = 0;
+// Flag to request the sender thread to stop
+static unsigned char s_isStopping = 0;
+// Sender thread
+static pthread_t s_senderThread;
+
+// Flag to check socket is running
+static atomic_int s_isRunning;
+// Flag to check socket is connected
+static atomic_int s_isConnected;
+
+/**
+ * @brief Parses the address of the collector
+ * "unix:<path>" and "unix-stream:<path>" for Unix sockets,
+ * "udp:<host>:<port>" and "tcp:<host>:<port>" for IP sockets ("[<ipv6>]:<port>")
+ *
+ * @param address address of the collector
+ * @return int 0 on success, -1 on invalid address
+ */
+static int ParseAddress(const char *address)
+{
+    memset(&s_address, 0, sizeof(s_address));
+
+    const char *path = NULL;
+    if (0 == strncmp(address, "unix:", 5))
+    {
+        path = address + 5;
+        s_socketType = SOCK_DGRAM;
+    }
+    else if (0 == strncmp(address, "unix-stream:", 12))
+    {
+        path = address + 12;
+        s_socketType = SOCK_STREAM;
+    }
+    if (path)
+    {
+        struct sockaddr_un *unixAddress = (struct sockaddr_un *)&s_address;
+        size_t pathLength = strlen(path);
+        if (0 == pathLength || pathLength >= sizeof(unixAddress->sun_path))
+        {
+            return -1;
+        }
+        unixAddress->sun_family = AF_UNIX;
+        memcpy(unixAddress->sun_path, path, pathLength + 1);
+        s_addressLength = (socklen_t)sizeof(struct sockaddr_un);
+        return 0;
+    }
+
+    if (0 == strncmp(address, "udp:", 4))
+    {
+        s_socketType = SOCK_DGRAM;
+    }
+    else if (0 == strncmp(address, "tcp:", 4))
+    {
+        s_socketType = SOCK_STREAM;
+    }
+    else
+    {
+        return -1;
+    }
+
+    // Port is after the last ':', IPv6 hosts are in brackets
+    char host[256];
+    const char *hostStart = address + 4;
+    const char *portStart = strrchr(hostStart, ':');
+    if (NULL == portStart || '\0' == portStart[1])
+    {
+        return -1;
+    }
+    size_t hostLength = (size_t)(portStart - hostStart);
+    if ('[' == hostStart[0] && hostLength >= 2 && ']' == hostStart[hostLength - 1])
+    {
+        hostStart++;
+        hostLength -= 2;
+    }
+    if (0 == hostLength || hostLength >= sizeof(host))
+    {
+        return -1;
+    }
+    memcpy(host, hostStart, hostLength);
+    host[hostLength] = '\0';
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = s_socketType;
+    struct addrinfo *result = NULL;
+    if (0 != getaddrinfo(host, portStart + 1, &hints, &result) || NULL == result)
+    {
+        return -1;
+    }
+    memcpy(&s_address, result->ai_addr, result->ai_addrlen);
+    s_addressLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    return 0;
+}
+
+/**
+ * @brief Adds the id of the string to the kept strings
+ *
+ * @param id id of the string
+ * @return unsigned char 1 -> added, 0 -> already kept or no space
+ */
+static unsigned char AddStringId(uint64_t id)
+{
+    if (NULL == s_stringIds)
+    {
+        s_stringIds = (uint64_t *)calloc(UL_SOCKET_MAX_STRINGS, sizeof(uint64_t));
+        if (NULL == s_stringIds)
+        {
+            return 0;
+        }
+    }
+
+    size_t index = (size_t)((id >> 3) * 0x9E3779B97F4A7C15ULL) % UL_SOCKET_MAX_STRINGS;
+    size_t probe;
+    for (probe = 0; probe < UL_SOCKET_MAX_STRINGS; probe++)
+    {
+        uint64_t *entry = &s_stringIds[(index + probe) % UL_SOCKET_MAX_STRINGS];
+        if (*entry == id)
+        {
+            return 0;
+        }
+        if (0 == *entry)
+        {
+            *entry = id;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Keeps a copy of the string records of the binary records, called by the sender thread
+ *
+ * @param data binary records
+ * @param length length of the records
+ */
+static void KeepStrings(const char *data, size_t length)
+{
+    while (length)
+    {
+        size_t recordLength = BinaryFormat_RecordLength(data, length);
+        if (0 == recordLength)
+        {
+            break;
+        }
+
+        uint64_t id;
+        if (BinaryFormat_HasStrings(data, recordLength) && recordLength >= 2 + sizeof(id))
+        {
+            memcpy(&id, data + 2, sizeof(id));
+            if (s_stringsLength + recordLength > s_stringsCapacity)
+            {
+                size_t capacity = s_stringsCapacity ? s_stringsCapacity * 2 : 4096;
+                while (capacity < s_stringsLength + recordLength)
+                {
+                    capacity *= 2;
+                }
+                char *strings = (char *)realloc(s_strings, capacity);
+                if (strings)
+                {
+                    s_strings = strings;
+                    s_stringsCapacity = capacity;
+                }
+            }
+            if (s_stringsLength + recordLength <= s_stringsCapacity && AddStringId(id))
+            {
+                memcpy(s_strings + s_stringsLength, data, recordLength);
+                s_stringsLength += recordLength;
+            }
+        }
+        data += recordLength;
+        length -= recordLength;
+    }
+}
+
+/**
+ * @brief Sends all the bytes to the connected socket
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int SendAll(int fd, const char *data, size_t length)
+{
+    while (length)
+    {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+/**
+ * @brief Connects to the collector, called by the sender thread
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int Connect()
+{
+    int fd = socket(s_address.ss_family, s_socketType | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Sender is not blocked for long by a collector which stopped reading
+    struct timeval timeout = {UL_SOCKET_SEND_TIMEOUT_MS / 1000, (UL_SOCKET_SEND_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (0 != connect(fd, (const struct sockaddr *)&s_address, s_addressLength))
+    {
+        close(fd);
+        return -1;
+    }
+
+    // Collector decodes every connection on its own, buffered records use the strings of the previous connections
+    if (SOCK_STREAM == s_socketType && ENCODING_BINARY == gCurrLogEncoding)
+    {
+        char header[32];
+        size_t length = EncodeBinaryHeader(header, sizeof(header));
+        if (0 != SendAll(fd, header, length) || 0 != SendAll(fd, s_strings, s_stringsLength))
+        {
+            close(fd);
+            return -1;
+        }
+        BinaryFormat_ResetStrings();
+    }
+
+    s_fd = fd;
+    atomic_store(&s_isConnected, 1);
+    return 0;
+}
+
+/**
+ * @brief Closes the socket after a failed send
+ */
+static void Disconnect()
+{
+    atomic_store(&s_isConnected, 0);
+    close(s_fd);
+    s_fd = -1;
+}
+
+/**
+ * @brief Gets the level of the record from its level name, LOG_LEVEL_OFF if not found
+ */
+static enum LogLevel TextRecordLevel(const char *data, size_t length)
+{
+    // Level name follows "]:[" in the text records and "level" in the JSON / logfmt records
+    static const char *const markers[] = {"]:[", "\"level\":\"", " level="};
+    const char *end = data + length;
+    size_t i;
+    for (i = 0; i < sizeof(markers) / sizeof(markers[0]); i++)
+    {
+        const char *name = (const char *)memmem(data, length, markers[i], strlen(markers[i]));
+        if (NULL == name)
+        {
+            continue;
+        }
+        name += strlen(markers[i]);
+        while (name < end && ' ' == *name)
+        {
+            name++;
+        }
+
+        unsigned int level;
+        for (level = LOG_LEVEL_FATAL; level < LOG_MAX_LEVEL; level++)
+        {
+            const char *levelName = logLevelNames[level];
+            while (' ' == *levelName)
+            {
+                levelName++;
+            }
+            size_t nameLength = strcspn(levelName, " ");
+            if ((size_t)(end - name) > nameLength && 0 == memcmp(name, levelName, nameLength) &&
+                (' ' == name[nameLength] || ']' == name[nameLength] || '"' == name[nameLength]))
+            {
+                return (enum LogLevel)level;
+            }
+        }
+        return LOG_LEVEL_OFF;
+    }
+    return LOG_LEVEL_OFF;
+}
+
+/**
+ * @brief Counts the log records of the data (lines, binary log records)
+ *
+ * @param data records
+ * @param length length of the records
+ * @param isDropped flag to count the records as dropped in the statistics, by their level
+ * @return unsigned long long number of the log records
+ */
+static unsigned long long CountRecords(const char *data, size_t length, unsigned char isDropped)
+{
+    unsigned long long count = 0;
+    unsigned char isBinary = (ENCODING_BINARY == gCurrLogEncoding);
+    while (length)
+    {
+        size_t recordLength;
+        if (isBinary)
+        {
+            recordLength = BinaryFormat_RecordLength(data, length);
+        }
+        else
+        {
+            const char *newline = (const char *)memchr(data, '\n', length);
+            recordLength = newline ? (size_t)(newline - data) + 1 : 0;
+        }
+        if (0 == recordLength)
+        {
+            break;
+        }
+
+        // Header and string records of the binary encoding are not logs
+        enum LogLevel level = LOG_LEVEL_OFF;
+        unsigned char isLog = 1;
+        if (isBinary && UL_BINARY_MARKER == (uint8_t)data[0])
+        {
+            isLog = (UL_BINARY_LOG == (uint8_t)data[1]);
+            if (isLog && (uint8_t)data[2] < LOG_MAX_LEVEL)
+            {
+                level = (enum LogLevel)(uint8_t)data[2];
+            }
+        }
+        else
+        {
+            level = TextRecordLevel(data, recordLength);
+        }
+
+        if (isLog)
+        {
+            count++;
+            if (isDropped && LOG_LEVEL_OFF != level)
+            {
+                Stats_DropRecord(level);
+            }
+            else if (isDropped)
+            {
+                Stats_AddRecord(STATS_DROPPED, LOG_LEVEL_OFF);
+            }
+        }
+        data += recordLength;
+        length -= recordLength;
+    }
+    return count;
+}
+
+/**
+ * @brief Gets the offset of the first record starting at or after the offset in the send buffer
+ * The send buffer starts with a record, the writes are copied as a whole
+ */
+static size_t NextRecordStart(size_t offset)
+{
+    if (ENCODING_BINARY != gCurrLogEncoding)
+    {
+        if (0 == offset || '\n' == s_sendBuffer[offset - 1])
+        {
+            return offset;
+        }
+        const char *newline = (const char *)memchr(s_sendBuffer + offset, '\n', s_sendLength - offset);
+        return newline ? (size_t)(newline - s_sendBuffer) + 1 : s_sendLength;
+    }
+
+    size_t start = 0;
+    while (start < offset)
+    {
+        size_t length = BinaryFormat_RecordLength(s_sendBuffer + start, s_sendLength - start);
+        if (0 == length)
+        {
+            return s_sendLength;
+        }
+        start += length;
+    }
+    return start;
+}
+
+/**
+ * @brief Gets the offset after the record (and its newline) in the send buffer
+ */
+static inline size_t RecordEnd(const struct iovec *vector)
+{
+    size_t end = (size_t)((char *)vector->iov_base - s_sendBuffer) + vector->iov_len + 1;
+    return end > s_sendLength ? s_sendLength : end;
+}
+
+/**
+ * @brief Sends the records of the send buffer as datagrams, many per sendmmsg()
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int SendDatagrams()
+{
+    struct mmsghdr messages[UL_SOCKET_BATCH_SIZE];
+    struct iovec vectors[UL_SOCKET_BATCH_SIZE];
+    while (s_sendOffset < s_sendLength)
+    {
+        // One datagram per record, without its newline
+        unsigned int count = 0;
+        size_t offset = s_sendOffset;
+        while (count < UL_SOCKET_BATCH_SIZE && offset < s_sendLength)
+        {
+            char *record = s_sendBuffer + offset;
+            char *newline = (char *)memchr(record, '\n', s_sendLength - offset);
+            size_t length = newline ? (size_t)(newline - record) : s_sendLength - offset;
+            offset += length + (newline ? 1 : 0);
+            if (0 == length)
+            {
+                continue;
+            }
+
+            vectors[count].iov_base = record;
+            vectors[count].iov_len = length;
+            memset(&messages[count], 0, sizeof(messages[count]));
+            messages[count].msg_hdr.msg_iov = &vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        if (0 == count)
+        {
+            s_sendOffset = offset;
+            break;
+        }
+
+        unsigned long long start = Stats_Now();
+        int sent = sendmmsg(s_fd, messages, count, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            Stats_AddWrite(0, Stats_Now() - start, 1);
+            if (sent < 0 && EINTR == errno)
+            {
+                continue;
+            }
+            if (sent < 0 && EMSGSIZE == errno)
+            {
+                // Record larger than a datagram, skipped
+                s_sendOffset = RecordEnd(&vectors[0]);
+                s_dropped++;
+                continue;
+            }
+            if (sent < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+            {
+                // Collector is slow, sent again after the delay
+                return -1;
+            }
+            Disconnect();
+            return -1;
+        }
+
+        size_t bytes = 0;
+        int i;
+        for (i = 0; i < sent; i++)
+        {
+            bytes += vectors[i].iov_len;
+        }
+        Stats_AddWrite(bytes, Stats_Now() - start, 0);
+        s_sendOffset = RecordEnd(&vectors[sent - 1]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Sends the bytes of the send buffer to the stream socket
+ *
+ * @return int 0 on success, -1 on failure
+ */
+static int SendStream()
+{
+    while (s_sendOffset < s_sendLength)
+    {
+        unsigned long long start = Stats_Now();
+        ssize_t sent = send(s_fd, s_sendBuffer + s_sendOffset, s_sendLength - s_sendOffset, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            Stats_AddWrite(0, Stats_Now() - start, 1);
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                return -1;
+            }
+
+            // Rest of a partly sent record would start the next connection, it is dropped
+            size_t next = NextRecordStart(s_sendOffset);
+            if (next != s_sendOffset)
+            {
+                s_sendOffset = next;
+                s_dropped++;
+            }
+            Disconnect();
+            return -1;
+        }
+        Stats_AddWrite((size_t)sent, Stats_Now() - start, 0);
+        s_sendOffset += (size_t)sent;
+    }
+    return 0;
+}
+
+/**
+ * @brief Formats a log of the socket
+ */
+static size_t FormatNotice(char *buffer, size_t bufferSize, const UniLoggerCallSite *callSite, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t length = FormatLogRecord(buffer, bufferSize, callSite, 1, args, format);
+    va_end(args);
+    return length;
+}
+
+/**
+ * @brief Sends the notice of the dropped records directly, it can not be dropped by the full buffer
+ * Called by the sender thread between the sends
+ *
+ * @param dropped number of the dropped records
+ */
+static void SendDroppedNotice(unsigned long long dropped)
+{
+    const char *format = "%llu logs dropped, socket was down or the buffer was full";
+    UniLoggerCallSite callSite = {LOG_LEVEL_WARN, "Socket", __LINE__, NULL, 0, format, NULL, 0, NULL};
+    char record[UL_MAX_RECORD_SIZE];
+    size_t length = FormatNotice(record, sizeof(record), &callSite, format, dropped);
+    if (SOCK_DGRAM == s_socketType && length && '\n' == record[length - 1])
+    {
+        length--;
+    }
+    send(s_fd, record, length, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief Sender thread, sends the records and reconnects to the collector
+ */
+static void *SocketSenderThread(void *arg)
+{
+    (void)arg;
+    unsigned int retryMs = UL_SOCKET_RETRY_MIN_MS;
+    pthread_mutex_lock(&s_socketMutex);
+    for (;;)
+    {
+        // Pending records are taken when the sent ones are done
+        if (s_sendOffset == s_sendLength && s_pendingLength)
+        {
+            char *buffer = s_sendBuffer;
+            s_sendBuffer = s_pendingBuffer;
+            s_sendLength = s_pendingLength;
+            s_sendOffset = 0;
+            s_pendingBuffer = buffer;
+            s_pendingLength = 0;
+
+            // Strings are sent again if the records are sent on a new connection
+            if (SOCK_STREAM == s_socketType && ENCODING_BINARY == gCurrLogEncoding)
+            {
+                KeepStrings(s_sendBuffer, s_sendLength);
+            }
+        }
+
+        if (s_sendOffset == s_sendLength)
+        {
+            if (s_isStopping)
+            {
+                break;
+            }
+            s_isSenderIdle = 1;
+            pthread_cond_broadcast(&s_drainCond);
+            pthread_cond_wait(&s_wakeCond, &s_socketMutex);
+            s_isSenderIdle = 0;
+            continue;
+        }
+        pthread_mutex_unlock(&s_socketMutex);
+
+        // Send buffer is used only by this thread
+        int status = -1;
+        if (s_fd >= 0 || 0 == Connect())
+        {
+            status = (SOCK_DGRAM == s_socketType) ? SendDatagrams() : SendStream();
+        }
+
+        pthread_mutex_lock(&s_socketMutex);
+        unsigned long long dropped = s_dropped - s_droppedReported;
+        if (0 == status && dropped)
+        {
+            s_droppedReported = s_dropped;
+            pthread_mutex_unlock(&s_socketMutex);
+            SendDroppedNotice(dropped);
+            pthread_mutex_lock(&s_socketMutex);
+        }
+
+        if (0 != status)
+        {
+            // Records are kept while the collector is down, dropped at stop
+            if (s_isStopping)
+            {
+                s_dropped += CountRecords(s_sendBuffer + s_sendOffset, s_sendLength - s_sendOffset, 0) +
+                             CountRecords(s_pendingBuffer, s_pendingLength, 0);
+                break;
+            }
+
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_sec += retryMs / 1000;
+            timeout.tv_nsec += (long)(retryMs % 1000) * 1000000L;
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&s_wakeCond, &s_socketMutex, &timeout);
+            retryMs = (retryMs * 2 > UL_SOCKET_RETRY_MAX_MS) ? UL_SOCKET_RETRY_MAX_MS : retryMs * 2;
+        }
+        else
+        {
+            retryMs = UL_SOCKET_RETRY_MIN_MS;
+        }
+    }
+    unsigned long long dropped = s_dropped - s_droppedReported;
+    s_droppedReported = s_dropped;
+    s_isSenderIdle = 1;
+    pthread_cond_broadcast(&s_drainCond);
+    pthread_mutex_unlock(&s_socketMutex);
+
+    if (dropped && s_fd >= 0)
+    {
+        SendDroppedNotice(dropped);
+    }
+    return NULL;
+}
+
+int SocketSink_Start(const char *address, size_t bufferSize)
+{
+    if (atomic_load(&s_isRunning))
+    {
+        return 0;
+    }
+
+    if (0 != ParseAddress(address))
+    {
+        return -1;
+    }
+
+    s_pendingBuffer = (char *)malloc(bufferSize);
+    s_sendBuffer = (char *)malloc(bufferSize);
+    s_stream = fopen("/dev/null", "we");
+    if (NULL == s_pendingBuffer || NULL == s_sendBuffer || NULL == s_stream)
+    {
+        SocketSink_Stop();
+        return -1;
+    }
+    s_bufferSize = bufferSize;
+    s_pendingLength = 0;
+    s_sendLength = 0;
+    s_sendOffset = 0;
+    s_dropped = 0;
+    s_droppedReported = 0;
+    s_isStopping = 0;
+    s_isSenderIdle = 0;
+
+    // Connected by the sender thread, the callers never wait for the collector
+    if (0 != pthread_create(&s_senderThread, NULL, SocketSenderThread, NULL))
+    {
+        SocketSink_Stop();
+        return -1;
+    }
+
+    atomic_store(&s_isRunning, 1);
+    return 0;
+}
+
+unsigned char SocketSink_IsRunning()
+{
+    return (unsigned char)atomic_load_explicit(&s_isRunning, memory_order_relaxed);
+}
+
+unsigned char SocketSink_IsDatagram()
+{
+    return SOCK_DGRAM == s_socketType;
+}
+
+FILE *SocketSink_GetStream()
+{
+    return s_stream;
+}
+
+void SocketSink_Write(const struct iovec *vectors, int count)
+{
+    size_t length = 0;
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        length += vectors[i].iov_len;
+    }
+
+    pthread_mutex_lock(&s_socketMutex);
+    if (s_pendingLength + length > s_bufferSize)
+    {
+        // Buffer is full (collector is down or slow), the records are dropped
+        unsigned long long dropped = 0;
+        for (i = 0; i < count; i++)
+        {
+            dropped += CountRecords((const char *)vectors[i].iov_base, vectors[i].iov_len, 1);
+        }
+        s_dropped += dropped;
+        pthread_mutex_unlock(&s_socketMutex);
+
+        // Strings of the dropped records are written again with the next records
+        if (ENCODING_BINARY == gCurrLogEncoding)
+        {
+            BinaryFormat_ResetStrings();
+        }
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        memcpy(s_pendingBuffer + s_pendingLength, vectors[i].iov_base, vectors[i].iov_len);
+        s_pendingLength += vectors[i].iov_len;
+    }
+
+    // Woken once per burst, later records are taken with the first one
+    if (s_isSenderIdle)
+    {
+        pthread_cond_signal(&s_wakeCond);
+    }
+    pthread_mutex_unlock(&s_socketMutex);
+}
+
+void SocketSink_WriteFromSignal(const char *data, size_t length)
+{
+    // Records of the buffers can not be sent from the signal handler, the record is sent directly
+    int fd = s_fd;
+    if (fd < 0 || 0 == length)
+    {
+        return;
+    }
+    if (SOCK_DGRAM == s_socketType)
+    {
+        send(fd, data, ('\n' == data[length - 1]) ? length - 1 : length, MSG_NOSIGNAL | MSG_DONTWAIT);
+        return;
+    }
+    while (length)
+    {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+void SocketSink_Flush()
+{
+    if (!atomic_load(&s_isRunning))
+    {
+        return;
+    }
+
+    // Waits only while connected, bounded if the collector stops reading
+    struct timespec timeout;
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_sec += UL_SOCKET_FLUSH_MS / 1000;
+    timeout.tv_nsec += (long)(UL_SOCKET_FLUSH_MS % 1000) * 1000000L;
+    if (timeout.tv_nsec >= 1000000000L)
+    {
+        timeout.tv_sec++;
+        timeout.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&s_socketMutex);
+    while (atomic_load(&s_isConnected) && (s_pendingLength || !s_isSenderIdle))
+    {
+        if (s_isSenderIdle)
+        {
+            pthread_cond_signal(&s_wakeCond);
+        }
+        if (ETIMEDOUT == pthread_cond_timedwait(&s_drainCond, &s_socketMutex, &timeout))
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_socketMutex);
+}
+
+void SocketSink_Stop()
+{
+    if (atomic_load(&s_isRunning))
+    {
+        SocketSink_Flush();
+
+        pthread_mutex_lock(&s_socketMutex);
+        s_isStopping = 1;
+        pthread_cond_signal(&s_wakeCond);
+        pthread_mutex_unlock(&s_socketMutex);
+        pthread_join(s_senderThread, NULL);
+        atomic_store(&s_isRunning, 0);
+    }
+
+    if (s_fd >= 0)
+    {
+        Disconnect();
+    }
+    if (s_stream)
+    {
+        fclose(s_stream);
+        s_stream = NULL;
+    }
+    free(s_pendingBuffer);
+    free(s_sendBuffer);
+    s_pendingBuffer = NULL;
+    s_sendBuffer = NULL;
+    s_bufferSize = 0;
+    free(s_strings);
+    free(s_stringIds);
+    s_strings = NULL;
+    s_stringIds = NULL;
+    s_stringsLength = 0;
+    s_stringsCapacity = 0;
+}
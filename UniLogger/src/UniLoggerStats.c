@@ -0,0 +1,262 @@
+/**
+ * @file UniLoggerStats.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Runtime statistics of UniLogger (records, bytes, lock and I/O time)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Counters are sharded, every thread takes a cache line aligned shard at
+ * its first log and updates it with relaxed atomic adds, so the threads do
+ * not share cache lines while logging (till there are more threads than
+ * shards). UniLogger_GetStats() sums the shards. The time waiting for
+ * s_logMutex is measured only when the mutex is contended, the I/O time is
+ * measured around every write system call.
+ */
+// System Include
+#include <stdatomic.h>
+#include <errno.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Counters of a shard
+ */
+typedef struct StatsShard
+{
+    // Records of every level, per StatsRecord
+    atomic_ullong records[STATS_RECORD_COUNT][LOG_MAX_LEVEL];
+    // Bytes written to the outputs
+    atomic_ullong bytesWritten;
+    // Write system calls
+    atomic_ullong writeCalls;
+    // Failed writes
+    atomic_ullong failedWrites;
+    // Contended locks of s_logMutex
+    atomic_ullong mutexWaits;
+    // Time waiting for s_logMutex in ns
+    atomic_ullong mutexWaitNs;
+    // Time in the write system calls in ns
+    atomic_ullong ioNs;
+} __attribute__((aligned(64))) StatsShard;
+
+// Shards of the counters
+static StatsShard s_shards[UL_STATS_SHARDS];
+// Shard of the calling thread
+static __thread StatsShard *t_shard = NULL;
+// Shard of the next thread
+static atomic_uint s_nextShard;
+
+// Flag to check report thread is running
+static atomic_int s_isReportRunning;
+// Flag to stop the report thread
+static atomic_int s_isReportStopping;
+// Report thread
+static pthread_t s_reportThread;
+// Interval of the report in seconds
+static unsigned int s_reportInterval = 0;
+// Mutex and condition to wake the report thread
+static pthread_mutex_t s_wakeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Gets the shard of the calling thread
+ */
+static inline StatsShard *GetShard()
+{
+    if (NULL == t_shard)
+    {
+        unsigned int shard = atomic_fetch_add_explicit(&s_nextShard, 1, memory_order_relaxed);
+        t_shard = &s_shards[shard % UL_STATS_SHARDS];
+    }
+    return t_shard;
+}
+
+unsigned long long Stats_Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+void Stats_AddRecord(StatsRecord type, enum LogLevel level)
+{
+    atomic_fetch_add_explicit(&GetShard()->records[type][level], 1, memory_order_relaxed);
+}
+
+void Stats_DropRecord(enum LogLevel level)
+{
+    // Emitted can be counted in the shard of another thread, only the sum of the shards is read
+    StatsShard *shard = GetShard();
+    atomic_fetch_sub_explicit(&shard->records[STATS_EMITTED][level], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->records[STATS_DROPPED][level], 1, memory_order_relaxed);
+}
+
+void Stats_AddWrite(size_t bytes, unsigned long long ioNs, unsigned char isFailed)
+{
+    StatsShard *shard = GetShard();
+    atomic_fetch_add_explicit(&shard->writeCalls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->ioNs, ioNs, memory_order_relaxed);
+    if (bytes)
+    {
+        atomic_fetch_add_explicit(&shard->bytesWritten, bytes, memory_order_relaxed);
+    }
+    if (isFailed)
+    {
+        atomic_fetch_add_explicit(&shard->failedWrites, 1, memory_order_relaxed);
+    }
+}
+
+void Stats_AddBytes(size_t bytes)
+{
+    atomic_fetch_add_explicit(&GetShard()->bytesWritten, bytes, memory_order_relaxed);
+}
+
+void Stats_LockMutex(pthread_mutex_t *mutex)
+{
+    // Uncontended lock is not timed
+    if (0 == pthread_mutex_trylock(mutex))
+    {
+        return;
+    }
+
+    unsigned long long start = Stats_Now();
+    pthread_mutex_lock(mutex);
+    StatsShard *shard = GetShard();
+    atomic_fetch_add_explicit(&shard->mutexWaits, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->mutexWaitNs, Stats_Now() - start, memory_order_relaxed);
+}
+
+void UniLogger_GetStats(UniLoggerStats *stats)
+{
+    if (NULL == stats)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    unsigned int i;
+    for (i = 0; i < UL_STATS_SHARDS; i++)
+    {
+        StatsShard *shard = &s_shards[i];
+        unsigned int level;
+        for (level = 0; level < LOG_MAX_LEVEL; level++)
+        {
+            stats->emitted[level] += atomic_load_explicit(&shard->records[STATS_EMITTED][level], memory_order_relaxed);
+            stats->filtered[level] += atomic_load_explicit(&shard->records[STATS_FILTERED][level], memory_order_relaxed);
+            stats->dropped[level] += atomic_load_explicit(&shard->records[STATS_DROPPED][level], memory_order_relaxed);
+            stats->collapsed[level] += atomic_load_explicit(&shard->records[STATS_COLLAPSED][level], memory_order_relaxed);
+        }
+        stats->bytesWritten += atomic_load_explicit(&shard->bytesWritten, memory_order_relaxed);
+        stats->writeCalls += atomic_load_explicit(&shard->writeCalls, memory_order_relaxed);
+        stats->failedWrites += atomic_load_explicit(&shard->failedWrites, memory_order_relaxed);
+        stats->mutexWaits += atomic_load_explicit(&shard->mutexWaits, memory_order_relaxed);
+        stats->mutexWaitNs += atomic_load_explicit(&shard->mutexWaitNs, memory_order_relaxed);
+        stats->ioNs += atomic_load_explicit(&shard->ioNs, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Sums the counters of all the levels
+ */
+static unsigned long long SumLevels(const unsigned long long counters[LOG_MAX_LEVEL])
+{
+    unsigned long long sum = 0;
+    unsigned int level;
+    for (level = 0; level < LOG_MAX_LEVEL; level++)
+    {
+        sum += counters[level];
+    }
+    return sum;
+}
+
+/**
+ * @brief Writes the statistics of the interval
+ *
+ * @param last statistics at the last report, updated to the current statistics
+ */
+static void WriteReport(UniLoggerStats *last)
+{
+    UniLoggerStats curr;
+    UniLogger_GetStats(&curr);
+
+    UniLogger_CustomLogFn(LOG_LEVEL_INFO, "Stats", __LINE__,
+                          "Last %u s: emitted %llu, filtered %llu, dropped %llu, collapsed %llu, failed writes %llu, "
+                          "bytes %llu, writes %llu, mutex waits %llu (%llu us), io %llu us",
+                          s_reportInterval,
+                          SumLevels(curr.emitted) - SumLevels(last->emitted),
+                          SumLevels(curr.filtered) - SumLevels(last->filtered),
+                          SumLevels(curr.dropped) - SumLevels(last->dropped),
+                          SumLevels(curr.collapsed) - SumLevels(last->collapsed),
+                          curr.failedWrites - last->failedWrites,
+                          curr.bytesWritten - last->bytesWritten,
+                          curr.writeCalls - last->writeCalls,
+                          curr.mutexWaits - last->mutexWaits,
+                          (curr.mutexWaitNs - last->mutexWaitNs) / 1000,
+                          (curr.ioNs - last->ioNs) / 1000);
+    *last = curr;
+}
+
+/**
+ * @brief Report thread, writes the statistics every interval
+ */
+static void *StatsReportThread(void *arg)
+{
+    (void)arg;
+    UniLoggerStats last;
+    UniLogger_GetStats(&last);
+
+    pthread_mutex_lock(&s_wakeMutex);
+    while (!atomic_load(&s_isReportStopping))
+    {
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += s_reportInterval;
+
+        if (ETIMEDOUT == pthread_cond_timedwait(&s_wakeCond, &s_wakeMutex, &timeout) &&
+            !atomic_load(&s_isReportStopping))
+        {
+            pthread_mutex_unlock(&s_wakeMutex);
+            WriteReport(&last);
+            pthread_mutex_lock(&s_wakeMutex);
+        }
+    }
+    pthread_mutex_unlock(&s_wakeMutex);
+    return NULL;
+}
+
+int Stats_StartReport(unsigned int interval)
+{
+    if (atomic_load(&s_isReportRunning) || 0 == interval)
+    {
+        return 0;
+    }
+
+    s_reportInterval = interval;
+    atomic_store(&s_isReportStopping, 0);
+    if (0 != pthread_create(&s_reportThread, NULL, StatsReportThread, NULL))
+    {
+        return -1;
+    }
+
+    atomic_store(&s_isReportRunning, 1);
+    return 0;
+}
+
+void Stats_StopReport()
+{
+    if (!atomic_load(&s_isReportRunning))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_wakeMutex);
+    atomic_store(&s_isReportStopping, 1);
+    pthread_cond_signal(&s_wakeCond);
+    pthread_mutex_unlock(&s_wakeMutex);
+    pthread_join(s_reportThread, NULL);
+
+    atomic_store(&s_isReportRunning, 0);
+}
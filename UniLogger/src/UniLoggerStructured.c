@@ -0,0 +1,346 @@
+/**
+ * @file UniLoggerStructured.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Structured logs of UniLogger (JSON lines and logfmt encodings)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Fields of the structured logs (LOG_<LEVEL>_KV()) are kept on the stack
+ * of the caller and are encoded directly into the buffer of the record,
+ * nothing is allocated. A field which does not fit in the record is
+ * removed with the fields after it, so the record is always a complete
+ * JSON object or logfmt line. In text encoding the fields are appended to
+ * the message as key=value pairs.
+ */
+// System Include
+#include <math.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Bytes kept for the end of the record ("}\n" and null)
+ */
+#define UL_STRUCTURED_RESERVE 3
+
+// Message of the printf logs and text of the structured logs
+static __thread char t_messageBuffer[UL_STAGING_BUFFER_SIZE];
+
+/**
+ * @brief Bounded writer of the record
+ */
+typedef struct FieldWriter
+{
+    // Destination buffer
+    char *data;
+    // Number of bytes written
+    size_t length;
+    // Number of bytes which can be written
+    size_t limit;
+    // Encoding of the record (JSON or logfmt)
+    enum LogEncoding encoding;
+} FieldWriter;
+
+/**
+ * @brief Gets the number of bytes written by snprintf into the buffer
+ */
+static inline size_t WrittenLength(int written, size_t available)
+{
+    if (written < 0)
+    {
+        return 0;
+    }
+    return (size_t)written < available ? (size_t)written : available - 1;
+}
+
+/**
+ * @brief Appends the data
+ *
+ * @return int 0 -> written, -1 -> no space
+ */
+static inline int Append(FieldWriter *writer, const char *data, size_t length)
+{
+    if (writer->length + length > writer->limit)
+    {
+        return -1;
+    }
+    memcpy(writer->data + writer->length, data, length);
+    writer->length += length;
+    return 0;
+}
+
+/**
+ * @brief Checks if the logfmt value must be quoted
+ */
+static unsigned char IsQuotingRequired(const char *value)
+{
+    if ('\0' == *value)
+    {
+        return 1;
+    }
+    for (; *value; value++)
+    {
+        unsigned char c = (unsigned char)*value;
+        if (c <= ' ' || '=' == c || '"' == c || '\\' == c || 0x7F == c)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends the string, quoted and escaped if required
+ *
+ * @param writer writer of the record
+ * @param value string to be written
+ * @param isTruncating flag to write the part of the string which fits
+ * @return int 0 -> written, -1 -> no space
+ */
+static int AppendString(FieldWriter *writer, const char *value, unsigned char isTruncating)
+{
+    if (NULL == value)
+    {
+        return ENCODING_JSON == writer->encoding ? Append(writer, "null", 4) : Append(writer, "\"\"", 2);
+    }
+    if (ENCODING_LOGFMT == writer->encoding && !IsQuotingRequired(value))
+    {
+        size_t length = strlen(value);
+        if (isTruncating && writer->length + length > writer->limit)
+        {
+            length = writer->limit - writer->length;
+        }
+        return Append(writer, value, length);
+    }
+
+    // Closing quote is kept with the limit
+    if (writer->length + 2 > writer->limit)
+    {
+        return -1;
+    }
+    writer->data[writer->length++] = '"';
+    writer->limit--;
+
+    int status = 0;
+    for (; *value; value++)
+    {
+        unsigned char c = (unsigned char)*value;
+        char escaped[8];
+        size_t length = 2;
+        escaped[0] = '\\';
+        switch (c)
+        {
+        case '"':
+            escaped[1] = '"';
+            break;
+        case '\\':
+            escaped[1] = '\\';
+            break;
+        case '\n':
+            escaped[1] = 'n';
+            break;
+        case '\r':
+            escaped[1] = 'r';
+            break;
+        case '\t':
+            escaped[1] = 't';
+            break;
+        default:
+            if (c < ' ')
+            {
+                length = (size_t)snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            }
+            else
+            {
+                escaped[0] = (char)c;
+                length = 1;
+            }
+            break;
+        }
+        if (Append(writer, escaped, length))
+        {
+            status = isTruncating ? 0 : -1;
+            break;
+        }
+    }
+
+    writer->limit++;
+    writer->data[writer->length++] = '"';
+    return status;
+}
+
+/**
+ * @brief Appends the key of the field (with separator)
+ *
+ * @return int 0 -> written, -1 -> no space
+ */
+static int AppendKey(FieldWriter *writer, const char *key)
+{
+    if (ENCODING_JSON == writer->encoding)
+    {
+        if (Append(writer, ",", 1) || AppendString(writer, key, 0))
+        {
+            return -1;
+        }
+        return Append(writer, ":", 1);
+    }
+
+    if (writer->length && Append(writer, " ", 1))
+    {
+        return -1;
+    }
+    if (Append(writer, key, strlen(key)))
+    {
+        return -1;
+    }
+    return Append(writer, "=", 1);
+}
+
+/**
+ * @brief Appends the value of the field
+ *
+ * @return int 0 -> written, -1 -> no space
+ */
+static int AppendValue(FieldWriter *writer, const UniLoggerField *field)
+{
+    char number[32];
+    int written = 0;
+    switch (field->type)
+    {
+    case UL_FIELD_INT:
+        written = snprintf(number, sizeof(number), "%lld", field->value.intValue);
+        break;
+    case UL_FIELD_UINT:
+        written = snprintf(number, sizeof(number), "%llu", field->value.uintValue);
+        break;
+    case UL_FIELD_DOUBLE:
+        if (ENCODING_JSON == writer->encoding && !isfinite(field->value.doubleValue))
+        {
+            // NaN and Infinity are not valid in JSON
+            return Append(writer, "null", 4);
+        }
+        written = snprintf(number, sizeof(number), "%.17g", field->value.doubleValue);
+        break;
+    case UL_FIELD_STRING:
+        return AppendString(writer, field->value.stringValue, 0);
+    case UL_FIELD_BOOL:
+        return field->value.intValue ? Append(writer, "true", 4) : Append(writer, "false", 5);
+    default:
+        return Append(writer, "null", 4);
+    }
+    return Append(writer, number, WrittenLength(written, sizeof(number)));
+}
+
+/**
+ * @brief Appends the fields, stops at the first field which does not fit
+ */
+static void AppendFields(FieldWriter *writer, const UniLoggerField *fields, unsigned int count)
+{
+    unsigned int i;
+    for (i = 0; i < count; i++)
+    {
+        size_t length = writer->length;
+        if (AppendKey(writer, fields[i].key ? fields[i].key : "") || AppendValue(writer, &fields[i]))
+        {
+            // Remove the partial field
+            writer->length = length;
+            return;
+        }
+    }
+}
+
+size_t Structured_EncodeRecord(char *buffer,
+                               size_t bufferSize,
+                               const UniLoggerCallSite *callSite,
+                               enum LogEncoding encoding,
+                               const char *message,
+                               const UniLoggerField *fields,
+                               unsigned int count)
+{
+    if (bufferSize <= UL_STRUCTURED_RESERVE)
+    {
+        return 0;
+    }
+
+    char dateTime[UL_TIMESTAMP_SIZE];
+    struct timespec currTime;
+    Timestamp_Now(&currTime);
+    Timestamp_Format(&currTime, dateTime);
+
+    // Level name without the padding
+    const char *levelName = logLevelNames[(unsigned char)callSite->level];
+    while (' ' == *levelName)
+    {
+        levelName++;
+    }
+    size_t levelLength = strlen(levelName);
+    while (levelLength && ' ' == levelName[levelLength - 1])
+    {
+        levelLength--;
+    }
+
+    char lineNum[16];
+    int written = snprintf(lineNum, sizeof(lineNum), "%u", callSite->lineNum);
+    FieldWriter writer = {buffer, 0, bufferSize - UL_STRUCTURED_RESERVE, encoding};
+    if (ENCODING_JSON == encoding)
+    {
+        Append(&writer, "{\"ts\":", 6);
+        AppendString(&writer, dateTime, 0);
+        Append(&writer, ",\"level\":\"", 10);
+        Append(&writer, levelName, levelLength);
+        Append(&writer, "\",\"tag\":", 8);
+        AppendString(&writer, callSite->logTag, 0);
+        Append(&writer, ",\"line\":", 8);
+        Append(&writer, lineNum, WrittenLength(written, sizeof(lineNum)));
+        Append(&writer, ",\"msg\":", 7);
+    }
+    else
+    {
+        Append(&writer, "ts=", 3);
+        AppendString(&writer, dateTime, 0);
+        Append(&writer, " level=", 7);
+        Append(&writer, levelName, levelLength);
+        Append(&writer, " tag=", 5);
+        AppendString(&writer, callSite->logTag, 0);
+        Append(&writer, " line=", 6);
+        Append(&writer, lineNum, WrittenLength(written, sizeof(lineNum)));
+        Append(&writer, " msg=", 5);
+    }
+    // Long message is truncated, the fields after it are removed
+    AppendString(&writer, message, 1);
+    AppendFields(&writer, fields, count);
+
+    if (ENCODING_JSON == encoding)
+    {
+        buffer[writer.length++] = '}';
+    }
+    buffer[writer.length++] = '\n';
+    buffer[writer.length] = '\0';
+    return writer.length;
+}
+
+size_t Structured_EncodeArgs(char *buffer,
+                             size_t bufferSize,
+                             const UniLoggerCallSite *callSite,
+                             enum LogEncoding encoding,
+                             va_list args,
+                             const char *format)
+{
+    vsnprintf(t_messageBuffer, sizeof(t_messageBuffer), format, args);
+    return Structured_EncodeRecord(buffer, bufferSize, callSite, encoding, t_messageBuffer, NULL, 0);
+}
+
+const char *Structured_Text(const char *message, const UniLoggerField *fields, unsigned int count)
+{
+    // Fields are appended to the message as logfmt pairs
+    FieldWriter writer = {t_messageBuffer, 0, sizeof(t_messageBuffer) - 1, ENCODING_LOGFMT};
+    if (message)
+    {
+        Append(&writer, message, strnlen(message, writer.limit));
+    }
+    AppendFields(&writer, fields, count);
+    t_messageBuffer[writer.length] = '\0';
+    return t_messageBuffer;
+}
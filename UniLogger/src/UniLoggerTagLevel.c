@@ -0,0 +1,204 @@
+/**
+ * @file UniLoggerTagLevel.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Log levels per log tag for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * Every log tag gets a slot with its own level mask. At the first log a
+ * call site is resolved to the slot of its tag, later logs only load the
+ * mask of the slot. Slots without their own level follow the level set by
+ * UniLogger_SetLogLevel(). Slots are never removed, logs without call site
+ * descriptor cache the slot of their tag in the calling thread.
+ */
+// System Include
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Level of a log tag
+ */
+typedef struct TagLevel
+{
+    // Name of the tag
+    char *logTag;
+    // Published level mask of the tag (PublishedMask()), loaded by the call sites
+    unsigned int levelMask;
+    // Flag to check the tag has its own level
+    unsigned char isOverridden;
+    // Flag to check the level is set by the Environment variable
+    unsigned char isFromEnv;
+} TagLevel;
+
+// Level mask of the unresolved call sites, all levels till resolved
+const unsigned int gUnresolvedLevelMask = ~0u;
+
+// Levels of the tags
+static TagLevel s_tagLevels[UL_MAX_TAG_LEVELS];
+// Number of the tags, published after the slot is filled
+static unsigned int s_tagLevelCount = 0;
+// Mutex for the tags
+static pthread_mutex_t s_tagLevelMutex = PTHREAD_MUTEX_INITIALIZER;
+// Slots of the tags looked up by the thread, by address of the tag
+static __thread TagLevel *t_tagCache[UL_TAG_CACHE_SIZE];
+
+/**
+ * @brief Finds the slot of the tag, adds a slot if not found
+ * Must be called with s_tagLevelMutex
+ *
+ * @param logTag log tag
+ * @return TagLevel* slot of the tag, NULL if no slot is free
+ */
+static TagLevel *FindTagLevel(const char *logTag)
+{
+    unsigned int i;
+    for (i = 0; i < s_tagLevelCount; i++)
+    {
+        if (0 == strcmp(s_tagLevels[i].logTag, logTag))
+        {
+            return &s_tagLevels[i];
+        }
+    }
+
+    if (s_tagLevelCount >= UL_MAX_TAG_LEVELS)
+    {
+        return NULL;
+    }
+
+    char *name = strdup(logTag);
+    if (NULL == name)
+    {
+        return NULL;
+    }
+
+    TagLevel *tagLevel = &s_tagLevels[s_tagLevelCount];
+    tagLevel->logTag = name;
+    tagLevel->levelMask = __atomic_load_n(&gCurrLogLevelMask, __ATOMIC_RELAXED);
+    tagLevel->isOverridden = 0;
+    tagLevel->isFromEnv = 0;
+    // Searched without the mutex by TagLevel_Lookup()
+    __atomic_store_n(&s_tagLevelCount, s_tagLevelCount + 1, __ATOMIC_RELEASE);
+    return tagLevel;
+}
+
+void TagLevel_SetDefault(unsigned int levelMask)
+{
+    levelMask = PublishedMask(levelMask);
+    pthread_mutex_lock(&s_tagLevelMutex);
+    unsigned int i;
+    for (i = 0; i < s_tagLevelCount; i++)
+    {
+        if (!s_tagLevels[i].isOverridden)
+        {
+            __atomic_store_n(&s_tagLevels[i].levelMask, levelMask, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&s_tagLevelMutex);
+}
+
+int TagLevel_Set(const char *logTag, unsigned int levelMask, unsigned char isFromEnv)
+{
+    int status = 0;
+    pthread_mutex_lock(&s_tagLevelMutex);
+
+    TagLevel *tagLevel = FindTagLevel(logTag);
+    if (NULL == tagLevel)
+    {
+        status = -1;
+    }
+    else if (tagLevel->isFromEnv && !isFromEnv)
+    {
+        // Environment variable takes priority over the API
+        status = 1;
+    }
+    else
+    {
+        tagLevel->isOverridden = 1;
+        tagLevel->isFromEnv = isFromEnv;
+        __atomic_store_n(&tagLevel->levelMask, PublishedMask(levelMask), __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&s_tagLevelMutex);
+    return status;
+}
+
+void TagLevel_Resolve(UniLoggerCallSite *callSite)
+{
+    pthread_mutex_lock(&s_tagLevelMutex);
+
+    // Call sites of the tags without slot follow the global level
+    TagLevel *tagLevel = FindTagLevel(callSite->logTag);
+    const unsigned int *levelMask = tagLevel ? &tagLevel->levelMask : &gCurrLogLevelMask;
+    __atomic_store_n(&callSite->levelMask, levelMask, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&s_tagLevelMutex);
+}
+
+const unsigned int *TagLevel_Lookup(const char *logTag)
+{
+    TagLevel **cached = &t_tagCache[((uintptr_t)logTag >> 3) % UL_TAG_CACHE_SIZE];
+    TagLevel *tagLevel = *cached;
+    if (tagLevel && 0 == strcmp(tagLevel->logTag, logTag))
+    {
+        return &tagLevel->levelMask;
+    }
+
+    // Published slots are searched without the mutex
+    unsigned int count = __atomic_load_n(&s_tagLevelCount, __ATOMIC_ACQUIRE);
+    unsigned int i;
+    tagLevel = NULL;
+    for (i = 0; i < count && NULL == tagLevel; i++)
+    {
+        if (0 == strcmp(s_tagLevels[i].logTag, logTag))
+        {
+            tagLevel = &s_tagLevels[i];
+        }
+    }
+
+    if (NULL == tagLevel)
+    {
+        pthread_mutex_lock(&s_tagLevelMutex);
+        tagLevel = FindTagLevel(logTag);
+        pthread_mutex_unlock(&s_tagLevelMutex);
+        if (NULL == tagLevel)
+        {
+            // Tags without slot follow the global level
+            return &gCurrLogLevelMask;
+        }
+    }
+    *cached = tagLevel;
+    return &tagLevel->levelMask;
+}
+
+void TagLevel_Reset()
+{
+    pthread_mutex_lock(&s_tagLevelMutex);
+    unsigned int levelMask = __atomic_load_n(&gCurrLogLevelMask, __ATOMIC_RELAXED);
+    unsigned int i;
+    for (i = 0; i < s_tagLevelCount; i++)
+    {
+        s_tagLevels[i].isOverridden = 0;
+        s_tagLevels[i].isFromEnv = 0;
+        __atomic_store_n(&s_tagLevels[i].levelMask, levelMask, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&s_tagLevelMutex);
+}
+
+void TagLevel_Republish()
+{
+    pthread_mutex_lock(&s_tagLevelMutex);
+    unsigned int i;
+    for (i = 0; i < s_tagLevelCount; i++)
+    {
+        unsigned int levelMask = __atomic_load_n(&s_tagLevels[i].levelMask, __ATOMIC_RELAXED);
+        __atomic_store_n(&s_tagLevels[i].levelMask,
+                         PublishedMask(levelMask >> UL_STREAM_MASK_SHIFT),
+                         __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&s_tagLevelMutex);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file UniLoggerTime.c
+ * @author Brothers-AI (brothers.ai.local@gmail.com)
+ * @brief Cached timestamp formatting for UniLogger
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @paragraph
+ * The "YYYY-MM-DD HH:MM:SS:" part of the timestamp is rendered once per
+ * second in a thread local cache, so localtime_r() (and the timezone lock
+ * of libc) is called only when the second changes. Only the microsecond
+ * digits are rendered for every log.
+ */
+// System Include
+#include <stdint.h>
+#include <time.h>
+
+#include "UniLoggerInternal.h"
+
+/**
+ * @brief Clock used for the timestamps
+ * CLOCK_REALTIME_COARSE avoids reading the hardware clock, but has only
+ * a resolution of the kernel tick (1 - 4 ms)
+ */
+#ifdef UL_TIME_COARSE
+#define UL_TIME_CLOCK CLOCK_REALTIME_COARSE
+#else
+#define UL_TIME_CLOCK CLOCK_REALTIME
+#endif // UL_TIME_COARSE
+
+// Current Time Format, Default to Local time
+static enum LogTimeFormat s_timeFormat = TIME_FORMAT_LOCAL;
+
+// Last time read by the thread
+static __thread struct timespec t_lastTime;
+
+// Second of the cached prefix
+static __thread time_t t_cachedSecond = (time_t)-1;
+// Time Format of the cached prefix
+static __thread enum LogTimeFormat t_cachedFormat = TIME_FORMAT_LOCAL;
+// Cached "YYYY-MM-DD HH:MM:SS:" prefix
+static __thread char t_cachedPrefix[UL_TIMESTAMP_SIZE];
+// Length of the cached prefix
+static __thread size_t t_cachedLength = 0;
+
+/**
+ * @brief Renders the number as fixed number of decimal digits
+ *
+ * @param buffer destination buffer
+ * @param value value to be rendered
+ * @param digits number of digits
+ */
+static inline void RenderDigits(char *buffer, uint64_t value, unsigned int digits)
+{
+    while (digits--)
+    {
+        buffer[digits] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+void Timestamp_SetFormat(enum LogTimeFormat format)
+{
+    s_timeFormat = format;
+}
+
+void Timestamp_Now(struct timespec *now)
+{
+    clock_gettime(UL_TIME_CLOCK, now);
+    t_lastTime = *now;
+}
+
+void Timestamp_Last(struct timespec *time)
+{
+    *time = t_lastTime;
+}
+
+size_t Timestamp_Format(const struct timespec *time, char *buffer)
+{
+    enum LogTimeFormat format = s_timeFormat;
+
+    if (TIME_FORMAT_EPOCH_NS == format)
+    {
+        uint64_t nanoSeconds = (uint64_t)time->tv_sec * 1000000000ULL + (uint64_t)time->tv_nsec;
+        char digits[24];
+        unsigned int length = 0;
+        do
+        {
+            digits[length++] = (char)('0' + nanoSeconds % 10);
+            nanoSeconds /= 10;
+        } while (nanoSeconds);
+
+        unsigned int i;
+        for (i = 0; i < length; i++)
+        {
+            buffer[i] = digits[length - 1 - i];
+        }
+        buffer[length] = '\0';
+        return length;
+    }
+
+    // Render the date and time only when the second changes
+    if (time->tv_sec != t_cachedSecond || format != t_cachedFormat)
+    {
+        struct tm tm;
+        if (TIME_FORMAT_UTC == format)
+        {
+            gmtime_r(&time->tv_sec, &tm);
+        }
+        else
+        {
+            localtime_r(&time->tv_sec, &tm);
+        }
+
+        int written = snprintf(t_cachedPrefix,
+                               sizeof(t_cachedPrefix),
+                               "%d-%02d-%02d %02d:%02d:%02d:",
+                               tm.tm_year + 1900,
+                               tm.tm_mon + 1,
+                               tm.tm_mday,
+                               tm.tm_hour,
+                               tm.tm_min,
+                               tm.tm_sec);
+        if (written < 0 || (size_t)written >= sizeof(t_cachedPrefix) - 7)
+        {
+            written = 0;
+        }
+        t_cachedLength = (size_t)written;
+        t_cachedSecond = time->tv_sec;
+        t_cachedFormat = format;
+    }
+
+    memcpy(buffer, t_cachedPrefix, t_cachedLength);
+    RenderDigits(buffer + t_cachedLength, (uint64_t)time->tv_nsec / 1000, 6);
+    buffer[t_cachedLength + 6] = '\0';
+    return t_cachedLength + 6;
+}
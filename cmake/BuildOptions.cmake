@@ -15,6 +15,16 @@ string(COMPARE EQUAL "${CMAKE_CURRENT_SOURCE_DIR}" "${CMAKE_SOURCE_DIR}" UL_STAN
 set(UL_BUILD_SHARED_LIBS OFF                           CACHE BOOL   "Build shared libraries (.dll / .so)")
 # For Building Examples for Logger
 set(UL_BUILD_EXAMPLES    ${UL_STANDALONE}              CACHE BOOL   "Build Examples")
+# For Building Tools for Logger (unilogger-decode)
+set(UL_BUILD_TOOLS       ${UL_STANDALONE}              CACHE BOOL   "Build Tools")
+# For Building Benchmarks for Logger (unilogger_bench)
+set(UL_BUILD_BENCHMARKS  OFF                           CACHE BOOL   "Build Benchmarks")
+# For removing logs above the level at compile time (1 - Fatal ... 6 - Trace, 7 - All)
+set(UL_COMPILE_TIME_MIN_LEVEL 7                        CACHE STRING "Logs with greater level are compiled out")
+# For using CLOCK_REALTIME_COARSE for timestamps (tick resolution)
+set(UL_TIME_COARSE       OFF                           CACHE BOOL   "Use coarse clock for timestamps")
+# For compressing the Log File with zlib / liblz4 / libzstd (each one if found)
+set(UL_COMPRESSION       ON                            CACHE BOOL   "Build the compressed log file formats")
 # For Building for Release or Debug
 set(CMAKE_BUILD_TYPE     "Release"                     CACHE STRING "Build Type")
 # For Installing Logger to specific folder
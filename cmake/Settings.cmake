@@ -13,6 +13,12 @@ set(UNI_LOGGER_DIR ${CMAKE_CURRENT_SOURCE_DIR}/UniLogger)
 # Logger Examples Directory
 set(UNI_LOGGER_EXAMPLES_DIR ${CMAKE_CURRENT_SOURCE_DIR}/Examples)
 
+# Logger Tools Directory
+set(UNI_LOGGER_TOOLS_DIR ${CMAKE_CURRENT_SOURCE_DIR}/Tools)
+
+# Logger Benchmarks Directory
+set(UNI_LOGGER_BENCHMARKS_DIR ${CMAKE_CURRENT_SOURCE_DIR}/Benchmarks)
+
 # Project Binary Directory
 # Library Directory
 set(PROJECT_LIBRARY_DIR ${CMAKE_CURRENT_BINARY_DIR}/lib)
@@ -22,3 +28,9 @@ set(PROJECT_EXE_DIR ${CMAKE_CURRENT_BINARY_DIR}/bin)
 
 # Examples executable directory
 set(PROJECT_EXAMPLES_EXE_DIR ${PROJECT_EXE_DIR}/Examples)
+
+# Tools executable directory
+set(PROJECT_TOOLS_EXE_DIR ${PROJECT_EXE_DIR}/Tools)
+
+# Benchmarks executable directory
+set(PROJECT_BENCHMARKS_EXE_DIR ${PROJECT_EXE_DIR}/Benchmarks)